@@ -0,0 +1,24 @@
+#include "csvparser.h"
+
+int main() {
+    char*** data = NULL;
+    float** float_data = NULL;
+    size_t data_dims[2];
+
+    csv_read("../examples/data/floats.csv", &data, &data_dims, ',', true);
+
+    // blocks of rows are converted on every CPU (0 threads = one per CPU); the result is the same as csv_data_to_float()
+    csv_data_to_float_parallel(data, data_dims, &float_data, 0);
+
+    for (size_t i = 0; i < data_dims[0]; ++i)
+    {
+        for (size_t j = 0; j < data_dims[1]; ++j)
+            printf("%f ", float_data[i][j]);
+        printf("\n");
+    }
+
+    csv_free(&data, data_dims);
+    csv_free_float(&float_data, data_dims[0]);
+
+    return 0;
+}
@@ -0,0 +1,18 @@
+#include "csvparser.h"
+
+int main() {
+    csv_stats* stats = NULL;
+    char* columns[2] = {"col1", "col3"};
+
+    // single pass over the file, no cells are stored
+    csv_column_stats("../examples/data/floats.csv", columns, 2, &stats, ',');
+
+    for (size_t c = 0; c < 2; ++c)
+        printf("%s: count=%zu nulls=%zu sum=%f min=%f max=%f mean=%f variance=%f\n",
+               columns[c], stats[c].count, stats[c].null_count, stats[c].sum,
+               stats[c].min, stats[c].max, stats[c].mean, stats[c].variance);
+
+    csv_free_stats(&stats);
+
+    return 0;
+}
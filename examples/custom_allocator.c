@@ -0,0 +1,63 @@
+#include "csvparser.h"
+
+// counts the bytes the library currently holds; a real program might forward to an arena or a tenant's memory pool
+typedef struct counter
+{
+    size_t live_bytes;
+} counter;
+
+static void* counting_malloc(void* context, size_t size)
+{
+    size_t* block = malloc(sizeof(size_t) + size);
+    *block = size;
+    ((counter*)context)->live_bytes += size;
+    return block + 1;
+}
+
+static void* counting_calloc(void* context, size_t count, size_t size)
+{
+    void* pointer = counting_malloc(context, count * size);
+    memset(pointer, 0, count * size);
+    return pointer;
+}
+
+static void counting_free(void* context, void* pointer)
+{
+    if (pointer == NULL)
+        return;
+    size_t* block = (size_t*)pointer - 1;
+    ((counter*)context)->live_bytes -= *block;
+    free(block);
+}
+
+static void* counting_realloc(void* context, void* pointer, size_t size)
+{
+    void* resized = counting_malloc(context, size);
+    if (pointer != NULL)
+    {
+        size_t old_size = ((size_t*)pointer)[-1];
+        memcpy(resized, pointer, old_size < size ? old_size : size);
+        counting_free(context, pointer);
+    }
+    return resized;
+}
+
+int main() {
+    char*** data = NULL;
+    size_t data_dims[2];
+    counter usage = { 0 };
+    csv_allocator allocator = { &counting_malloc, &counting_calloc, &counting_realloc, &counting_free, &usage };
+
+    // only this thread's calls use the allocator; data must be freed while it is still set
+    csv_set_thread_allocator(&allocator);
+
+    csv_read("../examples/data/text.csv", &data, &data_dims, ',', true);
+    printf("%zu bytes held after reading %zu rows\n", usage.live_bytes, data_dims[0]);
+
+    csv_free(&data, data_dims);
+    printf("%zu bytes held after csv_free()\n", usage.live_bytes);
+
+    csv_set_thread_allocator(NULL);
+
+    return 0;
+}
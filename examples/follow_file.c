@@ -0,0 +1,33 @@
+#include "csvparser.h"
+
+int main() {
+    FILE* log = fopen("log.csv", "w");
+    fprintf(log, "time,value\n1,0.5\n");
+    fclose(log);
+
+    csv_follow follow;
+    csv_follow_open("log.csv", &follow, ',', true, false);
+
+    for (int poll = 0; poll < 3; ++poll)
+    {
+        // only rows appended since the previous poll are parsed
+        char*** data = NULL;
+        size_t data_dims[2];
+        csv_follow_poll(&follow, &data, &data_dims);
+        printf("poll %d: %zu new rows\n", poll, data_dims[0]);
+        for (size_t i = 0; i < data_dims[0]; ++i)
+            printf("  %s %s\n", data[i][0], data[i][1]);
+        csv_free(&data, data_dims);
+
+        // a collector appending to the file; the second row is only returned once its newline is written
+        log = fopen("log.csv", "a");
+        fprintf(log, poll == 0 ? "2,0.7\n3,0." : "9\n");
+        fclose(log);
+        csv_follow_wait(&follow, 1000);
+    }
+
+    csv_follow_close(&follow);
+    remove("log.csv");
+
+    return 0;
+}
@@ -0,0 +1,18 @@
+#include "csvparser.h"
+
+int main() {
+    csv_groups groups;
+    char* keys[1] = {"col1"};
+    char* values[2] = {"col2", "col3"};
+    csv_aggregate aggregates[2] = {CSV_AGG_SUM, CSV_AGG_MEAN};
+
+    // one pass over the file; memory grows with the number of distinct keys
+    csv_group_by("../examples/data/floats.csv", keys, 1, values, aggregates, 2, &groups, ',');
+
+    for (size_t g = 0; g < groups.n_groups; ++g)
+        printf("%s: sum(col2)=%f mean(col3)=%f\n", groups.keys[g][0], groups.values[g][0], groups.values[g][1]);
+
+    csv_free_groups(&groups);
+
+    return 0;
+}
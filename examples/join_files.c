@@ -0,0 +1,28 @@
+#include "csvparser.h"
+
+int main() {
+    // a small lookup file to join against; the larger file is streamed, the smaller one is held in a hash table
+    FILE* prices = fopen("prices.csv", "w");
+    fprintf(prices, "col1,price\napple,1.25\nlow,0.40\npear,2.00\n");
+    fclose(prices);
+
+    char* key_columns[1] = {"col1"};
+    csv_join("../examples/data/text.csv", "prices.csv", key_columns, 1, CSV_JOIN_LEFT, "joined.csv", 0, ',');
+
+    char*** data = NULL;
+    size_t data_dims[2];
+    csv_read("joined.csv", &data, &data_dims, ',', true);
+
+    for (size_t i = 0; i < data_dims[0]; ++i)
+    {
+        for (size_t j = 0; j < data_dims[1]; ++j)
+            printf("%s ", data[i][j]);
+        printf("\n");
+    }
+
+    csv_free(&data, data_dims);
+    remove("prices.csv");
+    remove("joined.csv");
+
+    return 0;
+}
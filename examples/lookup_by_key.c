@@ -0,0 +1,22 @@
+#include "csvparser.h"
+
+int main() {
+    // index col1 once; every lookup after that reads only the matching rows
+    csv_build_key_index("../examples/data/text.csv", "col1", ',');
+
+    char*** data = NULL;
+    size_t data_dims[2];
+    csv_lookup("../examples/data/text.csv", "col1", "apple", &data, &data_dims, ',');
+
+    for (size_t i = 0; i < data_dims[0]; ++i)
+    {
+        for (size_t j = 0; j < data_dims[1]; ++j)
+            printf("%s ", data[i][j]);
+        printf("\n");
+    }
+
+    csv_free(&data, data_dims);
+    remove("../examples/data/text.csv.keyidx");
+
+    return 0;
+}
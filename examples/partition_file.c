@@ -0,0 +1,19 @@
+#include "csvparser.h"
+
+int main() {
+    char** files = NULL;
+    size_t n_files;
+
+    // one file per value of col1 in ./partitions, each starting with the header
+    csv_partition("../examples/data/text.csv", "col1", "./partitions", 0, 0, &files, &n_files, ',');
+    for (size_t i = 0; i < n_files; ++i)
+        printf("%s\n", files[i]);
+    csv_free_column(&files, n_files);
+
+    // or a fixed number of hash buckets, e.g. one per worker
+    csv_partition("../examples/data/text.csv", "col1", "./buckets", 2, 0, &files, &n_files, ',');
+    printf("%zu buckets used\n", n_files);
+    csv_free_column(&files, n_files);
+
+    return 0;
+}
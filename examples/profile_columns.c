@@ -0,0 +1,17 @@
+#include "csvparser.h"
+
+int main() {
+    csv_profile* profiles = NULL;
+    size_t n_columns;
+
+    // one pass with bounded memory per column, no matter how many rows the file has
+    csv_profile_columns("../examples/data/floats.csv", &profiles, &n_columns, ',', true);
+
+    for (size_t c = 0; c < n_columns; ++c)
+        printf("%s: distinct~%.0f p50~%f p99~%f p25~%f\n", profiles[c].name, profiles[c].distinct,
+               profiles[c].p50, profiles[c].p99, csv_profile_quantile(&profiles[c], 0.25));
+
+    csv_free_profiles(&profiles, n_columns);
+
+    return 0;
+}
@@ -0,0 +1,27 @@
+#include "csvparser.h"
+
+int main() {
+    struct ArrowSchema schema;
+    struct ArrowArray array;
+
+    // the structs can be handed to any Arrow implementation (e.g. pyarrow's _import_from_c) without copying
+    csv_read_arrow("../examples/data/text.csv", &schema, &array, ',', true);
+
+    printf("%lld rows, %lld columns\n", (long long)array.length, (long long)array.n_children);
+    for (int64_t c = 0; c < array.n_children; ++c)
+    {
+        // utf8 children: buffers are validity bitmap (NULL when there are no nulls), int32 offsets and the text
+        const int32_t* offsets = array.children[c]->buffers[1];
+        const char* text = array.children[c]->buffers[2];
+        printf("%s (%s):", schema.children[c]->name, schema.children[c]->format);
+        for (int64_t r = 0; r < array.length; ++r)
+            printf(" %.*s", (int)(offsets[r + 1] - offsets[r]), text + offsets[r]);
+        printf("\n");
+    }
+
+    // whoever ends up owning the structs releases them
+    array.release(&array);
+    schema.release(&schema);
+
+    return 0;
+}
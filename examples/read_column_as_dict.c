@@ -0,0 +1,23 @@
+#include "csvparser.h"
+
+int main() {
+    csv_dict_column column;
+
+    // each distinct value is stored once; rows hold small integer codes
+    csv_read_column_by_name_as_dict("../examples/data/text.csv", "col2", &column, ',');
+
+    printf("%zu rows, %zu distinct values, %zu-byte codes\n", column.n_rows, column.n_values, column.code_size);
+    for (size_t r = 0; r < column.n_rows; ++r)
+        printf("%u -> %s\n", csv_dict_code(&column, r), column.values[csv_dict_code(&column, r)]);
+
+    // equality filters become integer comparisons
+    uint32_t code;
+    if (csv_dict_find(&column, "thing", &code))
+        for (size_t r = 0; r < column.n_rows; ++r)
+            if (csv_dict_code(&column, r) == code)
+                printf("row %zu matches\n", r);
+
+    csv_free_dict_column(&column);
+
+    return 0;
+}
@@ -0,0 +1,23 @@
+#include <inttypes.h>
+
+#include "csvparser.h"
+
+int main() {
+    int64_t* data = NULL;
+    size_t data_rows;
+
+    // ISO-8601 dates and timestamps become microseconds since 1970-01-01T00:00:00Z
+    csv_read_column_by_name_as_timestamp("../examples/data/timestamps.csv", "created_at", &data, &data_rows, ',');
+
+    for (size_t i = 0; i < data_rows; ++i)
+    {
+        if (data[i] == CSV_TIMESTAMP_INVALID)
+            printf("row %zu: not a timestamp\n", i);
+        else
+            printf("row %zu: %" PRId64 "\n", i, data[i]);
+    }
+
+    csv_free_column_timestamp(&data);
+
+    return 0;
+}
@@ -0,0 +1,21 @@
+#include "csvparser.h"
+
+int main() {
+    char*** data = NULL;
+    size_t data_dims[2];
+
+    // gzip (or zstd) input is detected from its first bytes and decompressed on a second thread while it is parsed
+    if (!csv_compression_supported(csv_detect_compression("../examples/data/floats.csv.gz")))
+    {
+        printf("this build cannot decompress the file\n");
+        return 0;
+    }
+    csv_read_compressed("../examples/data/floats.csv.gz", &data, &data_dims, ',', true);
+
+    printf("%zu rows, %zu columns\n", data_dims[0], data_dims[1]);
+    printf("first cell: %s\n", data[0][0]);
+
+    csv_free(&data, data_dims);
+
+    return 0;
+}
@@ -0,0 +1,34 @@
+#include "csvparser.h"
+
+int main() {
+    char*** data = NULL;
+    size_t data_dims[2];
+    const char* text = "name,age\nalice,31\nbob,27\n";
+
+    // parse CSV text already in memory; the buffer is not copied or modified
+    csv_source source = csv_source_from_buffer(text, strlen(text));
+    csv_read_from(&source, &data, &data_dims, ',', true);
+
+    for (size_t i = 0; i < data_dims[0]; ++i)
+    {
+        for (size_t j = 0; j < data_dims[1]; ++j)
+            printf("%s ", data[i][j]);
+        printf("\n");
+    }
+
+    csv_free(&data, data_dims);
+
+    // streams and file descriptors work the same way
+    float** floats = NULL;
+    size_t float_dims[2];
+    FILE* file = fopen("../examples/data/floats.csv", "r");
+    source = csv_source_from_stream(file);
+    csv_read_float_from(&source, &floats, &float_dims, ',', true);
+    fclose(file);
+
+    printf("%zu rows of floats, first value %f\n", float_dims[0], floats[0][0]);
+
+    csv_free_float(&floats, float_dims[0]);
+
+    return 0;
+}
@@ -0,0 +1,32 @@
+#include "csvparser.h"
+
+int main() {
+    char*** data = NULL;
+    size_t data_dims[2];
+
+    // stops reading after the first 2 rows
+    csv_read_head("../examples/data/text.csv", 2, &data, &data_dims, ',', true);
+
+    printf("Head:\n");
+    for (size_t i = 0; i < data_dims[0]; ++i)
+    {
+        for (size_t j = 0; j < data_dims[1]; ++j)
+            printf("%s ", data[i][j]);
+        printf("\n");
+    }
+    csv_free(&data, data_dims);
+
+    // scans backwards from the end of the file
+    csv_read_tail("../examples/data/text.csv", 2, &data, &data_dims, ',', true);
+
+    printf("Tail:\n");
+    for (size_t i = 0; i < data_dims[0]; ++i)
+    {
+        for (size_t j = 0; j < data_dims[1]; ++j)
+            printf("%s ", data[i][j]);
+        printf("\n");
+    }
+    csv_free(&data, data_dims);
+
+    return 0;
+}
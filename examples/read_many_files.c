@@ -0,0 +1,22 @@
+#include "csvparser.h"
+
+int main() {
+    char*** data = NULL;
+    size_t data_dims[2];
+    char* filenames[2] = {"../examples/data/floats.csv", "../examples/data/floats.csv"};
+
+    // files are parsed in parallel (0 = one thread per CPU) and concatenated in the order given
+    csv_read_many(filenames, 2, &data, &data_dims, ',', true, 0);
+
+    printf("%zu rows from 2 files:\n", data_dims[0]);
+    for (size_t i = 0; i < data_dims[0]; ++i)
+    {
+        for (size_t j = 0; j < data_dims[1]; ++j)
+            printf("%s ", data[i][j]);
+        printf("\n");
+    }
+
+    csv_free(&data, data_dims);
+
+    return 0;
+}
@@ -0,0 +1,24 @@
+#include "csvparser.h"
+
+int main() {
+    // one group per 2 rows is far too small for real files (the default is 65536), but shows groups being skipped here
+    csv_build_zone_map("../examples/data/floats.csv", 2, ',', true);
+
+    char*** data = NULL;
+    size_t data_dims[2];
+
+    // rows whose col2 is between 5 and 50; groups whose col2 min/max rule them out are never read
+    csv_read_range_by_name("../examples/data/floats.csv", "col2", "5", "50", &data, &data_dims, ',');
+
+    for (size_t i = 0; i < data_dims[0]; ++i)
+    {
+        for (size_t j = 0; j < data_dims[1]; ++j)
+            printf("%s ", data[i][j]);
+        printf("\n");
+    }
+
+    csv_free(&data, data_dims);
+    remove("../examples/data/floats.csv.zonemap");
+
+    return 0;
+}
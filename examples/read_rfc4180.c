@@ -0,0 +1,20 @@
+#include "csvparser.h"
+
+int main() {
+    char*** data = NULL;
+    size_t data_dims[2];
+
+    // quoted fields come back without their quotes, with "" unescaped and with their newlines kept
+    csv_read_rfc4180("../examples/data/quoted.csv", &data, &data_dims, ',', true);
+
+    for (size_t i = 0; i < data_dims[0]; ++i)
+    {
+        for (size_t j = 0; j < data_dims[1]; ++j)
+            printf("[%s] ", data[i][j]);
+        printf("\n");
+    }
+
+    csv_free(&data, data_dims);
+
+    return 0;
+}
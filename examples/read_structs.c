@@ -0,0 +1,29 @@
+#include "csvparser.h"
+
+struct row
+{
+    float col1;
+    double col2;
+    char col3[8];
+};
+
+int main() {
+    // each column is parsed straight into its field; no char*** is built
+    csv_binding bindings[] = {
+        CSV_BIND(struct row, col1, float, "col1"),
+        CSV_BIND(struct row, col2, double, "col2"),
+        CSV_BIND(struct row, col3, chars, "col3"),
+    };
+
+    void* structs = NULL;
+    size_t n_structs;
+    csv_read_structs("../examples/data/floats.csv", bindings, 3, sizeof(struct row), &structs, &n_structs, ',');
+
+    struct row* rows = structs;
+    for (size_t i = 0; i < n_structs; ++i)
+        printf("%f %f %s\n", rows[i].col1, rows[i].col2, rows[i].col3);
+
+    csv_free_structs(&structs, n_structs, bindings, 3, sizeof(struct row));
+
+    return 0;
+}
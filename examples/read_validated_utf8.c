@@ -0,0 +1,19 @@
+#include "csvparser.h"
+
+int main() {
+    char*** data = NULL;
+    size_t data_dims[2];
+    csv_utf8_error error;
+
+    // the file is checked as it is read; on bad input only the rows before it are returned
+    csv_read_validated("../examples/data/text.csv", &data, &data_dims, ',', true, &error);
+
+    if (error.found)
+        printf("invalid UTF-8 at line %zu, column %zu (byte %zu)\n", error.line, error.column, error.offset);
+    else
+        printf("%zu rows of valid UTF-8\n", data_dims[0]);
+
+    csv_free(&data, data_dims);
+
+    return 0;
+}
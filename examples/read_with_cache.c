@@ -0,0 +1,26 @@
+#include "csvparser.h"
+
+int main() {
+    float** data = NULL;
+    size_t data_dims[2];
+
+    // the first read writes ../examples/data/floats.csv.csvcache; later reads map it instead of parsing
+    csv_set_cache(true);
+
+    for (int i = 0; i < 2; ++i)
+    {
+        csv_read_float("../examples/data/floats.csv", &data, &data_dims, ',', true);
+
+        printf("Data:\n");
+        for (size_t r = 0; r < data_dims[0]; ++r)
+        {
+            for (size_t c = 0; c < data_dims[1]; ++c)
+                printf("%f ", data[r][c]);
+            printf("\n");
+        }
+
+        csv_free_float(&data, data_dims[0]);
+    }
+
+    return 0;
+}
@@ -0,0 +1,22 @@
+#include "csvparser.h"
+
+int main() {
+    char*** data = NULL;
+    size_t data_dims[2];
+
+    // 2 random rows; only their offsets are kept while the file is scanned
+    csv_sample("../examples/data/text.csv", 2, 42, &data, &data_dims, ',', true);
+    printf("uniform sample:\n");
+    for (size_t i = 0; i < data_dims[0]; ++i)
+        printf("%s %s %s\n", data[i][0], data[i][1], data[i][2]);
+    csv_free(&data, data_dims);
+
+    // 1 random row for every distinct value of col1
+    csv_sample_stratified("../examples/data/text.csv", "col1", 1, 42, &data, &data_dims, ',');
+    printf("one row per col1 value:\n");
+    for (size_t i = 0; i < data_dims[0]; ++i)
+        printf("%s %s %s\n", data[i][0], data[i][1], data[i][2]);
+    csv_free(&data, data_dims);
+
+    return 0;
+}
@@ -0,0 +1,25 @@
+#include "csvparser.h"
+
+int main() {
+    char* key_columns[1] = {"col2"};
+    csv_sort_order orders[1] = {CSV_SORT_DESCENDING};
+
+    // sort by col2, largest first; files larger than the budget are sorted in runs spilled to temporary files
+    csv_sort("../examples/data/floats.csv", "sorted.csv", key_columns, orders, 1, 64 * 1024 * 1024, ',');
+
+    char*** data = NULL;
+    size_t data_dims[2];
+    csv_read("sorted.csv", &data, &data_dims, ',', true);
+
+    for (size_t i = 0; i < data_dims[0]; ++i)
+    {
+        for (size_t j = 0; j < data_dims[1]; ++j)
+            printf("%s ", data[i][j]);
+        printf("\n");
+    }
+
+    csv_free(&data, data_dims);
+    remove("sorted.csv");
+
+    return 0;
+}
@@ -0,0 +1,45 @@
+#ifndef CSVPARSER_ALLOC_H
+#define CSVPARSER_ALLOC_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+/**
+ * @description Memory functions used for every allocation the library makes, from parsed cells to the arrays returned to the caller.
+ * Each function receives the allocator's context pointer first, e.g. an arena, a memory pool or a per-tenant accounting structure.
+ * All four functions must be set; free may do nothing if the memory is released in bulk (e.g. when an arena is reset).
+ * Data must be freed (csv_free() and friends) under the same allocator it was allocated with.
+ * Line buffers filled by getline() belong to the C library and do not go through the allocator.
+ */
+typedef struct csv_allocator
+{
+    void* (*malloc)(void* context, size_t size);
+    void* (*calloc)(void* context, size_t count, size_t size);
+    void* (*realloc)(void* context, void* pointer, size_t size);
+    void (*free)(void* context, void* pointer);
+    void* context;
+} csv_allocator;
+
+/**
+ * @description Set the allocator used by all threads that have no allocator of their own (see csv_set_thread_allocator()).
+ * The allocator is copied. Set it before any other thread uses the library.
+ * @param allocator Allocator to use, or NULL to go back to malloc(), calloc(), realloc() and free().
+ */
+void csv_set_allocator(const csv_allocator* allocator);
+
+/**
+ * @description Set the allocator used by the calling thread only, overriding the global one. Threads the library starts for a call
+ * (e.g. csv_read_many()) use the allocator of the thread that made the call. To use an allocator for a single call, set it before the call
+ * and clear it after.
+ * @param allocator Allocator to use, or NULL to go back to the global allocator.
+ */
+void csv_set_thread_allocator(const csv_allocator* allocator);
+
+/**
+ * @description Get the allocator in effect for the calling thread.
+ * @return The calling thread's allocator if set, otherwise the global allocator.
+ */
+const csv_allocator* csv_get_allocator(void);
+
+#endif //CSVPARSER_ALLOC_H
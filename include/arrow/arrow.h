@@ -0,0 +1,74 @@
+#ifndef CSVPARSER_ARROW_H
+#define CSVPARSER_ARROW_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "source/source.h"
+
+// the structs below are the Arrow C Data Interface (https://arrow.apache.org/docs/format/CDataInterface.html),
+// defined here so no Arrow headers or libraries are needed; the guard lets them coexist with Arrow's own copy
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema
+{
+    const char* format;
+    const char* name;
+    const char* metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema** children;
+    struct ArrowSchema* dictionary;
+    void (*release)(struct ArrowSchema*);
+    void* private_data;
+};
+
+struct ArrowArray
+{
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void** buffers;
+    struct ArrowArray** children;
+    struct ArrowArray* dictionary;
+    void (*release)(struct ArrowArray*);
+    void* private_data;
+};
+
+#endif //ARROW_C_DATA_INTERFACE
+
+/**
+ * @description Read a CSV file straight into Arrow C Data Interface structs, e.g. for pyarrow, DuckDB or Arrow C++ to import without copying.
+ * The result is a struct array ("+s") with one nullable string child per column: utf8 ("u"), or large_utf8 ("U") for a column holding more than 2 GB of text.
+ * Cells are parsed directly into the Arrow offset, data and validity buffers, which are handed over as they are; no char*** is built.
+ * Cell text is the same as csv_read() returns, except that empty or missing cells are null instead of "(null)". Extra cells beyond the first line's column count are dropped.
+ * The consumer owns both structs and must call their release callbacks (importing them into Arrow does this). Buffers are released with the allocator
+ * that was in effect when they were read (see alloc/alloc.h), whichever thread releases them.
+ * @param filename Filename to read CSV file from.
+ * @param schema An ArrowSchema passed by address to store the type of the result. Child names are the column names, or "" without headers.
+ * @param array An ArrowArray passed by address to store the data.
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the file has headers or not. If true, the first line gives the column names.
+ */
+void csv_read_arrow(const char* filename, struct ArrowSchema* schema, struct ArrowArray* array, char delim, bool has_headers);
+
+/**
+ * @description Read CSV text from a csv_source in a single pass straight into Arrow C Data Interface structs. See csv_read_arrow().
+ * @param source A csv_source created with csv_source_from_buffer(), csv_source_from_stream() or csv_source_from_fd(). It is read once, from its current position.
+ * @param schema An ArrowSchema passed by address to store the type of the result.
+ * @param array An ArrowArray passed by address to store the data.
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the input has headers or not. If true, the first line gives the column names.
+ */
+void csv_read_arrow_from(csv_source* source, struct ArrowSchema* schema, struct ArrowArray* array, char delim, bool has_headers);
+
+#endif //CSVPARSER_ARROW_H
@@ -0,0 +1,70 @@
+#ifndef CSVPARSER_BIND_H
+#define CSVPARSER_BIND_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "source/source.h"
+
+// parses a cell (\0 terminated, as csv_read() would return it: quotes kept, "(null)" when empty) into a struct field of field_size bytes
+typedef void (*csv_bind_parser)(const char* cell, void* field, size_t field_size);
+
+// binds a CSV column, by name, to a field of a struct
+typedef struct csv_binding
+{
+    const char* column;
+    size_t offset;
+    size_t size;
+    csv_bind_parser parser;
+} csv_binding;
+
+/**
+ * @description Build a csv_binding for a struct field, e.g. CSV_BIND(struct trade, price, double, "price").
+ * type picks the parser csv_bind_<type>() and is one of int, long, int64_t, float, double, bool, string (a char* field that gets its own copy of the cell)
+ * or chars (a char array field that gets as much of the cell as fits, always \0 terminated).
+ * For any other field type, fill in a csv_binding with a csv_bind_parser of your own instead.
+ */
+#define CSV_BIND(struct_type, field, type, column) \
+    { (column), offsetof(struct_type, field), sizeof(((struct_type*)0)->field), &csv_bind_##type }
+
+// parsers used by CSV_BIND(); numbers are parsed like strtol()/strtod(), so a cell that is not a number gives 0
+void csv_bind_int(const char* cell, void* field, size_t field_size);
+void csv_bind_long(const char* cell, void* field, size_t field_size);
+void csv_bind_int64_t(const char* cell, void* field, size_t field_size);
+void csv_bind_float(const char* cell, void* field, size_t field_size);
+void csv_bind_double(const char* cell, void* field, size_t field_size);
+// "true", "yes" and "1" (in any case) are true, anything else is false
+void csv_bind_bool(const char* cell, void* field, size_t field_size);
+void csv_bind_string(const char* cell, void* field, size_t field_size);
+void csv_bind_chars(const char* cell, void* field, size_t field_size);
+
+/**
+ * @description Read a CSV file straight into an array of structs, using bindings to map columns to fields. The columns are looked up in the header once;
+ * after that every row is split in place and each bound cell is parsed directly into its field, so no char*** is ever built.
+ * Fields without a binding, or bound to a column the file does not have, are zero. Several fields may be bound to the same column.
+ * @param filename Filename to read CSV file from. The first line must contain the column names.
+ * @param bindings Array of bindings, usually written with CSV_BIND().
+ * @param n_bindings Number of bindings.
+ * @param struct_size Size of the struct, i.e. sizeof(struct trade).
+ * @param structs A pointer passed by address to allocate and store one struct per row. Free it with csv_free_structs() (see free/free.h).
+ * @param n_structs A size_t passed by address to store the number of rows read.
+ * @param delim A single-character delimiter.
+ */
+void csv_read_structs(const char* filename, const csv_binding* bindings, size_t n_bindings, size_t struct_size, void** structs, size_t* n_structs, char delim);
+
+/**
+ * @description Read CSV text from a csv_source in a single pass straight into an array of structs. See csv_read_structs().
+ * @param source A csv_source created with csv_source_from_buffer(), csv_source_from_stream() or csv_source_from_fd(). It is read once, from its current position.
+ * @param bindings Array of bindings, usually written with CSV_BIND().
+ * @param n_bindings Number of bindings.
+ * @param struct_size Size of the struct.
+ * @param structs A pointer passed by address to allocate and store one struct per row. Free it with csv_free_structs() (see free/free.h).
+ * @param n_structs A size_t passed by address to store the number of rows read.
+ * @param delim A single-character delimiter.
+ */
+void csv_read_structs_from(csv_source* source, const csv_binding* bindings, size_t n_bindings, size_t struct_size, void** structs, size_t* n_structs, char delim);
+
+#endif //CSVPARSER_BIND_H
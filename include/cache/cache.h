@@ -0,0 +1,19 @@
+#ifndef CSVPARSER_CACHE_H
+#define CSVPARSER_CACHE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+/**
+ * @description Enable or disable the binary columnar cache (disabled by default).
+ * While enabled, the first csv_read(), csv_read_int(), csv_read_float() or column read of a file writes a sidecar next to it (filename + ".csvcache")
+ * holding every column's cells, a validity bitmap and, for numeric columns, pre-cast int and float arrays. Later reads of the same file with the same delimiter
+ * memory map the sidecar instead of parsing the CSV again. The sidecar is rebuilt automatically when the file's size or modification time changes.
+ * Select and ignore functions use the cache through the column readers. Rows are padded/truncated to the column count of the first line.
+ * If the sidecar cannot be written (e.g. read-only directory) the file is parsed as usual.
+ * @param enabled true to enable the cache, false to disable it.
+ */
+void csv_set_cache(bool enabled);
+
+#endif //CSVPARSER_CACHE_H
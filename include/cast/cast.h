@@ -3,6 +3,10 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+
+// timestamp of a cell that is not an ISO-8601 date or timestamp (including empty cells)
+#define CSV_TIMESTAMP_INVALID INT64_MIN
 
 /**
  * @description Convert CSV data (char***) to integers (int**).
@@ -36,4 +40,60 @@ void csv_column_to_int(char** data, size_t data_rows, int** int_data);
  */
 void csv_column_to_float(char** data, size_t data_rows, float** float_data);
 
+/**
+ * @description Convert CSV data (char***) to integers (int**) using several threads. The result is identical to csv_data_to_int().
+ * @param data A char*** pointer to data loaded with csv_read().
+ * @param data_dims size_t[2] array specifying dimensions of the data with the 0th index counting the rows and 1st index counting the columns
+ * @param int_data An int** pointer passed by address to allocate and store the casted integers from data.
+ * @param n_threads Number of threads converting blocks of rows (0 = one per CPU).
+ */
+void csv_data_to_int_parallel(char*** data, size_t data_dims[2], int*** int_data, size_t n_threads);
+
+/**
+ * @description Convert CSV data (char***) to floats (float**) using several threads. The result is identical to csv_data_to_float().
+ * @param data A char*** pointer to data loaded with csv_read().
+ * @param data_dims size_t[2] array specifying dimensions of the data with the 0th index counting the rows and 1st index counting the columns
+ * @param float_data A float** pointer passed by address to allocate and store the casted floats from data.
+ * @param n_threads Number of threads converting blocks of rows (0 = one per CPU).
+ */
+void csv_data_to_float_parallel(char*** data, size_t data_dims[2], float*** float_data, size_t n_threads);
+
+/**
+ * @description Convert CSV column data (char**) to ints (int*) using several threads. The result is identical to csv_column_to_int().
+ * @param data A char** pointer to data loaded with csv_read_column_by_name() or csv_read_column_by_index().
+ * @param data_rows size_t variable specifying how many rows are present in the data.
+ * @param int_data An int* pointer passed by address to allocate and store the casted integers from data.
+ * @param n_threads Number of threads converting blocks of rows (0 = one per CPU).
+ */
+void csv_column_to_int_parallel(char** data, size_t data_rows, int** int_data, size_t n_threads);
+
+/**
+ * @description Convert CSV column data (char**) to floats (float*) using several threads. The result is identical to csv_column_to_float().
+ * @param data A char** pointer to data loaded with csv_read_column_by_name() or csv_read_column_by_index().
+ * @param data_rows size_t variable specifying how many rows are present in the data.
+ * @param float_data A float* pointer passed by address to allocate and store the casted floats from data.
+ * @param n_threads Number of threads converting blocks of rows (0 = one per CPU).
+ */
+void csv_column_to_float_parallel(char** data, size_t data_rows, float** float_data, size_t n_threads);
+
+/**
+ * @description Convert CSV column data (char**) holding ISO-8601 dates or timestamps to microseconds since 1970-01-01T00:00:00Z (int64_t*).
+ * Accepted layouts are YYYY-MM-DD, and YYYY-MM-DDTHH:MM with optional :SS, optional fractional seconds (digits past microseconds are dropped)
+ * and an optional Z, +HH, +HHMM or +HH:MM (or -) offset; a space may stand in for the T, and the cell may be in double quotes.
+ * Times without an offset are taken as UTC and dates as midnight UTC. Any other cell becomes CSV_TIMESTAMP_INVALID.
+ * @param data A char** pointer to data loaded with csv_read_column_by_name() or csv_read_column_by_index().
+ * @param data_rows size_t variable specifying how many rows are present in the data.
+ * @param timestamp_data An int64_t* pointer passed by address to allocate and store the timestamps.
+ */
+void csv_column_to_timestamp(char** data, size_t data_rows, int64_t** timestamp_data);
+
+/**
+ * @description Convert CSV column data (char**) to timestamps (int64_t*) using several threads. The result is identical to csv_column_to_timestamp().
+ * @param data A char** pointer to data loaded with csv_read_column_by_name() or csv_read_column_by_index().
+ * @param data_rows size_t variable specifying how many rows are present in the data.
+ * @param timestamp_data An int64_t* pointer passed by address to allocate and store the timestamps.
+ * @param n_threads Number of threads converting blocks of rows (0 = one per CPU).
+ */
+void csv_column_to_timestamp_parallel(char** data, size_t data_rows, int64_t** timestamp_data, size_t n_threads);
+
 #endif //CSVPARSER_CAST_H
@@ -0,0 +1,59 @@
+#ifndef CSVPARSER_COMPRESS_H
+#define CSVPARSER_COMPRESS_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "source/source.h"
+
+// how an input is compressed, as told by its first bytes
+typedef enum csv_compression
+{
+    CSV_COMPRESSION_NONE,
+    CSV_COMPRESSION_GZIP,
+    CSV_COMPRESSION_ZSTD
+} csv_compression;
+
+/**
+ * @description Check whether this build of the library can decompress a format. gzip needs zlib and zstd needs libzstd when the library is built;
+ * each is used if CMake finds it (turn them off with -DCSV_WITH_ZLIB=OFF or -DCSV_WITH_ZSTD=OFF). Uncompressed input is always supported.
+ * @param compression The format to check.
+ * @return true if inputs compressed this way can be read.
+ */
+bool csv_compression_supported(csv_compression compression);
+
+/**
+ * @description Tell how a file is compressed from its magic bytes (1f 8b for gzip, 28 b5 2f fd for zstd), whatever its name.
+ * @param filename Filename of the file to check.
+ * @return The compression of the file, CSV_COMPRESSION_NONE for anything else.
+ */
+csv_compression csv_detect_compression(const char* filename);
+
+/**
+ * @description Read CSV text from a file descriptor holding gzip, zstd or uncompressed data, detected by magic bytes. A thread of its own reads and decompresses
+ * the input into a ring of buffers while the caller parses the buffers already filled, so decompression and parsing overlap and nothing is written to disk.
+ * Concatenated gzip members and zstd frames are read one after another. Corrupt or truncated input ends the program with an error, like a missing file does.
+ * Works with every *_from() function; the descriptor is read forwards once (so pipes work) and is not closed. Release the source with csv_source_close().
+ * @param fd The file descriptor to read from.
+ * @return A csv_source for the decompressed text.
+ */
+csv_source csv_source_from_compressed_fd(int fd);
+
+/**
+ * @description Stop the decompression thread of a source from csv_source_from_compressed_fd() and free its buffers. Does nothing for other sources.
+ * @param source The source to close, passed by address.
+ */
+void csv_source_close(csv_source* source);
+
+/**
+ * @description Same as csv_read() for a file that may be gzip or zstd compressed (see csv_source_from_compressed_fd()). Uncompressed files are read as they are.
+ * @param filename Filename to read CSV file from.
+ * @param data A char*** passed by address that holds the CSV cells. It's structured as data[x][y] where x represents the row, y represents the column and the contents is a string (char*).
+ * @param data_dims A size_t[2] array passed by address with two indices: 0th index stores the row count and 1st index stores the column count.
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the file has headers or not. If true, the first line will be skipped and not stored into data.
+ */
+void csv_read_compressed(const char* filename, char**** data, size_t (*data_dims)[2], char delim, bool has_headers);
+
+#endif //CSVPARSER_COMPRESS_H
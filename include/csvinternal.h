@@ -5,22 +5,266 @@
 #include <string.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <stdint.h>
+
+#include "source/source.h"
+#include "utf8/utf8.h"
+
+// internal function
+// malloc(), calloc(), realloc(), strdup() and free() through the calling thread's csv_allocator (see alloc/alloc.h)
+// every allocation that can reach the caller (or is freed by csv_free() and friends) must use these
+void* csv_malloc(size_t size);
+
+// internal function
+void* csv_calloc(size_t count, size_t size);
+
+// internal function
+void* csv_realloc(void* pointer, size_t size);
+
+// internal function
+char* csv_strdup(const char* string);
+
+// internal function
+// free() counterpart of csv_malloc(); NULL is ignored
+void csv_dealloc(void* pointer);
 
 // internal function
 // counts columns based on delimiter
 // used to size the tokens array within csv_parse_line
 size_t csv_count_columns(const char* line, char delim);
 
+// internal function
+// same as csv_count_columns() for a line of len bytes that need not be \0 terminated
+size_t csv_count_columns_n(const char* line, size_t len, char delim);
+
 // internal function
 // parses a line of CSV and stores parsed values into tokens
 // tokens must be freed by the client
 // returns number of tokens that were extracted. can be used by client when freeing memory
 size_t csv_parse_line(const char* line, char delim, char*** tokens);
 
+// internal function
+// same as csv_parse_line() for a line of len bytes that need not be \0 terminated (e.g. a line inside a memory buffer)
+size_t csv_parse_line_n(const char* line, size_t len, char delim, char*** tokens);
+
+// internal line reader over a csv_source (see source/source.h)
+// lines from a buffer point straight into it; streams use getline() and file descriptors read() into a chunk,
+// as do compressed sources, which take the chunk from their decompression thread instead
+typedef struct csv_reader
+{
+    const csv_source* source;
+    size_t position;
+    char* chunk;
+    size_t chunk_start;
+    size_t chunk_end;
+    size_t chunk_capacity;
+    bool eof;
+    const char* last_line;
+    size_t last_len;
+    bool replay;
+    size_t line_number;
+    size_t consumed;
+    char utf8_delim;
+    csv_utf8_error* utf8_error;
+    char* record;
+    size_t record_capacity;
+} csv_reader;
+
+// internal function
+// prepares reader to read lines from source
+void csv_reader_init(csv_reader* reader, const csv_source* source);
+
+// internal function
+// gets the next line (including its trailing \n, like getline()) into line and len. the line is not \0 terminated
+// and is only valid until the next call. returns false once the input is exhausted
+bool csv_reader_next(csv_reader* reader, const char** line, size_t* len);
+
+// internal function
+// makes reader check every line it hands out for valid UTF-8; at the first invalid line error is filled in
+// and csv_reader_next() returns false as if the input had ended there
+void csv_reader_validate_utf8(csv_reader* reader, char delim, csv_utf8_error* error);
+
+// internal function
+// makes the next csv_reader_next() return the line it just returned again (e.g. after peeking at the first line)
+void csv_reader_unread(csv_reader* reader);
+
+// internal function
+// gets the next RFC 4180 record into record and len: a line plus, while a quoted field is still open, the lines after it,
+// so newlines inside quotes stay part of the record. a record that fits on one line points into the reader like csv_reader_next();
+// longer ones are joined in a buffer owned by the reader. returns false once the input is exhausted
+bool csv_reader_next_record(csv_reader* reader, const char** record, size_t* len);
+
+// internal function
+// parses an RFC 4180 record of len bytes into tokens: quoted fields lose their surrounding quotes and "" inside them becomes "
+// a trailing \n or \r\n ends the record, empty fields are "(null)" and records without any quote go through csv_parse_line_n()
+// returns number of tokens that were extracted
+size_t csv_parse_record(const char* record, size_t len, char delim, char*** tokens);
+
+// internal function
+// frees the reader's buffers (the source itself is left open)
+void csv_reader_free(csv_reader* reader);
+
+// internal function
+// copies up to capacity bytes of decompressed input into buffer (see compress/compress.c), waiting for the decompression thread if needed
+// returns 0 once the input is exhausted
+size_t csv_decompressor_read(struct csv_decompressor* decompressor, char* buffer, size_t capacity);
+
+// internal function
+// reads up to max_rows rows from reader into data, skipping the first line if has_headers; data_dims[1] is the first line's column count
+void csv_read_rows(csv_reader* reader, size_t max_rows, char**** data, size_t (*data_dims)[2], char delim, bool has_headers);
+
+// internal function
+// length of the UTF-8 byte order mark at the start of a line of len bytes (3, or 0 if there is none)
+size_t csv_bom_length(const char* line, size_t len);
+
+// internal function
+// returns the length of a header line without its terminator (\n or \r\n), so the last column name of a CRLF file does not keep the \r
+size_t csv_header_length(const char* line, size_t len);
+
+// internal function
+// moves a file that is at its start past a leading byte order mark and returns the mark's length (0 if there is none)
+size_t csv_skip_bom(FILE* file);
+
+// internal function
+// offset of the first invalid UTF-8 sequence in len bytes of data, or len if they are all valid UTF-8
+// sequences never span lines, so each line can be checked on its own
+size_t csv_utf8_validate(const char* data, size_t len);
+
+// internal function
+// reads the first line from reader and parses it into columns, like csv_get_column_names() does for a file
+// returns 0 (and sets columns to NULL) if the input is empty
+size_t csv_reader_header(csv_reader* reader, char delim, char*** columns);
+
+// internal function
+// reads every remaining line from reader and keeps the columns at column_indices, in that order, as data[row][column]
+// columns missing from a row are stored as "(null)"
+void csv_select_rows(csv_reader* reader, const size_t* column_indices, size_t n_columns, char**** data, size_t (*data_dims)[2], char delim);
+
+// internal function
+// splits a line of CSV in place by overwriting unquoted delimiters (and the trailing newline) with \0
+// pointers to the start of each field are stored into fields, up to max_fields of them
+// nothing is allocated so fields are only valid while line is; quotes are kept just like csv_parse_line()
+// returns the number of fields on the line, which may be larger than max_fields
+size_t csv_split_line(char* line, char delim, char** fields, size_t max_fields);
+
+// internal function
+// finds the cell at column_index in a line of len bytes (a trailing newline is ignored) without copying or modifying it
+// quotes are kept and delimiters inside them are skipped just like csv_parse_line()
+// returns false if the line has no such column
+bool csv_find_cell(const char* line, size_t len, char delim, size_t column_index, const char** cell, size_t* cell_len);
+
+// internal function
+// reads the header line from file and looks up each of column_names in it
+// the matching index is stored into column_indices, or SIZE_MAX when the column does not exist
+// returns the number of columns in the header
+size_t csv_find_columns(FILE* file, char delim, char** column_names, size_t n_columns, size_t* column_indices);
+
+// internal arena used to intern strings (e.g. group keys) so each distinct value is allocated once
+// everything allocated from the arena is released together by csv_arena_free()
+struct csv_arena_block;
+typedef struct csv_arena
+{
+    struct csv_arena_block* head;
+} csv_arena;
+
+// internal function
+// allocates size bytes from the arena
+void* csv_arena_alloc(csv_arena* arena, size_t size);
+
+// internal function
+// copies value into the arena and returns the copy
+char* csv_arena_strdup(csv_arena* arena, const char* value);
+
+// internal function
+// frees every block owned by the arena
+void csv_arena_free(csv_arena* arena);
+
+// open addressing table mapping hashes to the indices of entries the caller stores itself;
+// the caller compares keys, the table only finds candidates. index is stored + 1 so a zeroed slot is empty
+typedef struct csv_hash_slot
+{
+    uint64_t hash;
+    size_t index;
+} csv_hash_slot;
+
+typedef struct csv_hash_table
+{
+    csv_hash_slot* slots;
+    size_t capacity; // always a power of two
+    size_t count;
+} csv_hash_table;
+
+// internal function
+// creates an empty table with room for capacity slots (a power of two)
+void csv_hash_table_init(csv_hash_table* table, size_t capacity);
+
+// internal function
+// returns the slot to start probing from for hash
+size_t csv_hash_table_start(const csv_hash_table* table, uint64_t hash);
+
+// internal function
+// returns the index of the next entry stored under hash at or after *pos, moving *pos past it
+// returns SIZE_MAX once an empty slot is reached, leaving *pos at that slot for csv_hash_table_insert()
+size_t csv_hash_table_next(const csv_hash_table* table, uint64_t hash, size_t* pos);
+
+// internal function
+// stores index under hash in the empty slot pos found by csv_hash_table_next(), growing the table as needed
+void csv_hash_table_insert(csv_hash_table* table, uint64_t hash, size_t pos, size_t index);
+
+// internal function
+// frees the table's slots
+void csv_hash_table_free(csv_hash_table* table);
+
+// internal function
+// creates a uniquely named temporary file (path.tmp.XXXXXX, see mkstemp()) for a sidecar that is renamed over path once written,
+// so threads or processes building the same sidecar at once never write to the same file
+// returns the open descriptor, or -1 on failure; tmp_path receives the name either way and must be freed with csv_dealloc()
+int csv_create_temp_file(const char* path, char** tmp_path);
+
+// internal function
+// 64-bit hash (FNV-1a with a murmur3 finalizer) of len bytes of data.
+// seed can be a previous hash to combine several fields into one key
+uint64_t csv_hash(const void* data, size_t len, uint64_t seed);
+
+// internal function
+// frees a quantile sketch owned by a csv_profile (see profile/profile.h)
+struct csv_quantile_sketch;
+void csv_quantile_sketch_free(struct csv_quantile_sketch* sketch);
+
+// internal functions
+// serve csv_read(), csv_read_int(), csv_read_float() and the by-index column readers from the binary cache (see cache/cache.h),
+// building the sidecar first if it is missing or stale. they return false when the cache is disabled or cannot be used,
+// in which case the caller parses the file itself
+bool csv_cache_read(const char* filename, char delim, bool has_headers, char**** data, size_t (*data_dims)[2]);
+bool csv_cache_read_int(const char* filename, char delim, bool has_headers, int*** data, size_t (*data_dims)[2]);
+bool csv_cache_read_float(const char* filename, char delim, bool has_headers, float*** data, size_t (*data_dims)[2]);
+bool csv_cache_read_column(const char* filename, size_t column_index, char delim, bool has_headers, char*** data, size_t* data_rows);
+bool csv_cache_read_column_int(const char* filename, size_t column_index, char delim, bool has_headers, int** data, size_t* data_rows);
+bool csv_cache_read_column_float(const char* filename, size_t column_index, char delim, bool has_headers, float** data, size_t* data_rows);
+
+// internal function
+// number of worker threads to use: requested, or one per online CPU when requested is 0
+size_t csv_thread_count(size_t requested);
+
+// internal function
+// runs task(context, i) for every i in [0, n_tasks) on a bounded pool of up to n_threads threads (0 = one per online CPU)
+// each thread starts with a contiguous share of the indices and steals from the back of other threads' shares when it runs out
+// returns once every task has finished
+void csv_parallel_for(size_t n_tasks, size_t n_threads, void (*task)(void* context, size_t index), void* context);
+
+// internal function
+// same result as (int)strtol(cell, &end, 10), faster for plain integers (see cast/cast.c)
+int csv_parse_int(const char* cell);
+
+// internal function
+// same result as strtof(cell, &end), faster for short decimals (see cast/cast.c)
+float csv_parse_float(const char* cell);
+
 // internal function
 // get the column names and return how many columns are present.
 // this is a special case of csv_parse_line() where we pass the filename and read the first line
 // rather than specifying the actual line within the file
+// returns 0 (and sets columns to NULL) if the file cannot be opened
 size_t csv_get_column_names(const char* filename, char delim, char*** columns);
 
 #endif //CSVPARSER_CSVINTERNAL_H
@@ -6,5 +6,25 @@
 #include "read/read.h"
 #include "select/select.h"
 #include "ignore/ignore.h"
+#include "stats/stats.h"
+#include "groupby/groupby.h"
+#include "profile/profile.h"
+#include "dict/dict.h"
+#include "cache/cache.h"
+#include "many/many.h"
+#include "source/source.h"
+#include "alloc/alloc.h"
+#include "sort/sort.h"
+#include "join/join.h"
+#include "follow/follow.h"
+#include "arrow/arrow.h"
+#include "zonemap/zonemap.h"
+#include "keyindex/keyindex.h"
+#include "bind/bind.h"
+#include "utf8/utf8.h"
+#include "rfc4180/rfc4180.h"
+#include "compress/compress.h"
+#include "sample/sample.h"
+#include "partition/partition.h"
 
 #endif //CSVPARSER_CSVPARSER_H
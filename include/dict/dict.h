@@ -0,0 +1,84 @@
+#ifndef CSVPARSER_DICT_H
+#define CSVPARSER_DICT_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+struct csv_arena;
+
+/**
+ * @description A dictionary-encoded string column: each distinct cell is stored once in values and every row holds a small integer code into it.
+ * codes is a uint8_t*, uint16_t* or uint32_t* array (code_size of 1, 2 or 4 bytes), using the narrowest type that fits n_values. Use csv_dict_code() to read a code regardless of its width.
+ * Cells are the same strings csv_read() would return (empty cells are "(null)").
+ */
+typedef struct csv_dict_column
+{
+    char** values;
+    size_t n_values;
+    void* codes;
+    size_t code_size;
+    size_t n_rows;
+    struct csv_arena* arena;
+} csv_dict_column;
+
+/**
+ * @description Read a single column (by index) from CSV file as a dictionary-encoded column.
+ * @param filename Filename to read CSV file from.
+ * @param column_index Index of the column to read.
+ * @param column A csv_dict_column passed by address to store the distinct values and the per-row codes. Must be freed with csv_free_dict_column().
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the file has headers or not. If true, the first line will be skipped and not stored into column.
+ */
+void csv_read_column_by_index_as_dict(const char* filename, size_t column_index, csv_dict_column* column, char delim, bool has_headers);
+
+/**
+ * @description Read a single column (by name) from CSV file as a dictionary-encoded column.
+ * @param filename Filename to read CSV file from.
+ * @param column_name Name of the column to read.
+ * @param column A csv_dict_column passed by address to store the distinct values and the per-row codes. Must be freed with csv_free_dict_column().
+ * @param delim A single-character delimiter.
+ */
+void csv_read_column_by_name_as_dict(const char* filename, const char* column_name, csv_dict_column* column, char delim);
+
+/**
+ * @description Select columns (by index) from CSV file as dictionary-encoded columns in a single pass over the file.
+ * @param filename Filename to read CSV file from.
+ * @param column_indices A size_t array of indices specifying which columns to select from the CSV file.
+ * @param n_columns Total number of columns being selected (length of column_indices).
+ * @param columns A csv_dict_column* passed by address to allocate and store one csv_dict_column per selected column. Must be freed with csv_free_dict_columns().
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the file has headers or not. If true, the first line will be skipped and not stored into columns.
+ */
+void csv_select_by_index_as_dict(const char* filename, size_t* column_indices, size_t n_columns, csv_dict_column** columns, char delim, bool has_headers);
+
+/**
+ * @description Select columns (by name) from CSV file as dictionary-encoded columns in a single pass over the file.
+ * @param filename Filename to read CSV file from.
+ * @param column_names An array of character strings specifying which columns to select from the CSV file.
+ * @param n_columns Total number of columns being selected (length of column_names).
+ * @param columns A csv_dict_column* passed by address to allocate and store one csv_dict_column per selected column. Must be freed with csv_free_dict_columns().
+ * @param delim A single-character delimiter.
+ */
+void csv_select_by_name_as_dict(const char* filename, char** column_names, size_t n_columns, csv_dict_column** columns, char delim);
+
+/**
+ * @description Get the code of a row in a dictionary-encoded column. column->values[code] is the cell's string.
+ * @param column A csv_dict_column loaded by one of the *_as_dict() functions.
+ * @param row The row to look up.
+ * @return The row's code.
+ */
+uint32_t csv_dict_code(const csv_dict_column* column, size_t row);
+
+/**
+ * @description Find the code of a value so equality filters can compare codes instead of strings.
+ * @param column A csv_dict_column loaded by one of the *_as_dict() functions.
+ * @param value The string to look for.
+ * @param code A uint32_t passed by address to store the value's code if it is found.
+ * @return true if value occurs in the column, false otherwise.
+ */
+bool csv_dict_find(const csv_dict_column* column, const char* value, uint32_t* code);
+
+#endif //CSVPARSER_DICT_H
@@ -0,0 +1,68 @@
+#ifndef CSVPARSER_FOLLOW_H
+#define CSVPARSER_FOLLOW_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <sys/types.h>
+
+/**
+ * @description State for following a CSV file that is being appended to (like tail -f). Open it with csv_follow_open(), call csv_follow_poll()
+ * whenever new rows may have been written (on a timer, after csv_follow_wait() or after your own inotify event) and release it with csv_follow_close().
+ * Each poll parses only the bytes appended since the previous one; a row is returned once its terminating newline has been written.
+ * If the file is truncated it is read again from the start. If it is rotated (filename now refers to a different file) the rest of the old file is
+ * returned first and the new file is then followed from its start. With has_headers the first line of every file followed is skipped.
+ * rotations and truncations count how often each has been seen; n_columns is the column count of the first line of the current file (0 until known).
+ */
+typedef struct csv_follow
+{
+    char* filename;
+    int fd;
+    dev_t device;
+    ino_t inode;
+    off_t offset;
+    char* partial;
+    size_t partial_len;
+    size_t partial_capacity;
+    char delim;
+    bool has_headers;
+    bool at_first_line;
+    size_t n_columns;
+    size_t rotations;
+    size_t truncations;
+} csv_follow;
+
+/**
+ * @description Start following a CSV file.
+ * @param filename Filename of the CSV file to follow. It must exist.
+ * @param follow A csv_follow passed by address to initialise.
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the file has headers or not. If true, the first line of each file followed is skipped.
+ * @param from_end If true only rows completed after this call are returned (like tail -f); if false the rows already in the file are returned by the first poll.
+ */
+void csv_follow_open(const char* filename, csv_follow* follow, char delim, bool has_headers, bool from_end);
+
+/**
+ * @description Parse the rows appended to the followed file since the last poll. Incomplete last lines are kept until their newline arrives.
+ * @param follow A csv_follow initialised with csv_follow_open().
+ * @param data A char*** pointer passed by address to allocate and store the new rows (possibly none). Free with csv_free() as usual.
+ * @param data_dims A size_t array of size 2 passed by address to store the number of new rows and the column count.
+ */
+void csv_follow_poll(csv_follow* follow, char**** data, size_t (*data_dims)[2]);
+
+/**
+ * @description Block until the followed file may have new rows, has been truncated or rotated, or the timeout expires. Uses inotify where available
+ * and checks the file's size and identity every 100 ms otherwise. Returning true does not guarantee that csv_follow_poll() finds complete rows.
+ * @param follow A csv_follow initialised with csv_follow_open().
+ * @param timeout_ms Maximum time to wait in milliseconds, or a negative value to wait indefinitely.
+ * @return true if the file changed, false on timeout.
+ */
+bool csv_follow_wait(csv_follow* follow, int timeout_ms);
+
+/**
+ * @description Stop following a file and release everything held by follow, including any incomplete last line.
+ * @param follow A csv_follow initialised with csv_follow_open().
+ */
+void csv_follow_close(csv_follow* follow);
+
+#endif //CSVPARSER_FOLLOW_H
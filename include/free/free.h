@@ -3,6 +3,13 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+
+#include "stats/stats.h"
+#include "groupby/groupby.h"
+#include "profile/profile.h"
+#include "dict/dict.h"
+#include "bind/bind.h"
 
 /**
  * @description Free the memory allocated to data after reading a CSV file. This MUST be done if you intend on using the same pointer to read a different file.
@@ -48,4 +55,52 @@ void csv_free_column_int(int** data);
  */
 void csv_free_column_float(float** data);
 
+/**
+ * @description Free the memory allocated to data after reading a CSV file. This MUST be done if you intend on using the same pointer to read a different file.
+ * @param data The address to an int64_t* pointer holding the timestamps loaded by csv_read_column_by_index_as_timestamp() or csv_column_to_timestamp().
+ */
+void csv_free_column_timestamp(int64_t** data);
+
+/**
+ * @description Free the memory allocated to stats by csv_column_stats() or csv_column_stats_by_index().
+ * @param stats The address to a csv_stats* pointer holding the column statistics.
+ */
+void csv_free_stats(csv_stats** stats);
+
+/**
+ * @description Free the memory allocated to groups by csv_group_by() or csv_group_by_index(), including the interned keys.
+ * @param groups The address to a csv_groups holding the grouped data.
+ */
+void csv_free_groups(csv_groups* groups);
+
+/**
+ * @description Free the memory allocated to profiles by csv_profile_columns(), including the column names and quantile sketches.
+ * @param profiles The address to a csv_profile* pointer holding the column profiles.
+ * @param n_columns How many column profiles to free.
+ */
+void csv_free_profiles(csv_profile** profiles, size_t n_columns);
+
+/**
+ * @description Free the memory allocated to a dictionary-encoded column loaded by csv_read_column_by_name_as_dict() or csv_read_column_by_index_as_dict().
+ * @param column The address to a csv_dict_column holding the column.
+ */
+void csv_free_dict_column(csv_dict_column* column);
+
+/**
+ * @description Free the memory allocated to dictionary-encoded columns loaded by csv_select_by_name_as_dict() or csv_select_by_index_as_dict().
+ * @param columns The address to a csv_dict_column* pointer holding the columns.
+ * @param n_columns How many columns to free.
+ */
+void csv_free_dict_columns(csv_dict_column** columns, size_t n_columns);
+
+/**
+ * @description Free the memory allocated to structs by csv_read_structs() or csv_read_structs_from(), including the copies made for string fields.
+ * @param structs The array passed by address; it is set to NULL.
+ * @param n_structs Number of structs in the array.
+ * @param bindings The bindings the structs were read with.
+ * @param n_bindings Number of bindings.
+ * @param struct_size Size of the struct.
+ */
+void csv_free_structs(void** structs, size_t n_structs, const csv_binding* bindings, size_t n_bindings, size_t struct_size);
+
 #endif //CSVPARSER_FREE_H
@@ -0,0 +1,66 @@
+#ifndef CSVPARSER_GROUPBY_H
+#define CSVPARSER_GROUPBY_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct csv_arena;
+
+/**
+ * @description Aggregates supported by csv_group_by(). Each one is applied to a numeric value column;
+ * cells that are empty or do not start with a number are skipped (CSV_AGG_COUNT counts the numeric cells only).
+ */
+typedef enum csv_aggregate
+{
+    CSV_AGG_COUNT,
+    CSV_AGG_SUM,
+    CSV_AGG_MIN,
+    CSV_AGG_MAX,
+    CSV_AGG_MEAN
+} csv_aggregate;
+
+/**
+ * @description Result of csv_group_by(). Groups are stored in the order they were first seen in the file.
+ * keys[g][k] is the value of the k-th key column for group g (empty cells are "(null)"). Every distinct key is allocated once inside an arena owned by the result.
+ * values[g][a] is the a-th aggregate for group g. MIN, MAX and MEAN are NAN for groups without any numeric cells.
+ */
+typedef struct csv_groups
+{
+    char*** keys;
+    double** values;
+    size_t n_groups;
+    size_t n_keys;
+    size_t n_aggregates;
+    struct csv_arena* arena;
+} csv_groups;
+
+/**
+ * @description Group rows by one or more columns (by name) and aggregate numeric columns in a single pass. Memory grows with the number of distinct groups, not the number of rows.
+ * @param filename Filename to read CSV file from. The first line must contain the column names.
+ * @param key_columns An array of character strings specifying the columns to group by.
+ * @param n_keys Total number of key columns (length of key_columns).
+ * @param value_columns An array of character strings specifying the column each aggregate is computed on.
+ * @param aggregates An array of csv_aggregate, one per entry in value_columns.
+ * @param n_aggregates Total number of aggregates (length of value_columns and aggregates).
+ * @param groups A csv_groups passed by address to store the result. Must be freed with csv_free_groups().
+ * @param delim A single-character delimiter.
+ */
+void csv_group_by(const char* filename, char** key_columns, size_t n_keys, char** value_columns, csv_aggregate* aggregates, size_t n_aggregates, csv_groups* groups, char delim);
+
+/**
+ * @description Group rows by one or more columns (by index) and aggregate numeric columns in a single pass. Memory grows with the number of distinct groups, not the number of rows.
+ * @param filename Filename to read CSV file from.
+ * @param key_indices A size_t array of indices specifying the columns to group by.
+ * @param n_keys Total number of key columns (length of key_indices).
+ * @param value_indices A size_t array of indices specifying the column each aggregate is computed on.
+ * @param aggregates An array of csv_aggregate, one per entry in value_indices.
+ * @param n_aggregates Total number of aggregates (length of value_indices and aggregates).
+ * @param groups A csv_groups passed by address to store the result. Must be freed with csv_free_groups().
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the file has headers or not. If true, the first line will be skipped.
+ */
+void csv_group_by_index(const char* filename, size_t* key_indices, size_t n_keys, size_t* value_indices, csv_aggregate* aggregates, size_t n_aggregates, csv_groups* groups, char delim, bool has_headers);
+
+#endif //CSVPARSER_GROUPBY_H
@@ -0,0 +1,55 @@
+#ifndef CSVPARSER_JOIN_H
+#define CSVPARSER_JOIN_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @description Which rows a join writes.
+ * CSV_JOIN_INNER writes one row per matching left/right pair.
+ * CSV_JOIN_LEFT also writes left rows without a match, with empty right columns.
+ * CSV_JOIN_SEMI writes each left row that has at least one match, once and unchanged.
+ */
+typedef enum csv_join_type
+{
+    CSV_JOIN_INNER,
+    CSV_JOIN_LEFT,
+    CSV_JOIN_SEMI
+} csv_join_type;
+
+/**
+ * @description Join two CSV files on key columns (by name) and write the result to a new file without loading either file.
+ * A hash table is built from the smaller file, keeping only what the output needs, and the larger file is streamed through it; rows are written as they are produced.
+ * If the table would not fit in memory_budget both files are split by key hash into temporary partitions which are joined one pair at a time.
+ * Inner and left joins write all left columns followed by the right columns that are not keys; semi joins write the left columns only.
+ * Cells are written exactly as they appear in the inputs. Keys match when their cells are byte-for-byte equal (surrounding quotes are ignored);
+ * rows with an empty or missing key cell never match. Output rows are not in any particular order.
+ * @param left_filename Filename of the left CSV file. The first line must contain the column names.
+ * @param right_filename Filename of the right CSV file. The first line must contain the column names.
+ * @param key_columns An array of character strings naming the key columns, which must have the same names in both files.
+ * @param n_keys Total number of key columns (length of key_columns).
+ * @param type CSV_JOIN_INNER, CSV_JOIN_LEFT or CSV_JOIN_SEMI.
+ * @param output_filename Filename to write the joined CSV file (with a header line) to. It is created or truncated.
+ * @param memory_budget Maximum number of bytes the hash table may use, or 0 for the default (256 MB).
+ * @param delim A single-character delimiter used by both inputs and the output.
+ */
+void csv_join(const char* left_filename, const char* right_filename, char** key_columns, size_t n_keys, csv_join_type type, const char* output_filename, size_t memory_budget, char delim);
+
+/**
+ * @description Join two CSV files on key columns (by index) and write the result to a new file without loading either file. See csv_join() for details.
+ * @param left_filename Filename of the left CSV file.
+ * @param right_filename Filename of the right CSV file.
+ * @param left_key_indices A size_t array of indices specifying the key columns of the left file.
+ * @param right_key_indices A size_t array of indices specifying the key columns of the right file, in the same order as left_key_indices.
+ * @param n_keys Total number of key columns (length of left_key_indices and right_key_indices).
+ * @param type CSV_JOIN_INNER, CSV_JOIN_LEFT or CSV_JOIN_SEMI.
+ * @param output_filename Filename to write the joined CSV file to. It is created or truncated.
+ * @param memory_budget Maximum number of bytes the hash table may use, or 0 for the default (256 MB).
+ * @param delim A single-character delimiter used by both inputs and the output.
+ * @param has_headers A boolean indicating if the files have headers or not. If true, the header lines are joined into the output's header line.
+ */
+void csv_join_by_index(const char* left_filename, const char* right_filename, size_t* left_key_indices, size_t* right_key_indices, size_t n_keys, csv_join_type type, const char* output_filename, size_t memory_budget, char delim, bool has_headers);
+
+#endif //CSVPARSER_JOIN_H
@@ -0,0 +1,32 @@
+#ifndef CSVPARSER_KEYINDEX_H
+#define CSVPARSER_KEYINDEX_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @description Build a key index for a CSV file: a sidecar next to it (filename + ".keyidx") holding an open-addressing hash table that maps each value of
+ * a key column to the byte offsets of the rows holding it. csv_lookup() uses it to find rows by key without reading the file.
+ * A file has one key index at a time; building one for another column replaces it. The index is ignored once the file's size or modification time changes,
+ * so rebuild it after writing to the file.
+ * @param filename Filename to read CSV file from. The first line must contain the column names.
+ * @param key_column Name of the column to index. Keys are cells as csv_read() returns them, quotes included; empty cells are indexed as "".
+ * @param delim A single-character delimiter.
+ */
+void csv_build_key_index(const char* filename, const char* key_column, char delim);
+
+/**
+ * @description Read the rows whose key column holds exactly key. With a current key index for that column (see csv_build_key_index())
+ * each match costs one probe of the index and one read and parse of its row; otherwise the whole file is scanned.
+ * @param filename Filename to read CSV file from. The first line must contain the column names.
+ * @param key_column Name of the key column.
+ * @param key Key value to look up.
+ * @param data A char*** pointer passed by address to allocate and store the matching rows in file order.
+ * @param data_dims A size_t array of size 2 passed by address to store the number of matching rows and the column count.
+ * @param delim A single-character delimiter.
+ */
+void csv_lookup(const char* filename, const char* key_column, const char* key, char**** data, size_t (*data_dims)[2], char delim);
+
+#endif //CSVPARSER_KEYINDEX_H
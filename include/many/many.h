@@ -0,0 +1,126 @@
+#ifndef CSVPARSER_MANY_H
+#define CSVPARSER_MANY_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @description Read several CSV files (e.g. shards of one dataset) concurrently and concatenate their rows into one char*** in the order of filenames. Files whose column count (or headers) differ from the first file's are rejected.
+ * @param filenames An array of filenames to read. Rows are returned in the order of this array.
+ * @param n_files Total number of files (length of filenames).
+ * @param data A char*** passed by address that holds the cells of all files concatenated. It's structured as data[x][y] where x represents the row, y represents the column and the contents is a string (char*).
+ * @param data_dims A size_t[2] array passed by address with two indices: 0th index stores the total row count and 1st index stores the column count.
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the files have headers or not. If true, the first line of each file will be skipped and the headers of every file must match the first file's.
+ * @param n_threads Maximum number of files parsed at the same time. 0 uses one thread per online CPU.
+ */
+void csv_read_many(char** filenames, size_t n_files, char**** data, size_t (*data_dims)[2], char delim, bool has_headers, size_t n_threads);
+
+/**
+ * @description Read several CSV files concurrently, cast them to int and concatenate their rows in the order of filenames.
+ * @param filenames An array of filenames to read. Rows are returned in the order of this array.
+ * @param n_files Total number of files (length of filenames).
+ * @param data An int** passed by address that holds the cells of all files concatenated.
+ * @param data_dims A size_t[2] array passed by address with two indices: 0th index stores the total row count and 1st index stores the column count.
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the files have headers or not. If true, the first line of each file will be skipped and the headers of every file must match the first file's.
+ * @param n_threads Maximum number of files parsed at the same time. 0 uses one thread per online CPU.
+ */
+void csv_read_many_int(char** filenames, size_t n_files, int*** data, size_t (*data_dims)[2], char delim, bool has_headers, size_t n_threads);
+
+/**
+ * @description Read several CSV files concurrently, cast them to float and concatenate their rows in the order of filenames.
+ * @param filenames An array of filenames to read. Rows are returned in the order of this array.
+ * @param n_files Total number of files (length of filenames).
+ * @param data A float** passed by address that holds the cells of all files concatenated.
+ * @param data_dims A size_t[2] array passed by address with two indices: 0th index stores the total row count and 1st index stores the column count.
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the files have headers or not. If true, the first line of each file will be skipped and the headers of every file must match the first file's.
+ * @param n_threads Maximum number of files parsed at the same time. 0 uses one thread per online CPU.
+ */
+void csv_read_many_float(char** filenames, size_t n_files, float*** data, size_t (*data_dims)[2], char delim, bool has_headers, size_t n_threads);
+
+/**
+ * @description Select columns (by index) from several CSV files concurrently, concatenating the rows in the order of filenames.
+ * @param filenames An array of filenames to read. Rows are returned in the order of this array.
+ * @param n_files Total number of files (length of filenames).
+ * @param column_indices A size_t array of indices specifying which columns to select from every file.
+ * @param n_columns Total number of columns being selected (length of column_indices).
+ * @param data A char*** passed by address that holds the cells of all files concatenated.
+ * @param data_dims A size_t[2] array passed by address with two indices: 0th index stores the total row count and 1st index stores the column count.
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the files have headers or not. If true, the first line of each file will be skipped and the headers of every file must match the first file's.
+ * @param n_threads Maximum number of files parsed at the same time. 0 uses one thread per online CPU.
+ */
+void csv_select_many_by_index(char** filenames, size_t n_files, size_t* column_indices, size_t n_columns, char**** data, size_t (*data_dims)[2], char delim, bool has_headers, size_t n_threads);
+
+/**
+ * @description Select columns (by index) from several CSV files concurrently and cast data to float, concatenating the rows in the order of filenames.
+ * @param filenames An array of filenames to read. Rows are returned in the order of this array.
+ * @param n_files Total number of files (length of filenames).
+ * @param column_indices A size_t array of indices specifying which columns to select from every file.
+ * @param n_columns Total number of columns being selected (length of column_indices).
+ * @param data A float** passed by address that holds the cells of all files concatenated.
+ * @param data_dims A size_t[2] array passed by address with two indices: 0th index stores the total row count and 1st index stores the column count.
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the files have headers or not. If true, the first line of each file will be skipped and the headers of every file must match the first file's.
+ * @param n_threads Maximum number of files parsed at the same time. 0 uses one thread per online CPU.
+ */
+void csv_select_many_by_index_as_float(char** filenames, size_t n_files, size_t* column_indices, size_t n_columns, float*** data, size_t (*data_dims)[2], char delim, bool has_headers, size_t n_threads);
+
+/**
+ * @description Select columns (by index) from several CSV files concurrently and cast data to int, concatenating the rows in the order of filenames.
+ * @param filenames An array of filenames to read. Rows are returned in the order of this array.
+ * @param n_files Total number of files (length of filenames).
+ * @param column_indices A size_t array of indices specifying which columns to select from every file.
+ * @param n_columns Total number of columns being selected (length of column_indices).
+ * @param data An int** passed by address that holds the cells of all files concatenated.
+ * @param data_dims A size_t[2] array passed by address with two indices: 0th index stores the total row count and 1st index stores the column count.
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the files have headers or not. If true, the first line of each file will be skipped and the headers of every file must match the first file's.
+ * @param n_threads Maximum number of files parsed at the same time. 0 uses one thread per online CPU.
+ */
+void csv_select_many_by_index_as_int(char** filenames, size_t n_files, size_t* column_indices, size_t n_columns, int*** data, size_t (*data_dims)[2], char delim, bool has_headers, size_t n_threads);
+
+/**
+ * @description Select columns (by name) from several CSV files concurrently, concatenating the rows in the order of filenames. Every file must have the same headers.
+ * @param filenames An array of filenames to read. Rows are returned in the order of this array.
+ * @param n_files Total number of files (length of filenames).
+ * @param column_names An array of character strings specifying which columns to select from every file.
+ * @param n_columns Total number of columns being selected (length of column_names).
+ * @param data A char*** passed by address that holds the cells of all files concatenated.
+ * @param data_dims A size_t[2] array passed by address with two indices: 0th index stores the total row count and 1st index stores the column count.
+ * @param delim A single-character delimiter.
+ * @param n_threads Maximum number of files parsed at the same time. 0 uses one thread per online CPU.
+ */
+void csv_select_many_by_name(char** filenames, size_t n_files, char** column_names, size_t n_columns, char**** data, size_t (*data_dims)[2], char delim, size_t n_threads);
+
+/**
+ * @description Select columns (by name) from several CSV files concurrently and cast data to float, concatenating the rows in the order of filenames. Every file must have the same headers.
+ * @param filenames An array of filenames to read. Rows are returned in the order of this array.
+ * @param n_files Total number of files (length of filenames).
+ * @param column_names An array of character strings specifying which columns to select from every file.
+ * @param n_columns Total number of columns being selected (length of column_names).
+ * @param data A float** passed by address that holds the cells of all files concatenated.
+ * @param data_dims A size_t[2] array passed by address with two indices: 0th index stores the total row count and 1st index stores the column count.
+ * @param delim A single-character delimiter.
+ * @param n_threads Maximum number of files parsed at the same time. 0 uses one thread per online CPU.
+ */
+void csv_select_many_by_name_as_float(char** filenames, size_t n_files, char** column_names, size_t n_columns, float*** data, size_t (*data_dims)[2], char delim, size_t n_threads);
+
+/**
+ * @description Select columns (by name) from several CSV files concurrently and cast data to int, concatenating the rows in the order of filenames. Every file must have the same headers.
+ * @param filenames An array of filenames to read. Rows are returned in the order of this array.
+ * @param n_files Total number of files (length of filenames).
+ * @param column_names An array of character strings specifying which columns to select from every file.
+ * @param n_columns Total number of columns being selected (length of column_names).
+ * @param data An int** passed by address that holds the cells of all files concatenated.
+ * @param data_dims A size_t[2] array passed by address with two indices: 0th index stores the total row count and 1st index stores the column count.
+ * @param delim A single-character delimiter.
+ * @param n_threads Maximum number of files parsed at the same time. 0 uses one thread per online CPU.
+ */
+void csv_select_many_by_name_as_int(char** filenames, size_t n_files, char** column_names, size_t n_columns, int*** data, size_t (*data_dims)[2], char delim, size_t n_threads);
+
+#endif //CSVPARSER_MANY_H
@@ -0,0 +1,29 @@
+#ifndef CSVPARSER_PARTITION_H
+#define CSVPARSER_PARTITION_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+/**
+ * @description Split a CSV file into one file per key value, or per hash bucket of the key, in a single streaming pass. Each row's original bytes are copied as they are
+ * (quoted fields may span lines), so nothing is parsed beyond finding the key cell, and the header line is repeated at the top of every output file.
+ * Rows are gathered in a buffer per partition and written when it fills (or when all buffers together pass a memory budget), and at most max_open_files outputs
+ * are kept open: the least recently written one is closed when another is needed and reopened for appending later.
+ * Values are compared without their surrounding quotes (and with "" read as "), so "a" and a are the same key.
+ * With n_buckets == 0 every distinct value gets its own file, named after the value: characters other than letters, digits, '.', '_' and '-' become '_', and a hash
+ * of the value is appended whenever that changed the name, so different values never share a file. An empty cell is named as the value (null).
+ * With n_buckets > 0 a row goes to part-NNNNN.csv where NNNNN is the hash of its key modulo n_buckets, so one value always lands in one bucket.
+ * Existing files of the same names are overwritten. No files are written if the file has no such column.
+ * @param filename Filename of the CSV file to split. It must have headers.
+ * @param key_column Name of the column that decides each row's partition.
+ * @param output_dir Directory to write the partitions to. It is created if it does not exist.
+ * @param n_buckets Number of hash buckets, or 0 to partition by value.
+ * @param max_open_files Maximum number of output files open at once (0 = 64).
+ * @param partition_files A char** passed by address to allocate and store the path of every file written, in the order the partitions were first seen. Free with csv_free_column().
+ * @param n_partitions A size_t passed by address to store the number of files written.
+ * @param delim A single-character delimiter.
+ */
+void csv_partition(const char* filename, const char* key_column, const char* output_dir, size_t n_buckets, size_t max_open_files, char*** partition_files, size_t* n_partitions, char delim);
+
+#endif //CSVPARSER_PARTITION_H
@@ -0,0 +1,50 @@
+#ifndef CSVPARSER_PROFILE_H
+#define CSVPARSER_PROFILE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct csv_quantile_sketch;
+
+/**
+ * @description Approximate profile of one column built in a single pass with bounded memory (independent of the row count).
+ * distinct is a HyperLogLog estimate (about 1.6% standard error) of the distinct non-empty values.
+ * min and max are exact; p50, p90 and p99 come from a KLL quantile sketch over the numeric cells and are NAN when there are none.
+ * Use csv_profile_quantile() for any other quantile.
+ */
+typedef struct csv_profile
+{
+    char* name;
+    size_t count;
+    size_t null_count;
+    double distinct;
+    size_t numeric_count;
+    double min;
+    double max;
+    double p50;
+    double p90;
+    double p99;
+    struct csv_quantile_sketch* sketch;
+} csv_profile;
+
+/**
+ * @description Profile every column of a CSV file in a single pass: cell and null counts, approximate distinct count and approximate quantiles.
+ * @param filename Filename to read CSV file from.
+ * @param profiles A csv_profile* passed by address to allocate and store one csv_profile per column. Must be freed with csv_free_profiles().
+ * @param n_columns A size_t variable passed by address to store the number of columns (counted from the first line).
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the file has headers or not. If true, the first line is used for the column names (name is NULL otherwise).
+ */
+void csv_profile_columns(const char* filename, csv_profile** profiles, size_t* n_columns, char delim, bool has_headers);
+
+/**
+ * @description Approximate quantile of the numeric cells of a profiled column.
+ * @param profile A csv_profile filled by csv_profile_columns().
+ * @param q The quantile to compute, between 0 and 1 (e.g. 0.99 for p99).
+ * @return The approximate quantile, or NAN if the column has no numeric cells.
+ */
+double csv_profile_quantile(const csv_profile* profile, double q);
+
+#endif //CSVPARSER_PROFILE_H
@@ -4,6 +4,9 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <stdint.h>
+
+#include "source/source.h"
 
 /**
  * @description Read a CSV file and store cells into a char*** pointer.
@@ -15,6 +18,28 @@
  */
 void csv_read(const char* filename, char**** data, size_t (*data_dims)[2], char delim, bool has_headers);
 
+/**
+ * @description Read only the first n_rows data rows of a CSV file and store cells into a char*** pointer. Reading stops as soon as n_rows rows have been parsed.
+ * @param filename Filename to read CSV file from.
+ * @param n_rows Maximum number of data rows to read (the header is not counted).
+ * @param data A char*** passed by address that holds the CSV cells. It's structured as data[x][y] where x represents the row, y represents the column and the contents is a string (char*).
+ * @param data_dims A size_t[2] array passed by address with two indices: 0th index stores the row count and 1st index stores the column count.
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the file has headers or not. If true, the first line will be skipped and not stored into data.
+ */
+void csv_read_head(const char* filename, size_t n_rows, char**** data, size_t (*data_dims)[2], char delim, bool has_headers);
+
+/**
+ * @description Read only the last n_rows data rows of a CSV file and store cells into a char*** pointer. The file is memory mapped and scanned backwards from the end, so only the tail of the file is read.
+ * @param filename Filename to read CSV file from.
+ * @param n_rows Maximum number of data rows to read from the end of the file (the header is never returned as a row).
+ * @param data A char*** passed by address that holds the CSV cells in file order. It's structured as data[x][y] where x represents the row, y represents the column and the contents is a string (char*).
+ * @param data_dims A size_t[2] array passed by address with two indices: 0th index stores the row count and 1st index stores the column count.
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the file has headers or not. If true, the first line will be skipped and not stored into data.
+ */
+void csv_read_tail(const char* filename, size_t n_rows, char**** data, size_t (*data_dims)[2], char delim, bool has_headers);
+
 /**
  * @description Read a CSV file and cast data to int.
  * @param filename Filename to read CSV file from.
@@ -69,6 +94,17 @@ void csv_read_column_by_index_as_float(const char* filename, size_t column_index
  */
 void csv_read_column_by_index_as_int(const char* filename, size_t column_index, int** data, size_t* data_rows, char delim, bool has_headers);
 
+/**
+ * @description Read a single column (by index) from CSV file and parse its ISO-8601 dates or timestamps into microseconds since the epoch (see csv_column_to_timestamp()).
+ * @param filename Filename to read CSV file from.
+ * @param column_index Index of the column to read.
+ * @param data An int64_t* passed by address that holds the timestamps from the specified column. Cells that are not timestamps are CSV_TIMESTAMP_INVALID.
+ * @param data_rows A size_t variable passed by address to store the number of rows after parsing CSV file.
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the file has headers or not. If true, the first line will be skipped and not stored into data.
+ */
+void csv_read_column_by_index_as_timestamp(const char* filename, size_t column_index, int64_t** data, size_t* data_rows, char delim, bool has_headers);
+
 /**
  * @description Read a single column (by name) from CSV file and store cells into a char** pointer.
  * @param filename Filename to read CSV file from.
@@ -99,4 +135,140 @@ void csv_read_column_by_name_as_float(const char* filename, const char* column_n
  */
 void csv_read_column_by_name_as_int(const char* filename, const char* column_name, int** data, size_t* data_rows, char delim);
 
+/**
+ * @description Read a single column (by name) from CSV file and parse its ISO-8601 dates or timestamps into microseconds since the epoch (see csv_column_to_timestamp()).
+ * @param filename Filename to read CSV file from.
+ * @param column_name Name of the column to read.
+ * @param data An int64_t* passed by address that holds the timestamps from the specified column. Cells that are not timestamps are CSV_TIMESTAMP_INVALID.
+ * @param data_rows A size_t variable passed by address to store the number of rows after parsing CSV file.
+ * @param delim A single-character delimiter.
+ */
+void csv_read_column_by_name_as_timestamp(const char* filename, const char* column_name, int64_t** data, size_t* data_rows, char delim);
+
+/**
+ * @description Read CSV data from a csv_source and store cells into a char*** pointer.
+ * @param source A csv_source created with csv_source_from_buffer(), csv_source_from_stream() or csv_source_from_fd(). It is read once, from its current position.
+ * @param data A char*** passed by address that holds the CSV cells. It's structured as data[x][y] where x represents the row, y represents the column and the contents is a string (char*).
+ * @param data_dims A size_t[2] array passed by address with two indices: 0th index stores the row count and 1st index stores the column count.
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the file has headers or not. If true, the first line will be skipped and not stored into data.
+ */
+void csv_read_from(csv_source* source, char**** data, size_t (*data_dims)[2], char delim, bool has_headers);
+
+/**
+ * @description Read only the first n_rows data rows of a csv_source and store cells into a char*** pointer. Reading stops as soon as n_rows rows have been parsed, although a stream or file descriptor may have been read ahead.
+ * @param source A csv_source created with csv_source_from_buffer(), csv_source_from_stream() or csv_source_from_fd(). It is read once, from its current position.
+ * @param n_rows Maximum number of data rows to read (the header is not counted).
+ * @param data A char*** passed by address that holds the CSV cells. It's structured as data[x][y] where x represents the row, y represents the column and the contents is a string (char*).
+ * @param data_dims A size_t[2] array passed by address with two indices: 0th index stores the row count and 1st index stores the column count.
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the file has headers or not. If true, the first line will be skipped and not stored into data.
+ */
+void csv_read_head_from(csv_source* source, size_t n_rows, char**** data, size_t (*data_dims)[2], char delim, bool has_headers);
+
+/**
+ * @description Read CSV data from a csv_source and cast data to int.
+ * @param source A csv_source created with csv_source_from_buffer(), csv_source_from_stream() or csv_source_from_fd(). It is read once, from its current position.
+ * @param data An int** passed by address that holds the CSV cells. It's structured as data[x][y] where x represents the row, y represents the column
+ * @param data_dims A size_t[2] array passed by address with two indices: 0th index stores the row count and 1st index stores the column count.
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the file has headers or not. If true, the first line will be skipped and not stored into data.
+ */
+void csv_read_int_from(csv_source* source, int*** data, size_t (*data_dims)[2], char delim, bool has_headers);
+
+/**
+ * @description Read CSV data from a csv_source and cast data to float.
+ * @param source A csv_source created with csv_source_from_buffer(), csv_source_from_stream() or csv_source_from_fd(). It is read once, from its current position.
+ * @param data A float** passed by address that holds the CSV cells. It's structured as data[x][y] where x represents the row, y represents the column
+ * @param data_dims A size_t[2] array passed by address with two indices: 0th index stores the row count and 1st index stores the column count.
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the file has headers or not. If true, the first line will be skipped and not stored into data.
+ */
+void csv_read_float_from(csv_source* source, float*** data, size_t (*data_dims)[2], char delim, bool has_headers);
+
+/**
+ * @description Read a single column (by index) from a csv_source in a single pass and store cells into a char** pointer.
+ * @param source A csv_source created with csv_source_from_buffer(), csv_source_from_stream() or csv_source_from_fd(). It is read once, from its current position.
+ * @param column_index Index of the column to read.
+ * @param data A char** passed by address that holds the CSV cells from the specified column
+ * @param data_rows A size_t variable passed by address to store the number of rows after parsing the CSV data.
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the file has headers or not. If true, the first line will be skipped and not stored into data.
+ *
+ */
+void csv_read_column_by_index_from(csv_source* source, size_t column_index, char*** data, size_t* data_rows, char delim, bool has_headers);
+
+/**
+ * @description Read a single column (by index) from a csv_source in a single pass and cast data to float.
+ * @param source A csv_source created with csv_source_from_buffer(), csv_source_from_stream() or csv_source_from_fd(). It is read once, from its current position.
+ * @param column_index Index of the column to read.
+ * @param data A float* passed by address that holds the CSV cells from the specified column
+ * @param data_rows A size_t variable passed by address to store the number of rows after parsing the CSV data.
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the file has headers or not. If true, the first line will be skipped and not stored into data.
+ */
+void csv_read_column_by_index_as_float_from(csv_source* source, size_t column_index, float** data, size_t* data_rows, char delim, bool has_headers);
+
+/**
+ * @description Read a single column (by index) from a csv_source in a single pass and cast data to int.
+ * @param source A csv_source created with csv_source_from_buffer(), csv_source_from_stream() or csv_source_from_fd(). It is read once, from its current position.
+ * @param column_index Index of the column to read.
+ * @param data An int* passed by address that holds the CSV cells from the specified column
+ * @param data_rows A size_t variable passed by address to store the number of rows after parsing the CSV data.
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the file has headers or not. If true, the first line will be skipped and not stored into data.
+ */
+void csv_read_column_by_index_as_int_from(csv_source* source, size_t column_index, int** data, size_t* data_rows, char delim, bool has_headers);
+
+/**
+ * @description Read a single column (by index) from a csv_source in a single pass and parse its ISO-8601 dates or timestamps into microseconds since the epoch.
+ * @param source A csv_source created with csv_source_from_buffer(), csv_source_from_stream() or csv_source_from_fd(). It is read once, from its current position.
+ * @param column_index Index of the column to read.
+ * @param data An int64_t* passed by address that holds the timestamps from the specified column. Cells that are not timestamps are CSV_TIMESTAMP_INVALID.
+ * @param data_rows A size_t variable passed by address to store the number of rows after parsing the CSV data.
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the file has headers or not. If true, the first line will be skipped and not stored into data.
+ */
+void csv_read_column_by_index_as_timestamp_from(csv_source* source, size_t column_index, int64_t** data, size_t* data_rows, char delim, bool has_headers);
+
+/**
+ * @description Read a single column (by name) from a csv_source in a single pass and store cells into a char** pointer.
+ * @param source A csv_source created with csv_source_from_buffer(), csv_source_from_stream() or csv_source_from_fd(). It is read once, from its current position.
+ * @param column_name Name of the column to read.
+ * @param data A char** passed by address that holds the CSV cells from the specified column.
+ * @param data_rows A size_t variable passed by address to store the number of rows after parsing the CSV data.
+ * @param delim A single-character delimiter.
+ */
+void csv_read_column_by_name_from(csv_source* source, const char* column_name, char*** data, size_t* data_rows, char delim);
+
+/**
+ * @description Read a single column (by name) from a csv_source in a single pass and cast data to float.
+ * @param source A csv_source created with csv_source_from_buffer(), csv_source_from_stream() or csv_source_from_fd(). It is read once, from its current position.
+ * @param column_name Name of the column to read.
+ * @param data A float* passed by address that holds the CSV cells from the specified column.
+ * @param data_rows A size_t variable passed by address to store the number of rows after parsing the CSV data.
+ * @param delim A single-character delimiter.
+ */
+void csv_read_column_by_name_as_float_from(csv_source* source, const char* column_name, float** data, size_t* data_rows, char delim);
+
+/**
+ * @description Read a single column (by name) from a csv_source in a single pass and cast data to int.
+ * @param source A csv_source created with csv_source_from_buffer(), csv_source_from_stream() or csv_source_from_fd(). It is read once, from its current position.
+ * @param column_name Name of the column to read.
+ * @param data An int* passed by address that holds the CSV cells from the specified column.
+ * @param data_rows A size_t variable passed by address to store the number of rows after parsing the CSV data.
+ * @param delim A single-character delimiter.
+ */
+void csv_read_column_by_name_as_int_from(csv_source* source, const char* column_name, int** data, size_t* data_rows, char delim);
+
+/**
+ * @description Read a single column (by name) from a csv_source in a single pass and parse its ISO-8601 dates or timestamps into microseconds since the epoch.
+ * @param source A csv_source created with csv_source_from_buffer(), csv_source_from_stream() or csv_source_from_fd(). It is read once, from its current position.
+ * @param column_name Name of the column to read.
+ * @param data An int64_t* passed by address that holds the timestamps from the specified column. Cells that are not timestamps are CSV_TIMESTAMP_INVALID.
+ * @param data_rows A size_t variable passed by address to store the number of rows after parsing the CSV data.
+ * @param delim A single-character delimiter.
+ */
+void csv_read_column_by_name_as_timestamp_from(csv_source* source, const char* column_name, int64_t** data, size_t* data_rows, char delim);
+
 #endif //CSVPARSER_READ_H
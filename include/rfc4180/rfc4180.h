@@ -0,0 +1,32 @@
+#ifndef CSVPARSER_RFC4180_H
+#define CSVPARSER_RFC4180_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "source/source.h"
+
+/**
+ * @description Same as csv_read() but with full RFC 4180 quoting: a quoted field may span lines, its surrounding quotes are removed and "" inside it becomes ".
+ * The file is scanned record by record rather than line by line, and only fields that contain quotes are unescaped, so files without quotes are read as fast as with csv_read().
+ * A record may end in \n or \r\n. Empty fields, quoted or not, are stored as "(null)". An unterminated quote runs to the end of the file.
+ * @param filename Filename to read CSV file from.
+ * @param data A char*** pointer passed by address to allocate and store the CSV data. It's structured as data[x][y] where x represents the record, y represents the column.
+ * @param data_dims A size_t array of size 2 passed by address: 0th index stores the record count and 1st index stores the first record's column count.
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the file has headers or not. If true, the first record will be skipped and not stored into data.
+ */
+void csv_read_rfc4180(const char* filename, char**** data, size_t (*data_dims)[2], char delim, bool has_headers);
+
+/**
+ * @description Same as csv_read_rfc4180() for CSV text in a csv_source.
+ * @param source A csv_source created with csv_source_from_buffer(), csv_source_from_stream() or csv_source_from_fd(). It is read once, from its current position.
+ * @param data A char*** pointer passed by address to allocate and store the CSV data.
+ * @param data_dims A size_t array of size 2 passed by address to store the dimensions of data.
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the input has headers or not. If true, the first record will be skipped.
+ */
+void csv_read_rfc4180_from(csv_source* source, char**** data, size_t (*data_dims)[2], char delim, bool has_headers);
+
+#endif //CSVPARSER_RFC4180_H
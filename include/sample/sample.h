@@ -0,0 +1,37 @@
+#ifndef CSVPARSER_SAMPLE_H
+#define CSVPARSER_SAMPLE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+/**
+ * @description Read a uniform random sample of k data rows from a CSV file in one pass, without loading the file. During the scan only the byte offset and length
+ * of the rows currently in the reservoir are kept (reservoir sampling, Algorithm L, which draws random numbers only for the rows it keeps), so memory
+ * depends on k and not on the file size. Once the scan is done the k chosen rows are read back and parsed. Fewer than k rows in the file means all of them are returned.
+ * @param filename Filename to read CSV file from.
+ * @param k Number of rows to sample.
+ * @param seed Seed of the random number generator; the same seed and file give the same sample.
+ * @param data A char*** passed by address that holds the sampled rows in file order. It's structured as data[x][y] where x represents the row, y represents the column and the contents is a string (char*).
+ * @param data_dims A size_t[2] array passed by address with two indices: 0th index stores the sampled row count and 1st index stores the first line's column count.
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the file has headers or not. If true, the first line is never sampled.
+ */
+void csv_sample(const char* filename, size_t k, uint64_t seed, char**** data, size_t (*data_dims)[2], char delim, bool has_headers);
+
+/**
+ * @description Read a stratified random sample from a CSV file in one pass: up to k rows for every distinct value of a column, each chosen uniformly among the rows
+ * with that value. Each value gets its own reservoir of offsets, like csv_sample(); values are compared as the raw cell text (quotes kept, an empty cell is one value).
+ * No rows are returned if the file has no such column.
+ * @param filename Filename to read CSV file from. It must have headers.
+ * @param column_name Name of the column whose values define the strata.
+ * @param k Number of rows to sample per distinct value.
+ * @param seed Seed of the random number generator; the same seed and file give the same sample.
+ * @param data A char*** passed by address that holds the sampled rows of every stratum together, in file order.
+ * @param data_dims A size_t[2] array passed by address with two indices: 0th index stores the sampled row count and 1st index stores the header's column count.
+ * @param delim A single-character delimiter.
+ */
+void csv_sample_stratified(const char* filename, const char* column_name, size_t k, uint64_t seed, char**** data, size_t (*data_dims)[2], char delim);
+
+#endif //CSVPARSER_SAMPLE_H
@@ -0,0 +1,47 @@
+#ifndef CSVPARSER_SORT_H
+#define CSVPARSER_SORT_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @description Sort direction of one key column.
+ */
+typedef enum csv_sort_order
+{
+    CSV_SORT_ASCENDING,
+    CSV_SORT_DESCENDING
+} csv_sort_order;
+
+/**
+ * @description Sort a CSV file by key columns (by name) into a new file, for files of any size.
+ * Rows are sorted in memory_budget sized runs which are spilled to temporary files and merged, so memory use stays within the budget.
+ * Rows are written exactly as they appear in the input (quotes and all); only a missing newline after the last row is added.
+ * Within a key column empty cells sort first, then numeric cells in numeric order, then all other cells in byte order
+ * (surrounding quotes are ignored when comparing). CSV_SORT_DESCENDING reverses this order. Rows with equal keys keep their input order.
+ * @param input_filename Filename to read CSV file from. The first line must contain the column names; it is written first to the output.
+ * @param output_filename Filename to write the sorted CSV file to. It is created or truncated.
+ * @param key_columns An array of character strings specifying the key columns, most significant first.
+ * @param orders The sort direction of each key column (same length as key_columns).
+ * @param n_keys Total number of key columns (length of key_columns).
+ * @param memory_budget Maximum number of bytes to hold in memory at once, or 0 for the default (256 MB).
+ * @param delim A single-character delimiter.
+ */
+void csv_sort(const char* input_filename, const char* output_filename, char** key_columns, csv_sort_order* orders, size_t n_keys, size_t memory_budget, char delim);
+
+/**
+ * @description Sort a CSV file by key columns (by index) into a new file, for files of any size. See csv_sort() for the ordering rules.
+ * @param input_filename Filename to read CSV file from.
+ * @param output_filename Filename to write the sorted CSV file to. It is created or truncated.
+ * @param key_indices A size_t array of indices specifying the key columns, most significant first.
+ * @param orders The sort direction of each key column (same length as key_indices).
+ * @param n_keys Total number of key columns (length of key_indices).
+ * @param memory_budget Maximum number of bytes to hold in memory at once, or 0 for the default (256 MB).
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the file has headers or not. If true, the first line is written first to the output and not sorted.
+ */
+void csv_sort_by_index(const char* input_filename, const char* output_filename, size_t* key_indices, csv_sort_order* orders, size_t n_keys, size_t memory_budget, char delim, bool has_headers);
+
+#endif //CSVPARSER_SORT_H
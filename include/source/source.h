@@ -0,0 +1,55 @@
+#ifndef CSVPARSER_SOURCE_H
+#define CSVPARSER_SOURCE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+/**
+ * @description Where the *_from() functions read CSV text from instead of a filename: a memory buffer, a FILE* stream or a file descriptor.
+ * Create one with csv_source_from_buffer(), csv_source_from_stream() or csv_source_from_fd(). The source never takes ownership of what it wraps.
+ * A compressed file descriptor (see compress/compress.h) is decompressed on a thread of its own and must be closed with csv_source_close().
+ * Streams and file descriptors are read forwards exactly once, so pipes and stdin work; every *_from() function makes a single pass over its input.
+ */
+typedef enum csv_source_kind
+{
+    CSV_SOURCE_BUFFER,
+    CSV_SOURCE_STREAM,
+    CSV_SOURCE_FD,
+    CSV_SOURCE_COMPRESSED
+} csv_source_kind;
+
+struct csv_decompressor;
+typedef struct csv_source
+{
+    csv_source_kind kind;
+    const char* buffer;
+    size_t buffer_size;
+    FILE* file;
+    int fd;
+    struct csv_decompressor* decompressor;
+} csv_source;
+
+/**
+ * @description Read CSV text from memory. Lines are parsed in place; the buffer is never copied or modified and does not need to be \0 terminated.
+ * @param buffer Pointer to the CSV text. Must stay valid while the source is used.
+ * @param size Number of bytes in buffer.
+ * @return A csv_source for the buffer.
+ */
+csv_source csv_source_from_buffer(const char* buffer, size_t size);
+
+/**
+ * @description Read CSV text from an open FILE* stream (e.g. stdin or popen()), starting at its current position. The stream is not closed.
+ * @param file The stream to read from.
+ * @return A csv_source for the stream.
+ */
+csv_source csv_source_from_stream(FILE* file);
+
+/**
+ * @description Read CSV text from an open file descriptor (e.g. a pipe or socket), starting at its current position. The descriptor is not closed.
+ * @param fd The file descriptor to read from.
+ * @return A csv_source for the file descriptor.
+ */
+csv_source csv_source_from_fd(int fd);
+
+#endif //CSVPARSER_SOURCE_H
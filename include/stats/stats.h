@@ -0,0 +1,46 @@
+#ifndef CSVPARSER_STATS_H
+#define CSVPARSER_STATS_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @description Summary statistics of a single numeric column computed while streaming the file.
+ * Cells that are empty, missing or do not start with a number are counted in null_count and otherwise ignored.
+ * min, max, mean and variance are NAN when the column has no numeric cells. variance is the sample variance (n - 1).
+ */
+typedef struct csv_stats
+{
+    size_t count;
+    size_t null_count;
+    double sum;
+    double min;
+    double max;
+    double mean;
+    double variance;
+} csv_stats;
+
+/**
+ * @description Compute summary statistics for columns (by name) in a single pass over the file without storing any cells.
+ * @param filename Filename to read CSV file from. The first line must contain the column names.
+ * @param column_names An array of character strings specifying which columns to summarise.
+ * @param n_columns Total number of columns being summarised (length of column_names).
+ * @param stats A csv_stats* passed by address to allocate and store one csv_stats per requested column, in the same order as column_names.
+ * @param delim A single-character delimiter.
+ */
+void csv_column_stats(const char* filename, char** column_names, size_t n_columns, csv_stats** stats, char delim);
+
+/**
+ * @description Compute summary statistics for columns (by index) in a single pass over the file without storing any cells.
+ * @param filename Filename to read CSV file from.
+ * @param column_indices A size_t array of indices specifying which columns to summarise.
+ * @param n_columns Total number of columns being summarised (length of column_indices).
+ * @param stats A csv_stats* passed by address to allocate and store one csv_stats per requested column, in the same order as column_indices.
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the file has headers or not. If true, the first line will be skipped.
+ */
+void csv_column_stats_by_index(const char* filename, size_t* column_indices, size_t n_columns, csv_stats** stats, char delim, bool has_headers);
+
+#endif //CSVPARSER_STATS_H
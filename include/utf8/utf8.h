@@ -0,0 +1,54 @@
+#ifndef CSVPARSER_UTF8_H
+#define CSVPARSER_UTF8_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "source/source.h"
+
+// where the first invalid UTF-8 sequence of an input is; found is false when the whole input is valid
+// line is 1-based and counts the header; column is 0-based; offset is the byte offset in the input
+typedef struct csv_utf8_error
+{
+    bool found;
+    size_t line;
+    size_t column;
+    size_t offset;
+} csv_utf8_error;
+
+/**
+ * @description Same as csv_read() but checks that the file is valid UTF-8 while it is read, so no separate pass over the file is needed.
+ * Lines are checked as the reader hands them to the tokenizer: pure ASCII 8 bytes at a time and anything else with a vectorized (SSSE3, lookup table based)
+ * validator when the CPU supports it. Reading stops at the first invalid line: data holds the rows before it and error says where it is.
+ * A leading UTF-8 byte order mark is skipped, as every reader in this library does.
+ * @param filename Filename to read CSV file from.
+ * @param data A char*** pointer passed by address to allocate and store the CSV data. Only the rows before the first invalid line are stored.
+ * @param data_dims A size_t array of size 2 passed by address to store the dimensions of data.
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the file has headers or not. If true, the first line will be skipped.
+ * @param error A csv_utf8_error passed by address to store the 1-based line, 0-based column and byte offset of the first invalid sequence, if any.
+ */
+void csv_read_validated(const char* filename, char**** data, size_t (*data_dims)[2], char delim, bool has_headers, csv_utf8_error* error);
+
+/**
+ * @description Same as csv_read_validated() for CSV text in a csv_source.
+ * @param source A csv_source created with csv_source_from_buffer(), csv_source_from_stream() or csv_source_from_fd(). It is read once, from its current position.
+ * @param data A char*** pointer passed by address to allocate and store the CSV data.
+ * @param data_dims A size_t array of size 2 passed by address to store the dimensions of data.
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the input has headers or not. If true, the first line will be skipped.
+ * @param error A csv_utf8_error passed by address to store where the first invalid sequence is, if any.
+ */
+void csv_read_validated_from(csv_source* source, char**** data, size_t (*data_dims)[2], char delim, bool has_headers, csv_utf8_error* error);
+
+/**
+ * @description Check that a CSV file is valid UTF-8 without parsing it, e.g. before handing it to a tool that does not check.
+ * @param filename Filename to read CSV file from.
+ * @param delim A single-character delimiter, used to work out the column of an invalid sequence.
+ * @param error A csv_utf8_error passed by address to store where the first invalid sequence is, if any.
+ * @return true if the file is valid UTF-8.
+ */
+bool csv_validate_utf8(const char* filename, char delim, csv_utf8_error* error);
+
+#endif //CSVPARSER_UTF8_H
@@ -0,0 +1,49 @@
+#ifndef CSVPARSER_ZONEMAP_H
+#define CSVPARSER_ZONEMAP_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @description Build a zone map for a CSV file: a sidecar next to it (filename + ".zonemap") that splits the data rows into groups of rows_per_group rows
+ * and records each group's byte range and, for every column, its null count, the min/max of its numeric cells and the min/max of all its non-empty cells
+ * in byte order (the first 32 bytes of each). csv_read_range_by_name() and csv_read_range_by_index() use it to skip groups that cannot match.
+ * The zone map is ignored once the file's size or modification time changes, so rebuild it after writing to the file.
+ * @param filename Filename to read CSV file from.
+ * @param rows_per_group Number of rows per group, or 0 for the default (65536). Smaller groups skip more precisely but make a larger sidecar.
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the file has headers or not. If true, the first line will be skipped.
+ */
+void csv_build_zone_map(const char* filename, size_t rows_per_group, char delim, bool has_headers);
+
+/**
+ * @description Read the rows whose cell in a column (by name) lies between low and high, inclusive. If a current zone map exists (see csv_build_zone_map())
+ * groups of rows that cannot match are skipped without being read; otherwise every row is checked.
+ * If every given bound is a number, cells match when they are numbers within the bounds. Otherwise cells match when they are non-empty and between the bounds in byte order
+ * (which suits ISO-8601 timestamps). Cells are compared as csv_read() returns them, quotes included.
+ * @param filename Filename to read CSV file from. The first line must contain the column names.
+ * @param column_name Name of the column the bounds apply to.
+ * @param low Lowest matching value, or NULL for no lower bound.
+ * @param high Highest matching value, or NULL for no upper bound.
+ * @param data A char*** pointer passed by address to allocate and store the matching rows in file order.
+ * @param data_dims A size_t array of size 2 passed by address to store the number of matching rows and the column count.
+ * @param delim A single-character delimiter.
+ */
+void csv_read_range_by_name(const char* filename, const char* column_name, const char* low, const char* high, char**** data, size_t (*data_dims)[2], char delim);
+
+/**
+ * @description Read the rows whose cell in a column (by index) lies between low and high, inclusive. See csv_read_range_by_name() for how cells are compared.
+ * @param filename Filename to read CSV file from.
+ * @param column_index Index of the column the bounds apply to.
+ * @param low Lowest matching value, or NULL for no lower bound.
+ * @param high Highest matching value, or NULL for no upper bound.
+ * @param data A char*** pointer passed by address to allocate and store the matching rows in file order.
+ * @param data_dims A size_t array of size 2 passed by address to store the number of matching rows and the column count.
+ * @param delim A single-character delimiter.
+ * @param has_headers A boolean indicating if the file has headers or not. If true, the first line will be skipped.
+ */
+void csv_read_range_by_index(const char* filename, size_t column_index, const char* low, const char* high, char**** data, size_t (*data_dims)[2], char delim, bool has_headers);
+
+#endif //CSVPARSER_ZONEMAP_H
@@ -0,0 +1,84 @@
+#include "csvinternal.h"
+#include "alloc/alloc.h"
+
+static void* csv_libc_malloc(void* context, size_t size)
+{
+    (void)context;
+    return malloc(size);
+}
+
+static void* csv_libc_calloc(void* context, size_t count, size_t size)
+{
+    (void)context;
+    return calloc(count, size);
+}
+
+static void* csv_libc_realloc(void* context, void* pointer, size_t size)
+{
+    (void)context;
+    return realloc(pointer, size);
+}
+
+static void csv_libc_free(void* context, void* pointer)
+{
+    (void)context;
+    free(pointer);
+}
+
+static const csv_allocator csv_libc_allocator = { &csv_libc_malloc, &csv_libc_calloc, &csv_libc_realloc, &csv_libc_free, NULL };
+
+static csv_allocator csv_global_allocator = { &csv_libc_malloc, &csv_libc_calloc, &csv_libc_realloc, &csv_libc_free, NULL };
+
+static _Thread_local csv_allocator csv_thread_allocator;
+static _Thread_local bool csv_has_thread_allocator = false;
+
+void csv_set_allocator(const csv_allocator* allocator)
+{
+    csv_global_allocator = allocator != NULL ? *allocator : csv_libc_allocator;
+}
+
+void csv_set_thread_allocator(const csv_allocator* allocator)
+{
+    csv_has_thread_allocator = allocator != NULL;
+    if (allocator != NULL)
+        csv_thread_allocator = *allocator;
+}
+
+const csv_allocator* csv_get_allocator(void)
+{
+    return csv_has_thread_allocator ? &csv_thread_allocator : &csv_global_allocator;
+}
+
+void* csv_malloc(size_t size)
+{
+    const csv_allocator* allocator = csv_get_allocator();
+    return allocator->malloc(allocator->context, size);
+}
+
+void* csv_calloc(size_t count, size_t size)
+{
+    const csv_allocator* allocator = csv_get_allocator();
+    return allocator->calloc(allocator->context, count, size);
+}
+
+void* csv_realloc(void* pointer, size_t size)
+{
+    const csv_allocator* allocator = csv_get_allocator();
+    return allocator->realloc(allocator->context, pointer, size);
+}
+
+char* csv_strdup(const char* string)
+{
+    size_t size = strlen(string) + 1;
+    char* copy = csv_malloc(size);
+    memcpy(copy, string, size);
+    return copy;
+}
+
+void csv_dealloc(void* pointer)
+{
+    if (pointer == NULL)
+        return;
+    const csv_allocator* allocator = csv_get_allocator();
+    allocator->free(allocator->context, pointer);
+}
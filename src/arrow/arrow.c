@@ -0,0 +1,267 @@
+#include "csvinternal.h"
+#include "alloc/alloc.h"
+#include "arrow/arrow.h"
+
+// a column being read: offsets are 64-bit while reading and narrowed in place to 32-bit when the text fits
+typedef struct csv_arrow_column
+{
+    uint8_t* validity;
+    int64_t* offsets;
+    char* data;
+    size_t data_len;
+    size_t data_capacity;
+    int64_t null_count;
+} csv_arrow_column;
+
+// everything a schema or array owns, with the allocator it came from so any thread can release it
+typedef struct csv_arrow_private
+{
+    csv_allocator allocator;
+    char* name;
+    void* buffers[3];
+    const void* buffer_pointers[3];
+    void* children;
+    void* child_pointers;
+} csv_arrow_private;
+
+static void csv_arrow_free(const csv_allocator* allocator, void* pointer)
+{
+    if (pointer != NULL)
+        allocator->free(allocator->context, pointer);
+}
+
+static csv_arrow_private* csv_arrow_new_private(void)
+{
+    csv_arrow_private* private_data = csv_calloc(1, sizeof(csv_arrow_private));
+    private_data->allocator = *csv_get_allocator();
+    return private_data;
+}
+
+static void csv_arrow_release_schema(struct ArrowSchema* schema)
+{
+    // children that were moved out by the consumer are already marked released
+    for (int64_t i = 0; i < schema->n_children; ++i)
+        if (schema->children[i]->release != NULL)
+            schema->children[i]->release(schema->children[i]);
+
+    csv_arrow_private* private_data = schema->private_data;
+    csv_allocator allocator = private_data->allocator;
+    csv_arrow_free(&allocator, private_data->name);
+    csv_arrow_free(&allocator, private_data->children);
+    csv_arrow_free(&allocator, private_data->child_pointers);
+    csv_arrow_free(&allocator, private_data);
+    schema->release = NULL;
+}
+
+static void csv_arrow_release_array(struct ArrowArray* array)
+{
+    for (int64_t i = 0; i < array->n_children; ++i)
+        if (array->children[i]->release != NULL)
+            array->children[i]->release(array->children[i]);
+
+    csv_arrow_private* private_data = array->private_data;
+    csv_allocator allocator = private_data->allocator;
+    for (size_t b = 0; b < 3; ++b)
+        csv_arrow_free(&allocator, private_data->buffers[b]);
+    csv_arrow_free(&allocator, private_data->children);
+    csv_arrow_free(&allocator, private_data->child_pointers);
+    csv_arrow_free(&allocator, private_data);
+    array->release = NULL;
+}
+
+static void csv_arrow_init_schema(struct ArrowSchema* schema, const char* format, const char* name, int64_t flags)
+{
+    schema->format = format;
+    schema->name = name;
+    schema->metadata = NULL;
+    schema->flags = flags;
+    schema->n_children = 0;
+    schema->children = NULL;
+    schema->dictionary = NULL;
+    schema->release = &csv_arrow_release_schema;
+    schema->private_data = csv_arrow_new_private();
+}
+
+static void csv_arrow_init_array(struct ArrowArray* array, int64_t length, int64_t null_count, int64_t n_buffers)
+{
+    csv_arrow_private* private_data = csv_arrow_new_private();
+    array->length = length;
+    array->null_count = null_count;
+    array->offset = 0;
+    array->n_buffers = n_buffers;
+    array->n_children = 0;
+    array->buffers = private_data->buffer_pointers;
+    array->children = NULL;
+    array->dictionary = NULL;
+    array->release = &csv_arrow_release_array;
+    array->private_data = private_data;
+}
+
+static void csv_arrow_reserve_rows(csv_arrow_column* columns, size_t n_columns, size_t old_capacity, size_t capacity)
+{
+    for (size_t c = 0; c < n_columns; ++c)
+    {
+        columns[c].offsets = csv_realloc(columns[c].offsets, sizeof(int64_t) * (capacity + 1));
+        columns[c].validity = csv_realloc(columns[c].validity, capacity / 8);
+        memset(columns[c].validity + old_capacity / 8, 0, (capacity - old_capacity) / 8);
+        if (old_capacity == 0)
+        {
+            columns[c].offsets[0] = 0;
+            columns[c].data_capacity = 64;
+            columns[c].data = csv_malloc(columns[c].data_capacity);
+        }
+    }
+}
+
+// appends a cell; an empty cell is a null
+static void csv_arrow_append(csv_arrow_column* column, size_t row, const char* cell, size_t len)
+{
+    if (len > 0)
+    {
+        if (column->data_len + len > column->data_capacity)
+        {
+            column->data_capacity = column->data_capacity * 2 > column->data_len + len ? column->data_capacity * 2 : column->data_len + len;
+            column->data = csv_realloc(column->data, column->data_capacity);
+        }
+        memcpy(column->data + column->data_len, cell, len);
+        column->data_len += len;
+        column->validity[row / 8] |= (uint8_t)(1 << (row % 8));
+    }
+    else
+        column->null_count++;
+    column->offsets[row + 1] = column->data_len;
+}
+
+// hands a finished column's buffers over to a child schema and array without copying them
+static void csv_arrow_export_column(csv_arrow_column* column, size_t n_rows, char* name, struct ArrowSchema* schema, struct ArrowArray* array)
+{
+    bool large = column->data_len > INT32_MAX;
+    if (!large)
+    {
+        // each 32-bit offset is written no further in than the 64-bit offset it replaces, so this is safe in place
+        int32_t* narrow = (int32_t*)column->offsets;
+        for (size_t i = 0; i <= n_rows; ++i)
+            narrow[i] = (int32_t)column->offsets[i];
+    }
+
+    csv_arrow_init_schema(schema, large ? "U" : "u", name != NULL ? name : "", ARROW_FLAG_NULLABLE);
+    ((csv_arrow_private*)schema->private_data)->name = name;
+
+    csv_arrow_init_array(array, n_rows, column->null_count, 3);
+    csv_arrow_private* private_data = array->private_data;
+
+    // without nulls the validity bitmap may be left out
+    if (column->null_count == 0)
+    {
+        csv_dealloc(column->validity);
+        column->validity = NULL;
+    }
+    private_data->buffers[0] = column->validity;
+    private_data->buffers[1] = column->offsets;
+    private_data->buffers[2] = column->data;
+    for (size_t b = 0; b < 3; ++b)
+        private_data->buffer_pointers[b] = private_data->buffers[b];
+}
+
+void csv_read_arrow(const char* filename, struct ArrowSchema* schema, struct ArrowArray* array, char delim, bool has_headers)
+{
+    FILE* file = fopen(filename, "r");
+    if (file == NULL)
+    {
+        printf("File not found!\n");
+        exit(-1);
+    }
+
+    csv_source source = csv_source_from_stream(file);
+    csv_read_arrow_from(&source, schema, array, delim, has_headers);
+    fclose(file);
+}
+
+void csv_read_arrow_from(csv_source* source, struct ArrowSchema* schema, struct ArrowArray* array, char delim, bool has_headers)
+{
+    csv_reader reader;
+    csv_reader_init(&reader, source);
+
+    // the first line gives the column count (and names); without headers it is data, so it is read again below
+    const char* line;
+    size_t len;
+    size_t n_columns = 0;
+    char** names = NULL;
+    if (csv_reader_next(&reader, &line, &len))
+    {
+        if (has_headers)
+            n_columns = csv_parse_line_n(line, len, delim, &names);
+        else
+        {
+            n_columns = csv_count_columns_n(line, len, delim);
+            csv_reader_unread(&reader);
+        }
+    }
+
+    // capacities stay multiples of 8 so validity bitmaps grow in whole bytes
+    csv_arrow_column* columns = csv_calloc(n_columns > 0 ? n_columns : 1, sizeof(csv_arrow_column));
+    size_t rows_capacity = 1024;
+    size_t n_rows = 0;
+    csv_arrow_reserve_rows(columns, n_columns, 0, rows_capacity);
+
+    while (csv_reader_next(&reader, &line, &len))
+    {
+        if (n_rows == rows_capacity)
+        {
+            csv_arrow_reserve_rows(columns, n_columns, rows_capacity, rows_capacity * 2);
+            rows_capacity *= 2;
+        }
+
+        // split with the same quote rules as csv_parse_line(), writing each cell straight into its column
+        if (len > 0 && line[len - 1] == '\n')
+            len--;
+        bool inside_quotes = false;
+        size_t column = 0;
+        size_t start = 0;
+        for (size_t i = 0; i <= len && column < n_columns; ++i)
+        {
+            if (i < len)
+            {
+                if (line[i] == '\"')
+                    inside_quotes = !inside_quotes;
+                if (line[i] != delim || inside_quotes)
+                    continue;
+            }
+            csv_arrow_append(&columns[column++], n_rows, line + start, i - start);
+            start = i + 1;
+        }
+        for (; column < n_columns; ++column)
+            csv_arrow_append(&columns[column], n_rows, NULL, 0);
+        n_rows++;
+    }
+    csv_reader_free(&reader);
+
+    // the top level is a struct array whose children are the columns
+    csv_arrow_init_schema(schema, "+s", "", 0);
+    csv_arrow_init_array(array, n_rows, 0, 1);
+    csv_arrow_private* schema_private = schema->private_data;
+    csv_arrow_private* array_private = array->private_data;
+    struct ArrowSchema* child_schemas = csv_calloc(n_columns > 0 ? n_columns : 1, sizeof(struct ArrowSchema));
+    struct ArrowArray* child_arrays = csv_calloc(n_columns > 0 ? n_columns : 1, sizeof(struct ArrowArray));
+    struct ArrowSchema** child_schema_pointers = csv_malloc(sizeof(struct ArrowSchema*) * (n_columns > 0 ? n_columns : 1));
+    struct ArrowArray** child_array_pointers = csv_malloc(sizeof(struct ArrowArray*) * (n_columns > 0 ? n_columns : 1));
+    for (size_t c = 0; c < n_columns; ++c)
+    {
+        csv_arrow_export_column(&columns[c], n_rows, names != NULL ? names[c] : NULL, &child_schemas[c], &child_arrays[c]);
+        child_schema_pointers[c] = &child_schemas[c];
+        child_array_pointers[c] = &child_arrays[c];
+    }
+
+    schema->n_children = n_columns;
+    schema->children = child_schema_pointers;
+    schema_private->children = child_schemas;
+    schema_private->child_pointers = child_schema_pointers;
+    array->n_children = n_columns;
+    array->children = child_array_pointers;
+    array_private->children = child_arrays;
+    array_private->child_pointers = child_array_pointers;
+
+    // the name strings now belong to the child schemas
+    csv_dealloc(names);
+    csv_dealloc(columns);
+}
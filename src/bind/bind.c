@@ -0,0 +1,147 @@
+#include <strings.h>
+
+#include "csvinternal.h"
+#include "bind/bind.h"
+
+void csv_bind_int(const char* cell, void* field, size_t field_size)
+{
+    (void)field_size;
+    *(int*)field = csv_parse_int(cell);
+}
+
+void csv_bind_long(const char* cell, void* field, size_t field_size)
+{
+    (void)field_size;
+    char* end;
+    *(long*)field = strtol(cell, &end, 10);
+}
+
+void csv_bind_int64_t(const char* cell, void* field, size_t field_size)
+{
+    (void)field_size;
+    char* end;
+    *(int64_t*)field = strtoll(cell, &end, 10);
+}
+
+void csv_bind_float(const char* cell, void* field, size_t field_size)
+{
+    (void)field_size;
+    *(float*)field = csv_parse_float(cell);
+}
+
+void csv_bind_double(const char* cell, void* field, size_t field_size)
+{
+    (void)field_size;
+    char* end;
+    *(double*)field = strtod(cell, &end);
+}
+
+void csv_bind_bool(const char* cell, void* field, size_t field_size)
+{
+    (void)field_size;
+    *(bool*)field = strcasecmp(cell, "true") == 0 || strcasecmp(cell, "yes") == 0 || strcmp(cell, "1") == 0;
+}
+
+void csv_bind_string(const char* cell, void* field, size_t field_size)
+{
+    (void)field_size;
+    *(char**)field = csv_strdup(cell);
+}
+
+void csv_bind_chars(const char* cell, void* field, size_t field_size)
+{
+    if (field_size == 0)
+        return;
+    size_t len = strlen(cell);
+    if (len > field_size - 1)
+        len = field_size - 1;
+    memcpy(field, cell, len);
+    ((char*)field)[len] = 0;
+}
+
+void csv_read_structs(const char* filename, const csv_binding* bindings, size_t n_bindings, size_t struct_size, void** structs, size_t* n_structs, char delim)
+{
+    FILE* file = fopen(filename, "r");
+    if (file == NULL)
+    {
+        printf("File not found!\n");
+        exit(-1);
+    }
+
+    csv_source source = csv_source_from_stream(file);
+    csv_read_structs_from(&source, bindings, n_bindings, struct_size, structs, n_structs, delim);
+    fclose(file);
+}
+
+void csv_read_structs_from(csv_source* source, const csv_binding* bindings, size_t n_bindings, size_t struct_size, void** structs, size_t* n_structs, char delim)
+{
+    csv_reader reader;
+    csv_reader_init(&reader, source);
+
+    // the mapping from columns to fields is resolved once from the header
+    char** columns = NULL;
+    size_t n_columns = csv_reader_header(&reader, delim, &columns);
+    size_t* binding_columns = csv_malloc(sizeof(size_t) * (n_bindings > 0 ? n_bindings : 1));
+    size_t max_fields = 0;
+    for (size_t b = 0; b < n_bindings; ++b)
+    {
+        binding_columns[b] = SIZE_MAX;
+        for (size_t c = 0; c < n_columns; ++c)
+            if (strcmp(columns[c], bindings[b].column) == 0)
+            {
+                binding_columns[b] = c;
+                if (c + 1 > max_fields)
+                    max_fields = c + 1;
+                break;
+            }
+    }
+    for (size_t c = 0; c < n_columns; ++c)
+        csv_dealloc(columns[c]);
+    csv_dealloc(columns);
+
+    size_t capacity = 1024;
+    size_t n_rows = 0;
+    (*structs) = csv_calloc(capacity, struct_size);
+    char** fields = csv_malloc(sizeof(char*) * (max_fields > 0 ? max_fields : 1));
+    char* buffer = NULL;
+    size_t buffer_capacity = 0;
+
+    const char* line;
+    size_t len;
+    while (csv_reader_next(&reader, &line, &len))
+    {
+        if (n_rows == capacity)
+        {
+            (*structs) = csv_realloc((*structs), struct_size * capacity * 2);
+            memset((char*)(*structs) + struct_size * capacity, 0, struct_size * capacity);
+            capacity *= 2;
+        }
+
+        // the line is copied once so it can be split in place; only the columns up to the last bound one are split out
+        if (len + 1 > buffer_capacity)
+        {
+            buffer_capacity = len + 1 > buffer_capacity * 2 ? len + 1 : buffer_capacity * 2;
+            buffer = csv_realloc(buffer, buffer_capacity);
+        }
+        memcpy(buffer, line, len);
+        buffer[len] = 0;
+        size_t n_fields = csv_split_line(buffer, delim, fields, max_fields);
+
+        char* row = (char*)(*structs) + struct_size * n_rows;
+        for (size_t b = 0; b < n_bindings; ++b)
+        {
+            size_t c = binding_columns[b];
+            if (c == SIZE_MAX)
+                continue;
+            const char* cell = c < n_fields && fields[c][0] != 0 ? fields[c] : "(null)";
+            bindings[b].parser(cell, row + bindings[b].offset, bindings[b].size);
+        }
+        n_rows++;
+    }
+    csv_reader_free(&reader);
+
+    *n_structs = n_rows;
+    csv_dealloc(buffer);
+    csv_dealloc(fields);
+    csv_dealloc(binding_columns);
+}
@@ -0,0 +1,566 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "csvinternal.h"
+#include "cache/cache.h"
+
+#define CSV_CACHE_MAGIC "CSVCACH2"
+#define CSV_CACHE_SUFFIX ".csvcache"
+
+// sidecar layout (native endianness, every section 8-byte aligned):
+//   csv_cache_header, uint64_t column_offsets[n_columns]
+//   per column: csv_cache_column, uint64_t offsets[n_rows + 1], uint8_t validity[(n_rows + 7) / 8],
+//               char pool[pool_size] (cells are \0 terminated), and when typed: int32_t ints[n_rows], float floats[n_rows]
+// the first line of the file is stored as row 0 so has_headers only decides whether it is skipped
+typedef struct csv_cache_header
+{
+    char magic[8];
+    uint64_t source_size;
+    int64_t source_mtime_sec;
+    int64_t source_mtime_nsec;
+    uint64_t delim;
+    uint64_t n_rows;
+    uint64_t n_columns;
+} csv_cache_header;
+
+typedef struct csv_cache_column
+{
+    uint64_t pool_size;
+    uint64_t typed;
+} csv_cache_column;
+
+// a validated sidecar mapped into memory
+typedef struct csv_cache
+{
+    const char* map;
+    size_t map_size;
+    const csv_cache_header* header;
+} csv_cache;
+
+// pointers into one column's section of the sidecar
+typedef struct csv_cache_view
+{
+    const uint64_t* offsets;
+    const uint8_t* validity;
+    const char* pool;
+    const int32_t* ints;
+    const float* floats;
+} csv_cache_view;
+
+static bool csv_cache_enabled = false;
+
+void csv_set_cache(bool enabled)
+{
+    csv_cache_enabled = enabled;
+}
+
+static size_t csv_cache_align(size_t size)
+{
+    return (size + 7) & ~(size_t)7;
+}
+
+static size_t csv_cache_column_size(size_t n_rows, size_t pool_size, bool typed)
+{
+    size_t size = sizeof(csv_cache_column)
+                  + csv_cache_align(sizeof(uint64_t) * (n_rows + 1))
+                  + csv_cache_align((n_rows + 7) / 8)
+                  + csv_cache_align(pool_size);
+    if (typed)
+        size += csv_cache_align(sizeof(int32_t) * n_rows) + csv_cache_align(sizeof(float) * n_rows);
+    return size;
+}
+
+static csv_cache_view csv_cache_column_view(const char* column_start, size_t n_rows)
+{
+    const csv_cache_column* column = (const csv_cache_column*)column_start;
+    const char* pos = column_start + sizeof(csv_cache_column);
+    csv_cache_view view;
+
+    view.offsets = (const uint64_t*)pos;
+    pos += csv_cache_align(sizeof(uint64_t) * (n_rows + 1));
+    view.validity = (const uint8_t*)pos;
+    pos += csv_cache_align((n_rows + 7) / 8);
+    view.pool = pos;
+    pos += csv_cache_align(column->pool_size);
+
+    view.ints = NULL;
+    view.floats = NULL;
+    if (column->typed)
+    {
+        view.ints = (const int32_t*)pos;
+        pos += csv_cache_align(sizeof(int32_t) * n_rows);
+        view.floats = (const float*)pos;
+    }
+    return view;
+}
+
+static char* csv_cache_path(const char* filename)
+{
+    char* path = csv_malloc(strlen(filename) + strlen(CSV_CACHE_SUFFIX) + 1);
+    strcpy(path, filename);
+    strcat(path, CSV_CACHE_SUFFIX);
+    return path;
+}
+
+static bool csv_cache_is_numeric(const char* cell)
+{
+    char* end;
+    strtod(cell, &end);
+    return end != cell && *end == 0;
+}
+
+// first pass: count rows and size each column's string pool so the sidecar can be laid out up front
+static bool csv_cache_measure(FILE* file, char delim, size_t* n_rows, size_t* n_columns, size_t** pool_sizes, bool** typed)
+{
+    char* line = NULL;
+    size_t len = 0;
+    char** fields = NULL;
+    *n_rows = 0;
+    *n_columns = 0;
+
+    while (getline(&line, &len, file) != -1)
+    {
+        if (*n_rows == 0)
+        {
+            // a byte order mark is not part of the first cell
+            size_t bom = csv_bom_length(line, strlen(line));
+            memmove(line, line + bom, strlen(line) + 1 - bom);
+
+            *n_columns = csv_count_columns(line, delim);
+            fields = csv_malloc(sizeof(char*) * *n_columns);
+            *pool_sizes = csv_calloc(*n_columns, sizeof(size_t));
+            *typed = csv_malloc(sizeof(bool) * *n_columns);
+            for (size_t c = 0; c < *n_columns; ++c)
+                (*typed)[c] = true;
+        }
+
+        size_t n_fields = csv_split_line(line, delim, fields, *n_columns);
+        for (size_t c = 0; c < *n_columns && c < n_fields; ++c)
+        {
+            if (fields[c][0] == 0)
+                continue;
+            (*pool_sizes)[c] += strlen(fields[c]) + 1;
+
+            // the header (row 0) should not stop a column from being stored as numbers
+            if (*n_rows > 0 && (*typed)[c] && !csv_cache_is_numeric(fields[c]))
+                (*typed)[c] = false;
+        }
+        (*n_rows)++;
+    }
+
+    csv_dealloc(fields);
+    free(line);
+    return *n_rows > 0;
+}
+
+// second pass: parse the file again, writing straight into the mapped sidecar.
+// returns false if the file no longer matches what the first pass measured
+static bool csv_cache_fill(FILE* file, char delim, char* map, const csv_cache_header* header)
+{
+    const uint64_t* column_offsets = (const uint64_t*)(map + sizeof(csv_cache_header));
+    size_t n_columns = header->n_columns;
+    size_t* pool_used = csv_calloc(n_columns, sizeof(size_t));
+    char** fields = csv_malloc(sizeof(char*) * n_columns);
+    char* line = NULL;
+    size_t len = 0;
+    size_t row = 0;
+    bool matches = true;
+
+    while (matches && row < header->n_rows && getline(&line, &len, file) != -1)
+    {
+        if (row == 0)
+        {
+            size_t bom = csv_bom_length(line, strlen(line));
+            memmove(line, line + bom, strlen(line) + 1 - bom);
+        }
+
+        size_t n_fields = csv_split_line(line, delim, fields, n_columns);
+        for (size_t c = 0; c < n_columns; ++c)
+        {
+            csv_cache_view view = csv_cache_column_view(map + column_offsets[c], header->n_rows);
+            uint64_t* offsets = (uint64_t*)view.offsets;
+            uint8_t* validity = (uint8_t*)view.validity;
+            const char* cell = c < n_fields && fields[c][0] != 0 ? fields[c] : NULL;
+
+            offsets[row] = pool_used[c];
+            if (cell != NULL)
+            {
+                size_t cell_len = strlen(cell) + 1;
+                const csv_cache_column* column = (const csv_cache_column*)(map + column_offsets[c]);
+                if (pool_used[c] + cell_len > column->pool_size)
+                {
+                    matches = false;
+                    break;
+                }
+                memcpy((char*)view.pool + pool_used[c], cell, cell_len);
+                pool_used[c] += cell_len;
+                validity[row / 8] |= (uint8_t)(1 << (row % 8));
+            }
+
+            // same casts as csv_data_to_int() and csv_data_to_float() on the "(null)" placeholder
+            if (view.ints != NULL)
+            {
+                char* end;
+                ((int32_t*)view.ints)[row] = strtol(cell != NULL ? cell : "(null)", &end, 10);
+                ((float*)view.floats)[row] = strtof(cell != NULL ? cell : "(null)", &end);
+            }
+        }
+        row++;
+    }
+
+    for (size_t c = 0; c < n_columns; ++c)
+    {
+        csv_cache_view view = csv_cache_column_view(map + column_offsets[c], header->n_rows);
+        ((uint64_t*)view.offsets)[header->n_rows] = pool_used[c];
+    }
+
+    free(line);
+    csv_dealloc(fields);
+    csv_dealloc(pool_used);
+    return matches && row == header->n_rows;
+}
+
+// writes the sidecar to a temporary file and renames it into place so readers never see a partial cache
+static bool csv_cache_build(const char* filename, const char* path, const struct stat* source_stat, char delim)
+{
+    FILE* file = fopen(filename, "r");
+    if (file == NULL)
+        return false;
+
+    size_t n_rows;
+    size_t n_columns;
+    size_t* pool_sizes = NULL;
+    bool* typed = NULL;
+    if (!csv_cache_measure(file, delim, &n_rows, &n_columns, &pool_sizes, &typed))
+    {
+        fclose(file);
+        return false;
+    }
+
+    csv_cache_header header;
+    memcpy(header.magic, CSV_CACHE_MAGIC, sizeof(header.magic));
+    header.source_size = source_stat->st_size;
+    header.source_mtime_sec = source_stat->st_mtim.tv_sec;
+    header.source_mtime_nsec = source_stat->st_mtim.tv_nsec;
+    header.delim = (unsigned char)delim;
+    header.n_rows = n_rows;
+    header.n_columns = n_columns;
+
+    size_t size = sizeof(csv_cache_header) + sizeof(uint64_t) * n_columns;
+    uint64_t* column_offsets = csv_malloc(sizeof(uint64_t) * n_columns);
+    for (size_t c = 0; c < n_columns; ++c)
+    {
+        column_offsets[c] = size;
+        size += csv_cache_column_size(n_rows, pool_sizes[c], typed[c]);
+    }
+
+    char* tmp_path;
+    int fd = csv_create_temp_file(path, &tmp_path);
+    char* map = MAP_FAILED;
+    if (fd != -1 && ftruncate(fd, size) == 0)
+        map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    bool built = false;
+    if (map != MAP_FAILED)
+    {
+        // ftruncate() zero fills, so validity bitmaps start out all null
+        memcpy(map, &header, sizeof(header));
+        memcpy(map + sizeof(header), column_offsets, sizeof(uint64_t) * n_columns);
+        for (size_t c = 0; c < n_columns; ++c)
+        {
+            csv_cache_column* column = (csv_cache_column*)(map + column_offsets[c]);
+            column->pool_size = pool_sizes[c];
+            column->typed = typed[c];
+        }
+
+        rewind(file);
+        built = csv_cache_fill(file, delim, map, &header);
+        munmap(map, size);
+        built = built && rename(tmp_path, path) == 0;
+    }
+
+    if (fd != -1)
+        close(fd);
+    if (!built && fd != -1)
+        unlink(tmp_path);
+
+    csv_dealloc(tmp_path);
+    csv_dealloc(column_offsets);
+    csv_dealloc(pool_sizes);
+    csv_dealloc(typed);
+    fclose(file);
+    return built;
+}
+
+static bool csv_cache_map(const char* path, const struct stat* source_stat, char delim, csv_cache* cache)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd == -1)
+        return false;
+
+    struct stat cache_stat;
+    if (fstat(fd, &cache_stat) == -1 || (size_t)cache_stat.st_size < sizeof(csv_cache_header))
+    {
+        close(fd);
+        return false;
+    }
+
+    const char* map = mmap(NULL, cache_stat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return false;
+
+    // the sidecar is only valid for the exact file contents and delimiter it was built from
+    const csv_cache_header* header = (const csv_cache_header*)map;
+    bool valid = memcmp(header->magic, CSV_CACHE_MAGIC, sizeof(header->magic)) == 0
+                 && header->source_size == (uint64_t)source_stat->st_size
+                 && header->source_mtime_sec == (int64_t)source_stat->st_mtim.tv_sec
+                 && header->source_mtime_nsec == (int64_t)source_stat->st_mtim.tv_nsec
+                 && header->delim == (unsigned char)delim
+                 && header->n_columns <= ((size_t)cache_stat.st_size - sizeof(csv_cache_header)) / sizeof(uint64_t);
+
+    // every column section has to lie inside the file, so a damaged sidecar whose header still matches is rebuilt instead of read out of bounds
+    size_t map_size = cache_stat.st_size;
+    valid = valid && header->n_rows <= map_size / sizeof(uint64_t);
+    const uint64_t* column_offsets = (const uint64_t*)(map + sizeof(csv_cache_header));
+    for (size_t c = 0; valid && c < header->n_columns; ++c)
+    {
+        uint64_t offset = column_offsets[c];
+        valid = offset % 8 == 0 && offset >= sizeof(csv_cache_header) && offset <= map_size - sizeof(csv_cache_column);
+        if (!valid)
+            break;
+        const csv_cache_column* column = (const csv_cache_column*)(map + offset);
+        valid = column->pool_size <= map_size
+                && csv_cache_column_size(header->n_rows, column->pool_size, column->typed) <= map_size - offset;
+    }
+
+    if (!valid)
+    {
+        munmap((void*)map, cache_stat.st_size);
+        return false;
+    }
+
+    cache->map = map;
+    cache->map_size = cache_stat.st_size;
+    cache->header = header;
+    return true;
+}
+
+// maps the file's sidecar, building it first when it is missing or stale
+static bool csv_cache_open(const char* filename, char delim, csv_cache* cache)
+{
+    if (!csv_cache_enabled)
+        return false;
+
+    struct stat source_stat;
+    if (stat(filename, &source_stat) == -1)
+        return false;
+
+    char* path = csv_cache_path(filename);
+    bool opened = csv_cache_map(path, &source_stat, delim, cache)
+                  || (csv_cache_build(filename, path, &source_stat, delim) && csv_cache_map(path, &source_stat, delim, cache));
+    csv_dealloc(path);
+    return opened;
+}
+
+static void csv_cache_close(csv_cache* cache)
+{
+    munmap((void*)cache->map, cache->map_size);
+}
+
+static csv_cache_view csv_cache_get_column(const csv_cache* cache, size_t column_index)
+{
+    const uint64_t* column_offsets = (const uint64_t*)(cache->map + sizeof(csv_cache_header));
+    return csv_cache_column_view(cache->map + column_offsets[column_index], cache->header->n_rows);
+}
+
+static char* csv_cache_cell(const csv_cache_view* view, size_t row)
+{
+    if (!(view->validity[row / 8] & (1 << (row % 8))))
+        return csv_strdup("(null)");
+
+    size_t len = view->offsets[row + 1] - view->offsets[row];
+    char* cell = csv_malloc(len);
+    memcpy(cell, view->pool + view->offsets[row], len);
+    return cell;
+}
+
+static int csv_cache_cell_int(const csv_cache_view* view, size_t row)
+{
+    if (view->ints != NULL)
+        return view->ints[row];
+
+    char* end;
+    const char* cell = view->validity[row / 8] & (1 << (row % 8)) ? view->pool + view->offsets[row] : "(null)";
+    return strtol(cell, &end, 10);
+}
+
+static float csv_cache_cell_float(const csv_cache_view* view, size_t row)
+{
+    if (view->floats != NULL)
+        return view->floats[row];
+
+    char* end;
+    const char* cell = view->validity[row / 8] & (1 << (row % 8)) ? view->pool + view->offsets[row] : "(null)";
+    return strtof(cell, &end);
+}
+
+bool csv_cache_read(const char* filename, char delim, bool has_headers, char**** data, size_t (*data_dims)[2])
+{
+    csv_cache cache;
+    if (!csv_cache_open(filename, delim, &cache))
+        return false;
+
+    size_t first_row = has_headers ? 1 : 0;
+    size_t n_rows = cache.header->n_rows - first_row;
+    size_t n_columns = cache.header->n_columns;
+
+    csv_cache_view* views = csv_malloc(sizeof(csv_cache_view) * n_columns);
+    for (size_t c = 0; c < n_columns; ++c)
+        views[c] = csv_cache_get_column(&cache, c);
+
+    (*data) = csv_calloc(n_rows > 0 ? n_rows : 1, sizeof(char**));
+    for (size_t r = 0; r < n_rows; ++r)
+    {
+        (*data)[r] = csv_malloc(sizeof(char*) * n_columns);
+        for (size_t c = 0; c < n_columns; ++c)
+            (*data)[r][c] = csv_cache_cell(&views[c], first_row + r);
+    }
+    (*data_dims)[0] = n_rows;
+    (*data_dims)[1] = n_columns;
+
+    csv_dealloc(views);
+    csv_cache_close(&cache);
+    return true;
+}
+
+bool csv_cache_read_int(const char* filename, char delim, bool has_headers, int*** data, size_t (*data_dims)[2])
+{
+    csv_cache cache;
+    if (!csv_cache_open(filename, delim, &cache))
+        return false;
+
+    size_t first_row = has_headers ? 1 : 0;
+    size_t n_rows = cache.header->n_rows - first_row;
+    size_t n_columns = cache.header->n_columns;
+
+    (*data) = csv_malloc(sizeof(int*) * (n_rows > 0 ? n_rows : 1));
+    for (size_t r = 0; r < n_rows; ++r)
+        (*data)[r] = csv_malloc(sizeof(int) * n_columns);
+
+    for (size_t c = 0; c < n_columns; ++c)
+    {
+        csv_cache_view view = csv_cache_get_column(&cache, c);
+        for (size_t r = 0; r < n_rows; ++r)
+            (*data)[r][c] = csv_cache_cell_int(&view, first_row + r);
+    }
+    (*data_dims)[0] = n_rows;
+    (*data_dims)[1] = n_columns;
+
+    csv_cache_close(&cache);
+    return true;
+}
+
+bool csv_cache_read_float(const char* filename, char delim, bool has_headers, float*** data, size_t (*data_dims)[2])
+{
+    csv_cache cache;
+    if (!csv_cache_open(filename, delim, &cache))
+        return false;
+
+    size_t first_row = has_headers ? 1 : 0;
+    size_t n_rows = cache.header->n_rows - first_row;
+    size_t n_columns = cache.header->n_columns;
+
+    (*data) = csv_malloc(sizeof(float*) * (n_rows > 0 ? n_rows : 1));
+    for (size_t r = 0; r < n_rows; ++r)
+        (*data)[r] = csv_malloc(sizeof(float) * n_columns);
+
+    for (size_t c = 0; c < n_columns; ++c)
+    {
+        csv_cache_view view = csv_cache_get_column(&cache, c);
+        for (size_t r = 0; r < n_rows; ++r)
+            (*data)[r][c] = csv_cache_cell_float(&view, first_row + r);
+    }
+    (*data_dims)[0] = n_rows;
+    (*data_dims)[1] = n_columns;
+
+    csv_cache_close(&cache);
+    return true;
+}
+
+bool csv_cache_read_column(const char* filename, size_t column_index, char delim, bool has_headers, char*** data, size_t* data_rows)
+{
+    csv_cache cache;
+    if (!csv_cache_open(filename, delim, &cache))
+        return false;
+
+    if (column_index >= cache.header->n_columns)
+    {
+        csv_cache_close(&cache);
+        return false;
+    }
+
+    size_t first_row = has_headers ? 1 : 0;
+    size_t n_rows = cache.header->n_rows - first_row;
+    csv_cache_view view = csv_cache_get_column(&cache, column_index);
+
+    (*data) = csv_calloc(n_rows > 0 ? n_rows : 1, sizeof(char*));
+    for (size_t r = 0; r < n_rows; ++r)
+        (*data)[r] = csv_cache_cell(&view, first_row + r);
+    *data_rows = n_rows;
+
+    csv_cache_close(&cache);
+    return true;
+}
+
+bool csv_cache_read_column_int(const char* filename, size_t column_index, char delim, bool has_headers, int** data, size_t* data_rows)
+{
+    csv_cache cache;
+    if (!csv_cache_open(filename, delim, &cache))
+        return false;
+
+    if (column_index >= cache.header->n_columns)
+    {
+        csv_cache_close(&cache);
+        return false;
+    }
+
+    size_t first_row = has_headers ? 1 : 0;
+    size_t n_rows = cache.header->n_rows - first_row;
+    csv_cache_view view = csv_cache_get_column(&cache, column_index);
+
+    (*data) = csv_malloc(sizeof(int) * (n_rows > 0 ? n_rows : 1));
+    for (size_t r = 0; r < n_rows; ++r)
+        (*data)[r] = csv_cache_cell_int(&view, first_row + r);
+    *data_rows = n_rows;
+
+    csv_cache_close(&cache);
+    return true;
+}
+
+bool csv_cache_read_column_float(const char* filename, size_t column_index, char delim, bool has_headers, float** data, size_t* data_rows)
+{
+    csv_cache cache;
+    if (!csv_cache_open(filename, delim, &cache))
+        return false;
+
+    if (column_index >= cache.header->n_columns)
+    {
+        csv_cache_close(&cache);
+        return false;
+    }
+
+    size_t first_row = has_headers ? 1 : 0;
+    size_t n_rows = cache.header->n_rows - first_row;
+    csv_cache_view view = csv_cache_get_column(&cache, column_index);
+
+    (*data) = csv_malloc(sizeof(float) * (n_rows > 0 ? n_rows : 1));
+    for (size_t r = 0; r < n_rows; ++r)
+        (*data)[r] = csv_cache_cell_float(&view, first_row + r);
+    *data_rows = n_rows;
+
+    csv_cache_close(&cache);
+    return true;
+}
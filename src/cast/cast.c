@@ -1,51 +1,391 @@
+#include <float.h>
+
+#include "csvinternal.h"
 #include "cast/cast.h"
 
-void csv_data_to_int(char*** data, size_t data_dims[2], int*** int_data)
+// rows (or column cells) converted by one pool task
+#define CSV_CAST_BLOCK 4096
+
+// every power of ten up to 1e10 is exactly representable as a float
+static const float csv_powers_of_ten[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+
+// value of 8 ASCII digits, converted 2, 4 then 8 at a time within one 64-bit word (SWAR)
+static uint64_t csv_parse_eight_digits(const char* digits)
 {
-    // allocate necessary memory to store the integers
-    *int_data = malloc(sizeof(int*) * data_dims[0]);
-    for (size_t i = 0; i < data_dims[0]; ++i)
-        (*int_data)[i] = malloc(sizeof(int) * data_dims[1]);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t value;
+    memcpy(&value, digits, sizeof(value));
+    value = ((value & 0x0F0F0F0F0F0F0F0FULL) * 2561) >> 8;
+    value = ((value & 0x00FF00FF00FF00FFULL) * 6553601) >> 16;
+    return ((value & 0x0000FFFF0000FFFFULL) * 42949672960001ULL) >> 32;
+#else
+    uint64_t value = 0;
+    for (size_t i = 0; i < 8; ++i)
+        value = value * 10 + (digits[i] - '0');
+    return value;
+#endif
+}
 
-    // cast values from string to int
-    char* end;
-    for (size_t i = 0; i < data_dims[0]; ++i)
-        for (size_t j = 0; j < data_dims[1]; ++j)
-            (*int_data)[i][j] = strtol(data[i][j], &end, 10);
+// value of len (at most 19) ASCII digits
+static uint64_t csv_parse_digits(const char* digits, size_t len)
+{
+    uint64_t value = 0;
+    for (; len >= 8; len -= 8, digits += 8)
+        value = value * 100000000 + csv_parse_eight_digits(digits);
+    for (; len > 0; --len, ++digits)
+        value = value * 10 + (*digits - '0');
+    return value;
 }
 
-void csv_data_to_float(char*** data, size_t data_dims[2], float*** float_data)
+static size_t csv_count_digits(const char* c)
+{
+    size_t len = 0;
+    while (c[len] >= '0' && c[len] <= '9')
+        len++;
+    return len;
+}
+
+// same result as (int)strtol(cell, &end, 10) for every cell; plain integers that cannot overflow a long skip strtol
+int csv_parse_int(const char* cell)
 {
-    // allocate necessary memory to store the integers
-    *float_data = malloc(sizeof(float*) * data_dims[0]);
-    for (size_t i = 0; i < data_dims[0]; ++i)
-        (*float_data)[i] = malloc(sizeof(float) * data_dims[1]);
+    const char* c = cell;
+    bool negative = *c == '-';
+    if (*c == '-' || *c == '+')
+        c++;
 
-    // cast values from string to int
-    char* end;
-    for (size_t i = 0; i < data_dims[0]; ++i)
-        for (size_t j = 0; j < data_dims[1]; ++j)
-            (*float_data)[i][j] = strtof(data[i][j], &end);
+    // leading whitespace, cells without digits (e.g. "(null)") and possible overflows are left to strtol
+    size_t len = csv_count_digits(c);
+    if (len == 0 || len > (sizeof(long) >= 8 ? 18 : 9))
+    {
+        char* end;
+        return strtol(cell, &end, 10);
+    }
+
+    long value = (long)csv_parse_digits(c, len);
+    return negative ? -value : value;
 }
 
-void csv_column_to_int(char** data, size_t data_rows, int** int_data)
+// same result as strtof(cell, &end) for every cell
+// decimals with at most 7 significant digits and 10 fraction digits are exact integers divided by an exact power of ten,
+// so the single float division is correctly rounded just like strtof; whole numbers up to 18 digits need only the conversion
+// to float, which is correctly rounded too; everything else is left to strtof
+float csv_parse_float(const char* cell)
 {
-    // allocate necessary memory to store the integers
-    *int_data = malloc(sizeof(int) * data_rows);
+#if FLT_EVAL_METHOD == 0
+    const char* c = cell;
+    bool negative = *c == '-';
+    if (*c == '-' || *c == '+')
+        c++;
+
+    size_t int_len = csv_count_digits(c);
+    const char* fraction = c + int_len;
+    size_t fraction_len = 0;
+    if (*fraction == '.')
+    {
+        fraction++;
+        fraction_len = csv_count_digits(fraction);
+    }
+    char next = fraction[fraction_len];
+
+    // exponents and hexadecimal floats are left to strtof
+    if (int_len + fraction_len > 0 && int_len + fraction_len <= 19 && fraction_len <= 10 && next != 'e' && next != 'E' && next != 'x' && next != 'X')
+    {
+        uint64_t mantissa = csv_parse_digits(c, int_len) * (uint64_t)csv_powers_of_ten[fraction_len] + csv_parse_digits(fraction, fraction_len);
+        if (mantissa < (1 << 24) || (fraction_len == 0 && int_len <= 18))
+        {
+            // a whole number is rounded once by the conversion itself
+            float value = fraction_len == 0 ? (float)(int64_t)mantissa : (float)mantissa / csv_powers_of_ten[fraction_len];
+            return negative ? -value : value;
+        }
+    }
+#endif
 
-    // cast values from string to int
     char* end;
-    for (size_t i = 0; i < data_rows; ++i)
-        (*int_data)[i] = strtol(data[i], &end, 10);
+    return strtof(cell, &end);
+}
+
+// value of n ASCII digits, or -1 if any of them is not a digit
+static int csv_parse_fixed_digits(const char* c, size_t n)
+{
+    int value = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (c[i] < '0' || c[i] > '9')
+            return -1;
+        value = value * 10 + (c[i] - '0');
+    }
+    return value;
+}
+
+// the fields of "YYYY-MM-DDTHH:MM" (T or space) from its fixed positions, or false if the layout does not match
+static bool csv_parse_date_time_fields(const char* c, int* fields)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    // both 8-byte halves are checked at once (SWAR): separators are compared under a mask, then swapped for '0' so every byte must be a digit
+    const uint64_t separator_mask[2] = { 0xFF0000FF00000000ULL, 0x0000FF0000FF0000ULL };
+    const uint64_t separators[2] = { 0x2D00002D00000000ULL, 0x00003A0000540000ULL };
+    uint64_t words[2];
+    memcpy(words, c, sizeof(words));
+    if (c[10] == ' ')
+        words[1] ^= (uint64_t)(' ' ^ 'T') << 16;
+    uint64_t digits[2];
+    for (size_t w = 0; w < 2; ++w)
+    {
+        if ((words[w] & separator_mask[w]) != separators[w])
+            return false;
+        uint64_t word = (words[w] & ~separator_mask[w]) | (0x3030303030303030ULL & separator_mask[w]);
+        if (((word & 0xF0F0F0F0F0F0F0F0ULL) | (((word + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) != 0x3333333333333333ULL)
+            return false;
+        digits[w] = word - 0x3030303030303030ULL;
+    }
+
+#define CSV_DIGIT(w, i) ((int)((digits[w] >> (8 * (i))) & 0xFF))
+    fields[0] = CSV_DIGIT(0, 0) * 1000 + CSV_DIGIT(0, 1) * 100 + CSV_DIGIT(0, 2) * 10 + CSV_DIGIT(0, 3);
+    fields[1] = CSV_DIGIT(0, 5) * 10 + CSV_DIGIT(0, 6);
+    fields[2] = CSV_DIGIT(1, 0) * 10 + CSV_DIGIT(1, 1);
+    fields[3] = CSV_DIGIT(1, 3) * 10 + CSV_DIGIT(1, 4);
+    fields[4] = CSV_DIGIT(1, 6) * 10 + CSV_DIGIT(1, 7);
+#undef CSV_DIGIT
+    return true;
+#else
+    if (c[4] != '-' || c[7] != '-' || (c[10] != 'T' && c[10] != ' ') || c[13] != ':')
+        return false;
+    fields[0] = csv_parse_fixed_digits(c, 4);
+    fields[1] = csv_parse_fixed_digits(c + 5, 2);
+    fields[2] = csv_parse_fixed_digits(c + 8, 2);
+    fields[3] = csv_parse_fixed_digits(c + 11, 2);
+    fields[4] = csv_parse_fixed_digits(c + 14, 2);
+    return fields[0] >= 0 && fields[1] >= 0 && fields[2] >= 0 && fields[3] >= 0 && fields[4] >= 0;
+#endif
+}
+
+// days from 1970-01-01 to a date of the proleptic Gregorian calendar (Howard Hinnant's days_from_civil)
+static int64_t csv_days_from_civil(int64_t year, int64_t month, int64_t day)
+{
+    year -= month <= 2;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t year_of_era = year - era * 400;
+    int64_t day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+}
+
+static bool csv_valid_date(int year, int month, int day)
+{
+    static const int days_in_month[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    if (month < 1 || month > 12 || day < 1)
+        return false;
+    bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    return day <= days_in_month[month - 1] + (month == 2 && leap);
+}
+
+// microseconds since the epoch of an ISO-8601 date or timestamp (see csv_column_to_timestamp()), or CSV_TIMESTAMP_INVALID
+static int64_t csv_parse_timestamp(const char* cell)
+{
+    const char* c = cell;
+    size_t len = strlen(cell);
+    if (len >= 2 && c[0] == '\"' && c[len - 1] == '\"')
+    {
+        c++;
+        len -= 2;
+    }
+
+    // fields are year, month, day, hour, minute
+    int fields[5] = { 0, 0, 0, 0, 0 };
+    size_t position;
+    if (len == 10)
+    {
+        fields[0] = csv_parse_fixed_digits(c, 4);
+        fields[1] = csv_parse_fixed_digits(c + 5, 2);
+        fields[2] = csv_parse_fixed_digits(c + 8, 2);
+        if (c[4] != '-' || c[7] != '-' || fields[0] < 0 || fields[1] < 0 || fields[2] < 0)
+            return CSV_TIMESTAMP_INVALID;
+        position = 10;
+    }
+    else if (len >= 16 && csv_parse_date_time_fields(c, fields))
+        position = 16;
+    else
+        return CSV_TIMESTAMP_INVALID;
+    if (!csv_valid_date(fields[0], fields[1], fields[2]) || fields[3] > 23 || fields[4] > 59)
+        return CSV_TIMESTAMP_INVALID;
+
+    int second = 0;
+    int64_t micros = 0;
+    int offset = 0;
+    if (position == 16)
+    {
+        if (position + 3 <= len && c[position] == ':')
+        {
+            second = csv_parse_fixed_digits(c + position + 1, 2);
+            if (second < 0 || second > 59)
+                return CSV_TIMESTAMP_INVALID;
+            position += 3;
+
+            if (position < len && (c[position] == '.' || c[position] == ','))
+            {
+                size_t n_digits = 0;
+                for (position++; position < len && c[position] >= '0' && c[position] <= '9'; ++position, ++n_digits)
+                    if (n_digits < 6)
+                        micros = micros * 10 + (c[position] - '0');
+                if (n_digits == 0)
+                    return CSV_TIMESTAMP_INVALID;
+                for (; n_digits < 6; ++n_digits)
+                    micros *= 10;
+            }
+        }
+
+        if (position < len && c[position] == 'Z')
+            position++;
+        else if (position < len && (c[position] == '+' || c[position] == '-'))
+        {
+            int sign = c[position] == '-' ? -1 : 1;
+            size_t remaining = len - position - 1;
+            const char* zone = c + position + 1;
+            int zone_hours = remaining >= 2 ? csv_parse_fixed_digits(zone, 2) : -1;
+            int zone_minutes = 0;
+            if (remaining == 4)
+                zone_minutes = csv_parse_fixed_digits(zone + 2, 2);
+            else if (remaining == 5 && zone[2] == ':')
+                zone_minutes = csv_parse_fixed_digits(zone + 3, 2);
+            else if (remaining != 2)
+                return CSV_TIMESTAMP_INVALID;
+            if (zone_hours < 0 || zone_hours > 23 || zone_minutes < 0 || zone_minutes > 59)
+                return CSV_TIMESTAMP_INVALID;
+            offset = sign * (zone_hours * 3600 + zone_minutes * 60);
+            position = len;
+        }
+    }
+    if (position != len)
+        return CSV_TIMESTAMP_INVALID;
+
+    int64_t seconds = csv_days_from_civil(fields[0], fields[1], fields[2]) * 86400 + fields[3] * 3600 + fields[4] * 60 + second - offset;
+    return seconds * 1000000 + micros;
+}
+
+typedef struct csv_cast_task
+{
+    char*** data;
+    char** column;
+    size_t n_rows;
+    size_t n_columns;
+    int** int_data;
+    float** float_data;
+    int* int_column;
+    float* float_column;
+    int64_t* timestamp_column;
+} csv_cast_task;
+
+static void csv_cast_int_rows(void* context, size_t block)
+{
+    csv_cast_task* task = context;
+    size_t end = (block + 1) * CSV_CAST_BLOCK < task->n_rows ? (block + 1) * CSV_CAST_BLOCK : task->n_rows;
+    for (size_t i = block * CSV_CAST_BLOCK; i < end; ++i)
+    {
+        task->int_data[i] = csv_malloc(sizeof(int) * task->n_columns);
+        for (size_t j = 0; j < task->n_columns; ++j)
+            task->int_data[i][j] = csv_parse_int(task->data[i][j]);
+    }
+}
+
+static void csv_cast_float_rows(void* context, size_t block)
+{
+    csv_cast_task* task = context;
+    size_t end = (block + 1) * CSV_CAST_BLOCK < task->n_rows ? (block + 1) * CSV_CAST_BLOCK : task->n_rows;
+    for (size_t i = block * CSV_CAST_BLOCK; i < end; ++i)
+    {
+        task->float_data[i] = csv_malloc(sizeof(float) * task->n_columns);
+        for (size_t j = 0; j < task->n_columns; ++j)
+            task->float_data[i][j] = csv_parse_float(task->data[i][j]);
+    }
+}
+
+static void csv_cast_int_cells(void* context, size_t block)
+{
+    csv_cast_task* task = context;
+    size_t end = (block + 1) * CSV_CAST_BLOCK < task->n_rows ? (block + 1) * CSV_CAST_BLOCK : task->n_rows;
+    for (size_t i = block * CSV_CAST_BLOCK; i < end; ++i)
+        task->int_column[i] = csv_parse_int(task->column[i]);
+}
+
+static void csv_cast_float_cells(void* context, size_t block)
+{
+    csv_cast_task* task = context;
+    size_t end = (block + 1) * CSV_CAST_BLOCK < task->n_rows ? (block + 1) * CSV_CAST_BLOCK : task->n_rows;
+    for (size_t i = block * CSV_CAST_BLOCK; i < end; ++i)
+        task->float_column[i] = csv_parse_float(task->column[i]);
+}
+
+static void csv_cast_timestamp_cells(void* context, size_t block)
+{
+    csv_cast_task* task = context;
+    size_t end = (block + 1) * CSV_CAST_BLOCK < task->n_rows ? (block + 1) * CSV_CAST_BLOCK : task->n_rows;
+    for (size_t i = block * CSV_CAST_BLOCK; i < end; ++i)
+        task->timestamp_column[i] = csv_parse_timestamp(task->column[i]);
+}
+
+void csv_data_to_int(char*** data, size_t data_dims[2], int*** int_data)
+{
+    csv_data_to_int_parallel(data, data_dims, int_data, 1);
+}
+
+void csv_data_to_float(char*** data, size_t data_dims[2], float*** float_data)
+{
+    csv_data_to_float_parallel(data, data_dims, float_data, 1);
+}
+
+void csv_column_to_int(char** data, size_t data_rows, int** int_data)
+{
+    csv_column_to_int_parallel(data, data_rows, int_data, 1);
 }
 
 void csv_column_to_float(char** data, size_t data_rows, float** float_data)
 {
-    // allocate necessary memory to store the integers
-    *float_data = malloc(sizeof(float) * data_rows);
+    csv_column_to_float_parallel(data, data_rows, float_data, 1);
+}
 
-    // cast values from string to int
-    char* end;
-    for (size_t i = 0; i < data_rows; ++i)
-        (*float_data)[i] = strtof(data[i], &end);
-}
\ No newline at end of file
+void csv_column_to_timestamp(char** data, size_t data_rows, int64_t** timestamp_data)
+{
+    csv_column_to_timestamp_parallel(data, data_rows, timestamp_data, 1);
+}
+
+void csv_data_to_int_parallel(char*** data, size_t data_dims[2], int*** int_data, size_t n_threads)
+{
+    // the row array is allocated here, the rows by whichever worker converts them
+    *int_data = csv_malloc(sizeof(int*) * data_dims[0]);
+
+    csv_cast_task task = { .data = data, .n_rows = data_dims[0], .n_columns = data_dims[1], .int_data = *int_data };
+    csv_parallel_for((data_dims[0] + CSV_CAST_BLOCK - 1) / CSV_CAST_BLOCK, n_threads, &csv_cast_int_rows, &task);
+}
+
+void csv_data_to_float_parallel(char*** data, size_t data_dims[2], float*** float_data, size_t n_threads)
+{
+    // the row array is allocated here, the rows by whichever worker converts them
+    *float_data = csv_malloc(sizeof(float*) * data_dims[0]);
+
+    csv_cast_task task = { .data = data, .n_rows = data_dims[0], .n_columns = data_dims[1], .float_data = *float_data };
+    csv_parallel_for((data_dims[0] + CSV_CAST_BLOCK - 1) / CSV_CAST_BLOCK, n_threads, &csv_cast_float_rows, &task);
+}
+
+void csv_column_to_int_parallel(char** data, size_t data_rows, int** int_data, size_t n_threads)
+{
+    *int_data = csv_malloc(sizeof(int) * data_rows);
+
+    csv_cast_task task = { .column = data, .n_rows = data_rows, .n_columns = 1, .int_column = *int_data };
+    csv_parallel_for((data_rows + CSV_CAST_BLOCK - 1) / CSV_CAST_BLOCK, n_threads, &csv_cast_int_cells, &task);
+}
+
+void csv_column_to_float_parallel(char** data, size_t data_rows, float** float_data, size_t n_threads)
+{
+    *float_data = csv_malloc(sizeof(float) * data_rows);
+
+    csv_cast_task task = { .column = data, .n_rows = data_rows, .n_columns = 1, .float_column = *float_data };
+    csv_parallel_for((data_rows + CSV_CAST_BLOCK - 1) / CSV_CAST_BLOCK, n_threads, &csv_cast_float_cells, &task);
+}
+
+void csv_column_to_timestamp_parallel(char** data, size_t data_rows, int64_t** timestamp_data, size_t n_threads)
+{
+    *timestamp_data = csv_malloc(sizeof(int64_t) * data_rows);
+
+    csv_cast_task task = { .column = data, .n_rows = data_rows, .n_columns = 1, .timestamp_column = *timestamp_data };
+    csv_parallel_for((data_rows + CSV_CAST_BLOCK - 1) / CSV_CAST_BLOCK, n_threads, &csv_cast_timestamp_cells, &task);
+}
@@ -0,0 +1,414 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#ifdef CSV_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef CSV_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "csvinternal.h"
+#include "compress/compress.h"
+#include "read/read.h"
+
+// the decompression thread fills these slots in turn and the reader drains them in the same order
+#define CSV_RING_SLOTS 4
+#define CSV_RING_SLOT_SIZE (1 << 20)
+#define CSV_INPUT_SIZE (1 << 18)
+
+typedef struct csv_decompressor
+{
+    int fd;
+    csv_compression compression;
+    unsigned char magic[4];
+    size_t magic_len;
+    char* input;
+
+    char* slots[CSV_RING_SLOTS];
+    size_t slot_len[CSV_RING_SLOTS];
+    bool slot_full[CSV_RING_SLOTS];
+    size_t produce;
+    size_t consume;
+    size_t consumed;
+    bool done;
+    bool failed;
+    bool stop;
+
+    pthread_mutex_t lock;
+    pthread_cond_t filled;
+    pthread_cond_t emptied;
+    pthread_t thread;
+} csv_decompressor;
+
+static csv_compression csv_compression_of(const unsigned char* magic, size_t len)
+{
+    if (len >= 2 && magic[0] == 0x1f && magic[1] == 0x8b)
+        return CSV_COMPRESSION_GZIP;
+    if (len >= 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd)
+        return CSV_COMPRESSION_ZSTD;
+    return CSV_COMPRESSION_NONE;
+}
+
+// reads up to 4 bytes from the start of fd into magic
+static size_t csv_read_magic(int fd, unsigned char* magic)
+{
+    size_t len = 0;
+    while (len < 4)
+    {
+        ssize_t n_read = read(fd, magic + len, 4 - len);
+        if (n_read > 0)
+            len += n_read;
+        else if (n_read == 0 || errno != EINTR)
+            break;
+    }
+    return len;
+}
+
+bool csv_compression_supported(csv_compression compression)
+{
+#ifdef CSV_HAVE_ZLIB
+    if (compression == CSV_COMPRESSION_GZIP)
+        return true;
+#endif
+#ifdef CSV_HAVE_ZSTD
+    if (compression == CSV_COMPRESSION_ZSTD)
+        return true;
+#endif
+    return compression == CSV_COMPRESSION_NONE;
+}
+
+csv_compression csv_detect_compression(const char* filename)
+{
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1)
+    {
+        printf("File not found!\n");
+        exit(-1);
+    }
+
+    unsigned char magic[4];
+    size_t len = csv_read_magic(fd, magic);
+    close(fd);
+    return csv_compression_of(magic, len);
+}
+
+// the next input bytes: first the magic bytes already read while detecting the format, then whatever read() returns
+// n is 0 at the end of the input; returns false on a read error
+static bool csv_decompressor_fill(csv_decompressor* decompressor, char* buffer, size_t capacity, size_t* n)
+{
+    if (decompressor->magic_len > 0)
+    {
+        memcpy(buffer, decompressor->magic, decompressor->magic_len);
+        *n = decompressor->magic_len;
+        decompressor->magic_len = 0;
+        return true;
+    }
+
+    for (;;)
+    {
+        ssize_t n_read = read(decompressor->fd, buffer, capacity);
+        if (n_read >= 0)
+        {
+            *n = n_read;
+            return true;
+        }
+        if (errno != EINTR)
+            return false;
+    }
+}
+
+// waits for the next slot to be drained by the reader; NULL once the source is being closed
+static char* csv_ring_acquire(csv_decompressor* decompressor)
+{
+    pthread_mutex_lock(&decompressor->lock);
+    while (decompressor->slot_full[decompressor->produce] && !decompressor->stop)
+        pthread_cond_wait(&decompressor->emptied, &decompressor->lock);
+    char* slot = decompressor->stop ? NULL : decompressor->slots[decompressor->produce];
+    pthread_mutex_unlock(&decompressor->lock);
+    return slot;
+}
+
+// hands the slot from csv_ring_acquire() to the reader with len bytes in it (an empty slot is simply reused)
+static void csv_ring_publish(csv_decompressor* decompressor, size_t len)
+{
+    if (len == 0)
+        return;
+    pthread_mutex_lock(&decompressor->lock);
+    decompressor->slot_len[decompressor->produce] = len;
+    decompressor->slot_full[decompressor->produce] = true;
+    decompressor->produce = (decompressor->produce + 1) % CSV_RING_SLOTS;
+    pthread_cond_signal(&decompressor->filled);
+    pthread_mutex_unlock(&decompressor->lock);
+}
+
+// uncompressed input is read straight into the slots
+static bool csv_decompress_none(csv_decompressor* decompressor)
+{
+    for (;;)
+    {
+        char* slot = csv_ring_acquire(decompressor);
+        if (slot == NULL)
+            return true;
+
+        size_t len = 0;
+        size_t n = 1;
+        while (len < CSV_RING_SLOT_SIZE && n > 0)
+        {
+            if (!csv_decompressor_fill(decompressor, slot + len, CSV_RING_SLOT_SIZE - len, &n))
+                return false;
+            len += n;
+        }
+        csv_ring_publish(decompressor, len);
+        if (n == 0)
+            return true;
+    }
+}
+
+#ifdef CSV_HAVE_ZLIB
+static bool csv_decompress_gzip(csv_decompressor* decompressor)
+{
+    // 15 + 32: largest window, gzip or zlib header detected
+    z_stream stream;
+    memset(&stream, 0, sizeof(z_stream));
+    if (inflateInit2(&stream, 15 + 32) != Z_OK)
+        return false;
+
+    bool ok = true;
+    bool in_member = false;
+    bool at_end = false;
+    while (ok && !at_end)
+    {
+        char* slot = csv_ring_acquire(decompressor);
+        if (slot == NULL)
+            break;
+
+        // each slot is filled completely so the reader is woken once per slot
+        stream.next_out = (Bytef*)slot;
+        stream.avail_out = CSV_RING_SLOT_SIZE;
+        while (stream.avail_out > 0)
+        {
+            if (stream.avail_in == 0)
+            {
+                size_t n;
+                ok = csv_decompressor_fill(decompressor, decompressor->input, CSV_INPUT_SIZE, &n);
+                if (!ok || n == 0)
+                {
+                    at_end = true;
+                    break;
+                }
+                stream.next_in = (Bytef*)decompressor->input;
+                stream.avail_in = n;
+            }
+
+            // concatenated members (e.g. from cat a.gz b.gz) are decompressed one after another
+            int result = inflate(&stream, Z_NO_FLUSH);
+            if (result == Z_STREAM_END)
+            {
+                in_member = false;
+                inflateReset(&stream);
+            }
+            else if (result == Z_OK)
+                in_member = true;
+            else
+            {
+                ok = false;
+                break;
+            }
+        }
+        csv_ring_publish(decompressor, CSV_RING_SLOT_SIZE - stream.avail_out);
+    }
+    inflateEnd(&stream);
+
+    // input that ends inside a member is truncated
+    return ok && !(at_end && in_member);
+}
+#endif
+
+#ifdef CSV_HAVE_ZSTD
+static bool csv_decompress_zstd(csv_decompressor* decompressor)
+{
+    ZSTD_DStream* stream = ZSTD_createDStream();
+    if (stream == NULL)
+        return false;
+    ZSTD_initDStream(stream);
+
+    ZSTD_inBuffer input = { decompressor->input, 0, 0 };
+    size_t remaining = 0;
+    bool ok = true;
+    bool at_end = false;
+    while (ok && !at_end)
+    {
+        char* slot = csv_ring_acquire(decompressor);
+        if (slot == NULL)
+            break;
+
+        ZSTD_outBuffer output = { slot, CSV_RING_SLOT_SIZE, 0 };
+        while (output.pos < output.size)
+        {
+            if (input.pos == input.size)
+            {
+                size_t n;
+                ok = csv_decompressor_fill(decompressor, decompressor->input, CSV_INPUT_SIZE, &n);
+                if (!ok || n == 0)
+                {
+                    at_end = true;
+                    break;
+                }
+                input.size = n;
+                input.pos = 0;
+            }
+
+            // 0 means a frame just ended; the next one (if any) starts with the following input
+            remaining = ZSTD_decompressStream(stream, &output, &input);
+            if (ZSTD_isError(remaining))
+            {
+                ok = false;
+                break;
+            }
+        }
+        csv_ring_publish(decompressor, output.pos);
+    }
+    ZSTD_freeDStream(stream);
+
+    // input that ends inside a frame is truncated
+    return ok && !(at_end && remaining != 0);
+}
+#endif
+
+static void* csv_decompressor_run(void* arg)
+{
+    csv_decompressor* decompressor = arg;
+    bool ok = true;
+
+    if (decompressor->compression == CSV_COMPRESSION_NONE)
+        ok = csv_decompress_none(decompressor);
+#ifdef CSV_HAVE_ZLIB
+    else if (decompressor->compression == CSV_COMPRESSION_GZIP)
+        ok = csv_decompress_gzip(decompressor);
+#endif
+#ifdef CSV_HAVE_ZSTD
+    else if (decompressor->compression == CSV_COMPRESSION_ZSTD)
+        ok = csv_decompress_zstd(decompressor);
+#endif
+
+    pthread_mutex_lock(&decompressor->lock);
+    decompressor->done = true;
+    decompressor->failed = !ok;
+    pthread_cond_signal(&decompressor->filled);
+    pthread_mutex_unlock(&decompressor->lock);
+    return NULL;
+}
+
+size_t csv_decompressor_read(csv_decompressor* decompressor, char* buffer, size_t capacity)
+{
+    pthread_mutex_lock(&decompressor->lock);
+    while (!decompressor->slot_full[decompressor->consume] && !decompressor->done)
+        pthread_cond_wait(&decompressor->filled, &decompressor->lock);
+    bool available = decompressor->slot_full[decompressor->consume];
+    bool failed = decompressor->failed;
+    pthread_mutex_unlock(&decompressor->lock);
+
+    // everything decompressed before an error is still handed out first
+    if (!available)
+    {
+        if (failed)
+        {
+            printf("Could not decompress input!\n");
+            exit(-1);
+        }
+        return 0;
+    }
+
+    // a full slot belongs to the reader until it is marked empty again
+    size_t slot = decompressor->consume;
+    size_t n = decompressor->slot_len[slot] - decompressor->consumed;
+    if (n > capacity)
+        n = capacity;
+    memcpy(buffer, decompressor->slots[slot] + decompressor->consumed, n);
+    decompressor->consumed += n;
+
+    if (decompressor->consumed == decompressor->slot_len[slot])
+    {
+        pthread_mutex_lock(&decompressor->lock);
+        decompressor->slot_full[slot] = false;
+        decompressor->consume = (slot + 1) % CSV_RING_SLOTS;
+        decompressor->consumed = 0;
+        pthread_cond_signal(&decompressor->emptied);
+        pthread_mutex_unlock(&decompressor->lock);
+    }
+    return n;
+}
+
+csv_source csv_source_from_compressed_fd(int fd)
+{
+    csv_decompressor* decompressor = csv_calloc(1, sizeof(csv_decompressor));
+    decompressor->fd = fd;
+
+    // the format is detected here so an unsupported one is reported before any parsing
+    decompressor->magic_len = csv_read_magic(fd, decompressor->magic);
+    decompressor->compression = csv_compression_of(decompressor->magic, decompressor->magic_len);
+    if (!csv_compression_supported(decompressor->compression))
+    {
+        printf("Compressed input is not supported by this build!\n");
+        exit(-1);
+    }
+
+    // buffers are allocated on the calling thread so csv_source_close() frees them with the same allocator
+    decompressor->input = csv_malloc(CSV_INPUT_SIZE);
+    for (size_t s = 0; s < CSV_RING_SLOTS; ++s)
+        decompressor->slots[s] = csv_malloc(CSV_RING_SLOT_SIZE);
+    pthread_mutex_init(&decompressor->lock, NULL);
+    pthread_cond_init(&decompressor->filled, NULL);
+    pthread_cond_init(&decompressor->emptied, NULL);
+    if (pthread_create(&decompressor->thread, NULL, &csv_decompressor_run, decompressor) != 0)
+    {
+        printf("Could not start decompression thread!\n");
+        exit(-1);
+    }
+
+    csv_source source = csv_source_from_fd(fd);
+    source.kind = CSV_SOURCE_COMPRESSED;
+    source.decompressor = decompressor;
+    return source;
+}
+
+void csv_source_close(csv_source* source)
+{
+    if (source->kind != CSV_SOURCE_COMPRESSED || source->decompressor == NULL)
+        return;
+
+    // a thread waiting for a free slot stops at once; one inside read() stops when the read returns
+    csv_decompressor* decompressor = source->decompressor;
+    pthread_mutex_lock(&decompressor->lock);
+    decompressor->stop = true;
+    pthread_cond_signal(&decompressor->emptied);
+    pthread_mutex_unlock(&decompressor->lock);
+    pthread_join(decompressor->thread, NULL);
+
+    pthread_mutex_destroy(&decompressor->lock);
+    pthread_cond_destroy(&decompressor->filled);
+    pthread_cond_destroy(&decompressor->emptied);
+    for (size_t s = 0; s < CSV_RING_SLOTS; ++s)
+        csv_dealloc(decompressor->slots[s]);
+    csv_dealloc(decompressor->input);
+    csv_dealloc(decompressor);
+    source->decompressor = NULL;
+}
+
+void csv_read_compressed(const char* filename, char**** data, size_t (*data_dims)[2], char delim, bool has_headers)
+{
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1)
+    {
+        printf("File not found!\n");
+        exit(-1);
+    }
+
+    csv_source source = csv_source_from_compressed_fd(fd);
+    csv_read_from(&source, data, data_dims, delim, has_headers);
+    csv_source_close(&source);
+    close(fd);
+}
@@ -1,11 +1,15 @@
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "csvinternal.h"
 
-size_t csv_count_columns(const char* line, char delim)
+size_t csv_count_columns_n(const char* line, size_t len, char delim)
 {
     size_t delim_count = 0;
     bool inside_quotes = false;
 
-    for (size_t i = 0; i < strlen(line); ++i)
+    for (size_t i = 0; i < len; ++i)
     {
         if (line[i] == '\"')
             inside_quotes = !inside_quotes;
@@ -17,83 +21,658 @@ size_t csv_count_columns(const char* line, char delim)
     return delim_count + 1; // + 1 since no delimiter at end of string
 }
 
-size_t csv_parse_line(const char* line, char delim, char*** tokens)
+size_t csv_count_columns(const char* line, char delim)
 {
-    size_t current_col = 0;
-    char* parsed_value = NULL;
-    size_t parsed_value_alloc_size = 0;
+    return csv_count_columns_n(line, strlen(line), delim);
+}
+
+// copies a token out of the line, spelling empty tokens as "(null)"
+static char* csv_copy_token(const char* token, size_t len)
+{
+    if (len == 0)
+        return csv_strdup("(null)");
+
+    char* copy = csv_malloc(len + 1);
+    memcpy(copy, token, len);
+    copy[len] = 0;
+    return copy;
+}
 
+size_t csv_parse_line_n(const char* line, size_t len, char delim, char*** tokens)
+{
+    size_t current_col = 0;
+    size_t token_start = 0;
     bool inside_quotes = false;
 
-    size_t delim_count = csv_count_columns(line, delim);
+    size_t delim_count = csv_count_columns_n(line, len, delim);
 
-    (*tokens) = malloc(sizeof(char*) * delim_count);
+    (*tokens) = csv_malloc(sizeof(char*) * delim_count);
 
-    for (size_t i = 0; i < strlen(line); ++i)
+    for (size_t i = 0; i < len; ++i)
     {
         if (line[i] == '\"')
             inside_quotes = !inside_quotes;
 
-        if (line[i] != delim || (line[i] == delim && inside_quotes))
+        if (line[i] == delim && !inside_quotes)
         {
-            if (parsed_value == NULL)
+            (*tokens)[current_col] = csv_copy_token(&line[token_start], i - token_start);
+            token_start = i + 1;
+            current_col++;
+        }
+    }
+
+    // no delimiter at end of string so the last token runs to the end of the line,
+    // minus the trailing \n (a token that is only \n, e.g. val1,val2,\n, is empty)
+    const char* last_token = &line[token_start];
+    size_t last_len = len - token_start;
+    const char* newline = memchr(last_token, '\n', last_len);
+    if (newline != NULL)
+        last_len = newline - last_token;
+    (*tokens)[current_col] = csv_copy_token(last_token, last_len);
+
+    return delim_count;
+}
+
+size_t csv_parse_line(const char* line, char delim, char*** tokens)
+{
+    return csv_parse_line_n(line, strlen(line), delim, tokens);
+}
+
+void csv_reader_init(csv_reader* reader, const csv_source* source)
+{
+    reader->source = source;
+    reader->position = 0;
+    reader->chunk = NULL;
+    reader->chunk_start = 0;
+    reader->chunk_end = 0;
+    reader->chunk_capacity = 0;
+    reader->eof = false;
+    reader->last_line = NULL;
+    reader->last_len = 0;
+    reader->replay = false;
+    reader->line_number = 0;
+    reader->consumed = 0;
+    reader->utf8_delim = ',';
+    reader->utf8_error = NULL;
+    reader->record = NULL;
+    reader->record_capacity = 0;
+}
+
+// file descriptors are read in large chunks; lines are handed out from the chunk without copying
+static bool csv_reader_next_fd(csv_reader* reader, const char** line, size_t* len)
+{
+    for (;;)
+    {
+        char* start = reader->chunk + reader->chunk_start;
+        size_t available = reader->chunk_end - reader->chunk_start;
+        char* newline = available > 0 ? memchr(start, '\n', available) : NULL;
+        if (newline != NULL || (reader->eof && available > 0))
+        {
+            *line = start;
+            *len = newline != NULL ? (size_t)(newline - start) + 1 : available;
+            reader->chunk_start += *len;
+            return true;
+        }
+        if (reader->eof)
+            return false;
+
+        // move the partial line to the front and grow the chunk if the line fills it
+        if (available > 0)
+            memmove(reader->chunk, start, available);
+        reader->chunk_start = 0;
+        reader->chunk_end = available;
+        if (reader->chunk_end == reader->chunk_capacity)
+        {
+            reader->chunk_capacity = reader->chunk_capacity == 0 ? 65536 : reader->chunk_capacity * 2;
+            reader->chunk = realloc(reader->chunk, reader->chunk_capacity);
+        }
+
+        ssize_t n_read;
+        if (reader->source->kind == CSV_SOURCE_COMPRESSED)
+            n_read = csv_decompressor_read(reader->source->decompressor, reader->chunk + reader->chunk_end, reader->chunk_capacity - reader->chunk_end);
+        else
+            n_read = read(reader->source->fd, reader->chunk + reader->chunk_end, reader->chunk_capacity - reader->chunk_end);
+        if (n_read > 0)
+            reader->chunk_end += n_read;
+        else if (n_read == 0 || errno != EINTR)
+            reader->eof = true;
+    }
+}
+
+static bool csv_reader_read(csv_reader* reader, const char** line, size_t* len)
+{
+    const csv_source* source = reader->source;
+
+    if (source->kind == CSV_SOURCE_BUFFER)
+    {
+        if (reader->position >= source->buffer_size)
+            return false;
+
+        const char* start = source->buffer + reader->position;
+        size_t remaining = source->buffer_size - reader->position;
+        const char* newline = memchr(start, '\n', remaining);
+        *line = start;
+        *len = newline != NULL ? (size_t)(newline - start) + 1 : remaining;
+        reader->position += *len;
+        return true;
+    }
+    else if (source->kind == CSV_SOURCE_STREAM)
+    {
+        ssize_t read = getline(&reader->chunk, &reader->chunk_capacity, source->file);
+        if (read == -1)
+            return false;
+        *line = reader->chunk;
+        *len = read;
+        return true;
+    }
+
+    return csv_reader_next_fd(reader, line, len);
+}
+
+bool csv_reader_next(csv_reader* reader, const char** line, size_t* len)
+{
+    if (reader->replay)
+    {
+        reader->replay = false;
+        *line = reader->last_line;
+        *len = reader->last_len;
+        return true;
+    }
+
+    // after an invalid line the input counts as ended
+    if ((reader->utf8_error != NULL && reader->utf8_error->found) || !csv_reader_read(reader, line, len))
+        return false;
+
+    // a byte order mark is not part of the first line
+    size_t line_offset = reader->consumed;
+    reader->consumed += *len;
+    if (reader->line_number++ == 0)
+    {
+        size_t bom = csv_bom_length(*line, *len);
+        *line += bom;
+        *len -= bom;
+        line_offset += bom;
+    }
+
+    if (reader->utf8_error != NULL)
+    {
+        size_t invalid = csv_utf8_validate(*line, *len);
+        if (invalid < *len)
+        {
+            // the column is the number of unquoted delimiters before the invalid byte
+            csv_utf8_error* error = reader->utf8_error;
+            error->found = true;
+            error->line = reader->line_number;
+            error->column = 0;
+            error->offset = line_offset + invalid;
+            bool inside_quotes = false;
+            for (size_t i = 0; i < invalid; ++i)
             {
-                parsed_value = calloc(11, 1); // allocate 10 characters + \0 initially
-                strncat(parsed_value, &line[i], 1);
-                parsed_value_alloc_size = 10;
+                if ((*line)[i] == '\"')
+                    inside_quotes = !inside_quotes;
+                else if ((*line)[i] == reader->utf8_delim && !inside_quotes)
+                    error->column++;
             }
-            else
+            return false;
+        }
+    }
+
+    reader->last_line = *line;
+    reader->last_len = *len;
+    return true;
+}
+
+void csv_reader_validate_utf8(csv_reader* reader, char delim, csv_utf8_error* error)
+{
+    reader->utf8_delim = delim;
+    reader->utf8_error = error;
+    error->found = false;
+    error->line = 0;
+    error->column = 0;
+    error->offset = 0;
+}
+
+void csv_reader_unread(csv_reader* reader)
+{
+    if (reader->last_line != NULL)
+        reader->replay = true;
+}
+
+// true if a line leaves a quoted field open, given whether one was open before it; "" toggles twice so it needs no special case
+static bool csv_quote_open_after(const char* line, size_t len, bool open)
+{
+    const char* end = line + len;
+    const char* quote = memchr(line, '\"', len);
+    while (quote != NULL)
+    {
+        open = !open;
+        quote = memchr(quote + 1, '\"', end - quote - 1);
+    }
+    return open;
+}
+
+bool csv_reader_next_record(csv_reader* reader, const char** record, size_t* len)
+{
+    if (!csv_reader_next(reader, record, len))
+        return false;
+    if (!csv_quote_open_after(*record, *len, false))
+        return true;
+
+    // the line is only valid until the next read, so the record is joined in the reader's buffer
+    size_t record_len = 0;
+    const char* line = *record;
+    size_t line_len = *len;
+    bool open = true;
+    for (;;)
+    {
+        if (record_len + line_len > reader->record_capacity)
+        {
+            reader->record_capacity = record_len + line_len > reader->record_capacity * 2 ? record_len + line_len : reader->record_capacity * 2;
+            reader->record = csv_realloc(reader->record, reader->record_capacity);
+        }
+        memcpy(reader->record + record_len, line, line_len);
+        record_len += line_len;
+
+        // an unterminated quote runs to the end of the input
+        if (!open || !csv_reader_next(reader, &line, &line_len))
+            break;
+        open = csv_quote_open_after(line, line_len, open);
+    }
+
+    *record = reader->record;
+    *len = record_len;
+    return true;
+}
+
+size_t csv_parse_record(const char* record, size_t len, char delim, char*** tokens)
+{
+    if (len > 0 && record[len - 1] == '\n')
+        len--;
+    if (len > 0 && record[len - 1] == '\r')
+        len--;
+
+    // plain records keep the line parser's speed
+    if (memchr(record, '\"', len) == NULL)
+        return csv_parse_line_n(record, len, delim, tokens);
+
+    size_t n_tokens = csv_count_columns_n(record, len, delim);
+    (*tokens) = csv_malloc(sizeof(char*) * n_tokens);
+    size_t current_col = 0;
+    size_t i = 0;
+    for (;;)
+    {
+        size_t field_start = i;
+        bool has_quote = false;
+        bool inside_quotes = false;
+        while (i < len && (record[i] != delim || inside_quotes))
+        {
+            if (record[i] == '\"')
             {
-                if (strlen(parsed_value) > parsed_value_alloc_size - 1)
-                {
-                    parsed_value_alloc_size *= 2;
-                    parsed_value = realloc(parsed_value, parsed_value_alloc_size + 1);
-                }
+                inside_quotes = !inside_quotes;
+                has_quote = true;
+            }
+            i++;
+        }
 
-                strncat(parsed_value, &line[i], 1);
+        // fields without quotes are copied as they are; only the others are unescaped
+        if (!has_quote)
+            (*tokens)[current_col] = csv_copy_token(record + field_start, i - field_start);
+        else
+        {
+            char* field = csv_malloc(i - field_start + 1);
+            size_t field_len = 0;
+            inside_quotes = false;
+            for (size_t j = field_start; j < i; ++j)
+            {
+                if (record[j] != '\"')
+                    field[field_len++] = record[j];
+                else if (inside_quotes && j + 1 < i && record[j + 1] == '\"')
+                    field[field_len++] = record[j++];
+                else
+                    inside_quotes = !inside_quotes;
+            }
+            field[field_len] = 0;
+            if (field_len == 0)
+            {
+                csv_dealloc(field);
+                field = csv_strdup("(null)");
             }
+            (*tokens)[current_col] = field;
         }
-        else if (line[i] == delim && !inside_quotes)
+        current_col++;
+
+        if (i >= len)
+            break;
+        i++;
+    }
+
+    return current_col;
+}
+
+void csv_reader_free(csv_reader* reader)
+{
+    free(reader->chunk);
+    reader->chunk = NULL;
+    reader->chunk_capacity = 0;
+    csv_dealloc(reader->record);
+    reader->record = NULL;
+    reader->record_capacity = 0;
+}
+
+size_t csv_reader_header(csv_reader* reader, char delim, char*** columns)
+{
+    const char* line;
+    size_t len;
+    (*columns) = NULL;
+    if (!csv_reader_next(reader, &line, &len))
+        return 0;
+    return csv_parse_line_n(line, csv_header_length(line, len), delim, columns);
+}
+
+void csv_select_rows(csv_reader* reader, const size_t* column_indices, size_t n_columns, char**** data, size_t (*data_dims)[2], char delim)
+{
+    const char* line;
+    size_t len;
+    char** tokens = NULL;
+
+    // start with allocating memory for 10 lines, then double each time capacity is reached
+    size_t row_allocation_size = 10;
+    (*data) = csv_calloc(row_allocation_size, sizeof(char**));
+    size_t current_row = 0;
+
+    while (csv_reader_next(reader, &line, &len))
+    {
+        size_t n_tokens = csv_parse_line_n(line, len, delim, &tokens);
+
+        // move the selected tokens into the row and free the rest
+        (*data)[current_row] = csv_malloc(sizeof(char*) * (n_columns > 0 ? n_columns : 1));
+        for (size_t c = 0; c < n_columns; ++c)
         {
-            if (parsed_value != NULL)
+            if (column_indices[c] < n_tokens)
             {
-                (*tokens)[current_col] = strdup(parsed_value);
-                free(parsed_value);
-                parsed_value = NULL;
+                (*data)[current_row][c] = tokens[column_indices[c]];
+                tokens[column_indices[c]] = NULL;
             }
             else
-                (*tokens)[current_col] = strdup("(null)");
+                (*data)[current_row][c] = csv_strdup("(null)");
+        }
+        for (size_t i = 0; i < n_tokens; ++i)
+            csv_dealloc(tokens[i]);
+        csv_dealloc(tokens);
+        tokens = NULL;
 
-            parsed_value_alloc_size = 0;
-            current_col++;
+        current_row++;
+        if (current_row >= row_allocation_size)
+        {
+            row_allocation_size *= 2;
+            (*data) = csv_realloc((*data), sizeof(char**) * row_allocation_size);
         }
     }
 
-    // no delimiter at end of string so we check if parsed_value still contains content
-    if (parsed_value != NULL && strlen(parsed_value) > 0)
+    (*data_dims)[0] = current_row;
+    (*data_dims)[1] = n_columns;
+}
+
+size_t csv_split_line(char* line, char delim, char** fields, size_t max_fields)
+{
+    size_t field_count = 0;
+    bool inside_quotes = false;
+    char* field_start = line;
+
+    // trim the trailing newline left over from getline()
+    line[strcspn(line, "\n")] = 0;
+
+    for (char* c = line; ; ++c)
     {
-        // remove trailing \n from input (unless it's the only remaining character left)
-        // e.g. in the case of val1,val2, (trailing comma at end)
-        if (strcmp(parsed_value, "\n") == 0)
+        if (*c == '\"')
+            inside_quotes = !inside_quotes;
+
+        if (*c == 0 || (*c == delim && !inside_quotes))
         {
-            (*tokens)[current_col] = strdup("(null)");
-            free(parsed_value);
-            parsed_value = NULL;
+            bool end_of_line = *c == 0;
+            *c = 0;
+            if (field_count < max_fields)
+                fields[field_count] = field_start;
+            field_count++;
+            field_start = c + 1;
+
+            if (end_of_line)
+                break;
         }
-        else
+    }
+
+    return field_count;
+}
+
+size_t csv_bom_length(const char* line, size_t len)
+{
+    return len >= 3 && memcmp(line, "\xEF\xBB\xBF", 3) == 0 ? 3 : 0;
+}
+
+size_t csv_header_length(const char* line, size_t len)
+{
+    if (len > 0 && line[len - 1] == '\n')
+        len--;
+    if (len > 0 && line[len - 1] == '\r')
+        len--;
+    return len;
+}
+
+size_t csv_skip_bom(FILE* file)
+{
+    char start[3];
+    size_t bom = csv_bom_length(start, fread(start, 1, 3, file));
+    fseek(file, bom, SEEK_SET);
+    return bom;
+}
+
+bool csv_find_cell(const char* line, size_t len, char delim, size_t column_index, const char** cell, size_t* cell_len)
+{
+    if (len > 0 && line[len - 1] == '\n')
+        len--;
+
+    bool inside_quotes = false;
+    size_t column = 0;
+    size_t start = 0;
+    for (size_t i = 0; i <= len; ++i)
+    {
+        if (i < len)
+        {
+            if (line[i] == '\"')
+                inside_quotes = !inside_quotes;
+            if (line[i] != delim || inside_quotes)
+                continue;
+        }
+        if (column == column_index)
         {
-            parsed_value[strcspn(parsed_value, "\n")] = 0;
-            (*tokens)[current_col] = strdup(parsed_value);
-            free(parsed_value);
-            parsed_value = NULL;
+            *cell = line + start;
+            *cell_len = i - start;
+            return true;
         }
+        column++;
+        start = i + 1;
     }
-    else if (parsed_value == NULL)
+    return false;
+}
+
+size_t csv_find_columns(FILE* file, char delim, char** column_names, size_t n_columns, size_t* column_indices)
+{
+    char* line = NULL;
+    size_t len = 0;
+    size_t n_header = 0;
+    char** header = NULL;
+
+    if (getline(&line, &len, file) != -1)
     {
-        (*tokens)[current_col] = strdup("(null)");
+        char* start = line + csv_bom_length(line, strlen(line));
+        start[csv_header_length(start, strlen(start))] = 0;
+        n_header = csv_count_columns(start, delim);
+        header = csv_malloc(sizeof(char*) * n_header);
+        n_header = csv_split_line(start, delim, header, n_header);
     }
 
-    return delim_count;
+    for (size_t c = 0; c < n_columns; ++c)
+    {
+        column_indices[c] = SIZE_MAX;
+        for (size_t i = 0; i < n_header; ++i)
+            if (strcmp(header[i], column_names[c]) == 0)
+            {
+                column_indices[c] = i;
+                break;
+            }
+    }
+
+    csv_dealloc(header);
+    free(line);
+    return n_header;
+}
+
+// blocks are at least this large; bigger requests get a block of their own
+#define CSV_ARENA_BLOCK_SIZE 65536
+
+struct csv_arena_block
+{
+    struct csv_arena_block* next;
+    size_t used;
+    size_t capacity;
+    char data[];
+};
+
+void* csv_arena_alloc(csv_arena* arena, size_t size)
+{
+    // keep every allocation pointer-aligned
+    size = (size + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+
+    struct csv_arena_block* block = arena->head;
+    if (block == NULL || block->capacity - block->used < size)
+    {
+        size_t capacity = size > CSV_ARENA_BLOCK_SIZE ? size : CSV_ARENA_BLOCK_SIZE;
+        block = csv_malloc(sizeof(struct csv_arena_block) + capacity);
+        block->used = 0;
+        block->capacity = capacity;
+        block->next = arena->head;
+        arena->head = block;
+    }
+
+    void* ptr = block->data + block->used;
+    block->used += size;
+    return ptr;
+}
+
+char* csv_arena_strdup(csv_arena* arena, const char* value)
+{
+    size_t len = strlen(value) + 1;
+    char* copy = csv_arena_alloc(arena, len);
+    memcpy(copy, value, len);
+    return copy;
+}
+
+void csv_arena_free(csv_arena* arena)
+{
+    struct csv_arena_block* block = arena->head;
+    while (block != NULL)
+    {
+        struct csv_arena_block* next = block->next;
+        csv_dealloc(block);
+        block = next;
+    }
+    arena->head = NULL;
+}
+
+void csv_hash_table_init(csv_hash_table* table, size_t capacity)
+{
+    table->slots = csv_calloc(capacity, sizeof(csv_hash_slot));
+    table->capacity = capacity;
+    table->count = 0;
+}
+
+size_t csv_hash_table_start(const csv_hash_table* table, uint64_t hash)
+{
+    return hash & (table->capacity - 1);
+}
+
+size_t csv_hash_table_next(const csv_hash_table* table, uint64_t hash, size_t* pos)
+{
+    while (table->slots[*pos].index != 0)
+    {
+        const csv_hash_slot* slot = &table->slots[*pos];
+        *pos = (*pos + 1) & (table->capacity - 1);
+        if (slot->hash == hash)
+            return slot->index - 1;
+    }
+    return SIZE_MAX;
+}
+
+static void csv_hash_table_grow(csv_hash_table* table)
+{
+    size_t new_capacity = table->capacity * 2;
+    csv_hash_slot* new_slots = csv_calloc(new_capacity, sizeof(csv_hash_slot));
+
+    // the stored hashes mean rehashing never touches the keys
+    for (size_t i = 0; i < table->capacity; ++i)
+    {
+        if (table->slots[i].index == 0)
+            continue;
+
+        size_t pos = table->slots[i].hash & (new_capacity - 1);
+        while (new_slots[pos].index != 0)
+            pos = (pos + 1) & (new_capacity - 1);
+        new_slots[pos] = table->slots[i];
+    }
+
+    csv_dealloc(table->slots);
+    table->slots = new_slots;
+    table->capacity = new_capacity;
+}
+
+void csv_hash_table_insert(csv_hash_table* table, uint64_t hash, size_t pos, size_t index)
+{
+    table->slots[pos].hash = hash;
+    table->slots[pos].index = index + 1;
+    table->count++;
+
+    // keep the load factor at or below 1/2 so probe sequences stay short
+    if (table->count * 2 > table->capacity)
+        csv_hash_table_grow(table);
+}
+
+void csv_hash_table_free(csv_hash_table* table)
+{
+    csv_dealloc(table->slots);
+    table->slots = NULL;
+    table->capacity = 0;
+    table->count = 0;
+}
+
+int csv_create_temp_file(const char* path, char** tmp_path)
+{
+    (*tmp_path) = csv_malloc(strlen(path) + 16);
+    sprintf(*tmp_path, "%s.tmp.XXXXXX", path);
+    int fd = mkstemp(*tmp_path);
+
+    // mkstemp() creates the file for the owner only; a sidecar is as readable as a file written with fopen()
+    if (fd != -1)
+        fchmod(fd, 0644);
+    return fd;
+}
+
+uint64_t csv_hash(const void* data, size_t len, uint64_t seed)
+{
+    const unsigned char* bytes = data;
+    uint64_t hash = 0xcbf29ce484222325ULL ^ seed;
+    for (size_t i = 0; i < len; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+
+    // FNV-1a alone mixes the high bits poorly, which open addressing tables and sketches rely on
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
 }
 
 size_t csv_get_column_names(const char* filename, char delim, char*** columns)
@@ -102,15 +681,16 @@ size_t csv_get_column_names(const char* filename, char delim, char*** columns)
     char* line = NULL;
     size_t len = 0;
     FILE* file = fopen(filename, "r");
+    (*columns) = NULL;
     if (file == NULL)
+        return 0;
+
+    if (getline(&line, &len, file) != -1)
     {
-        printf("File not found!\n");
-        exit(-1);
+        char* start = line + csv_bom_length(line, strlen(line));
+        column_count = csv_parse_line_n(start, csv_header_length(start, strlen(start)), delim, columns);
     }
-
-    getline(&line, &len, file);
-    column_count = csv_parse_line(line, delim, columns);
     free(line);
     fclose(file);
     return column_count;
-}
\ No newline at end of file
+}
@@ -0,0 +1,148 @@
+#include <pthread.h>
+#include <unistd.h>
+
+#include "csvinternal.h"
+#include "alloc/alloc.h"
+
+// a worker's remaining share of task indices: [begin, end)
+// the owner takes from the front, thieves take from the back
+typedef struct csv_pool_deque
+{
+    pthread_mutex_t lock;
+    size_t begin;
+    size_t end;
+} csv_pool_deque;
+
+typedef struct csv_pool
+{
+    csv_pool_deque* deques;
+    size_t n_threads;
+    void (*task)(void* context, size_t index);
+    void* context;
+    csv_allocator allocator;
+} csv_pool;
+
+typedef struct csv_pool_worker
+{
+    csv_pool* pool;
+    size_t id;
+} csv_pool_worker;
+
+size_t csv_thread_count(size_t requested)
+{
+    if (requested > 0)
+        return requested;
+
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    return online > 0 ? (size_t)online : 1;
+}
+
+static bool csv_pool_pop(csv_pool_deque* deque, size_t* index)
+{
+    bool found = false;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->begin < deque->end)
+    {
+        *index = deque->begin++;
+        found = true;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+static bool csv_pool_steal(csv_pool_deque* deque, size_t* index)
+{
+    bool found = false;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->begin < deque->end)
+    {
+        *index = --deque->end;
+        found = true;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+static void* csv_pool_run(void* arg)
+{
+    csv_pool_worker* worker = arg;
+    csv_pool* pool = worker->pool;
+    size_t index;
+
+    // cells parsed on a worker are freed by the caller, so workers allocate the way the calling thread does
+    if (worker->id != 0)
+        csv_set_thread_allocator(&pool->allocator);
+
+    for (;;)
+    {
+        if (csv_pool_pop(&pool->deques[worker->id], &index))
+        {
+            pool->task(pool->context, index);
+            continue;
+        }
+
+        // own share is done: look for work in the other deques, starting with the next one
+        bool stolen = false;
+        for (size_t i = 1; i < pool->n_threads && !stolen; ++i)
+            stolen = csv_pool_steal(&pool->deques[(worker->id + i) % pool->n_threads], &index);
+
+        // tasks never create more tasks, so once every deque is empty we are done
+        if (!stolen)
+            break;
+        pool->task(pool->context, index);
+    }
+
+    return NULL;
+}
+
+void csv_parallel_for(size_t n_tasks, size_t n_threads, void (*task)(void* context, size_t index), void* context)
+{
+    n_threads = csv_thread_count(n_threads);
+    if (n_threads > n_tasks)
+        n_threads = n_tasks;
+
+    // nothing to share: run inline without creating threads
+    if (n_threads <= 1)
+    {
+        for (size_t i = 0; i < n_tasks; ++i)
+            task(context, i);
+        return;
+    }
+
+    csv_pool pool;
+    pool.n_threads = n_threads;
+    pool.task = task;
+    pool.context = context;
+    pool.allocator = *csv_get_allocator();
+    pool.deques = csv_malloc(sizeof(csv_pool_deque) * n_threads);
+
+    csv_pool_worker* workers = csv_malloc(sizeof(csv_pool_worker) * n_threads);
+    pthread_t* threads = csv_malloc(sizeof(pthread_t) * n_threads);
+
+    for (size_t t = 0; t < n_threads; ++t)
+    {
+        pthread_mutex_init(&pool.deques[t].lock, NULL);
+        pool.deques[t].begin = n_tasks * t / n_threads;
+        pool.deques[t].end = n_tasks * (t + 1) / n_threads;
+        workers[t].pool = &pool;
+        workers[t].id = t;
+    }
+
+    // the calling thread works as worker 0
+    size_t started = 1;
+    for (size_t t = 1; t < n_threads; ++t)
+        if (pthread_create(&threads[t], NULL, &csv_pool_run, &workers[t]) == 0)
+            started++;
+        else
+            break;
+    csv_pool_run(&workers[0]);
+
+    for (size_t t = 1; t < started; ++t)
+        pthread_join(threads[t], NULL);
+
+    for (size_t t = 0; t < n_threads; ++t)
+        pthread_mutex_destroy(&pool.deques[t].lock);
+    csv_dealloc(threads);
+    csv_dealloc(workers);
+    csv_dealloc(pool.deques);
+}
@@ -0,0 +1,217 @@
+#include "csvinternal.h"
+#include "dict/dict.h"
+
+// per-column state that only exists while the file is being parsed
+typedef struct csv_dict_builder
+{
+    csv_hash_table codes; // finds the code of a value already in the dictionary
+    size_t value_capacity;
+    size_t row_capacity;
+} csv_dict_builder;
+
+static void csv_dict_init(csv_dict_column* column, csv_dict_builder* builder)
+{
+    column->n_values = 0;
+    column->n_rows = 0;
+    column->code_size = sizeof(uint8_t);
+    column->arena = csv_malloc(sizeof(csv_arena));
+    column->arena->head = NULL;
+
+    csv_hash_table_init(&builder->codes, 64);
+    builder->value_capacity = 16;
+    column->values = csv_malloc(sizeof(char*) * builder->value_capacity);
+    builder->row_capacity = 1024;
+    column->codes = csv_malloc(column->code_size * builder->row_capacity);
+}
+
+// re-encodes every code with the next wider integer type once the dictionary outgrows the current one
+static void csv_dict_widen(csv_dict_column* column, csv_dict_builder* builder)
+{
+    size_t new_size = column->code_size * 2;
+    void* codes = csv_malloc(new_size * builder->row_capacity);
+
+    for (size_t r = 0; r < column->n_rows; ++r)
+    {
+        uint32_t code = csv_dict_code(column, r);
+        if (new_size == sizeof(uint16_t))
+            ((uint16_t*)codes)[r] = (uint16_t)code;
+        else
+            ((uint32_t*)codes)[r] = code;
+    }
+
+    csv_dealloc(column->codes);
+    column->codes = codes;
+    column->code_size = new_size;
+}
+
+static uint32_t csv_dict_intern(csv_dict_column* column, csv_dict_builder* builder, const char* cell)
+{
+    size_t len = strlen(cell);
+    uint64_t hash = csv_hash(cell, len, 0);
+
+    size_t pos = csv_hash_table_start(&builder->codes, hash);
+    size_t found;
+    while ((found = csv_hash_table_next(&builder->codes, hash, &pos)) != SIZE_MAX)
+        if (strcmp(column->values[found], cell) == 0)
+            return (uint32_t)found;
+
+    // first time this value is seen: copy it once into the arena
+    if (column->n_values >= builder->value_capacity)
+    {
+        builder->value_capacity *= 2;
+        column->values = csv_realloc(column->values, sizeof(char*) * builder->value_capacity);
+    }
+    uint32_t code = column->n_values++;
+    column->values[code] = csv_arena_strdup(column->arena, cell);
+    csv_hash_table_insert(&builder->codes, hash, pos, code);
+
+    if ((column->code_size == sizeof(uint8_t) && column->n_values > UINT8_MAX + 1)
+        || (column->code_size == sizeof(uint16_t) && column->n_values > UINT16_MAX + 1))
+        csv_dict_widen(column, builder);
+
+    return code;
+}
+
+static void csv_dict_push(csv_dict_column* column, csv_dict_builder* builder, const char* cell)
+{
+    uint32_t code = csv_dict_intern(column, builder, cell);
+
+    if (column->n_rows >= builder->row_capacity)
+    {
+        builder->row_capacity *= 2;
+        column->codes = csv_realloc(column->codes, column->code_size * builder->row_capacity);
+    }
+
+    if (column->code_size == sizeof(uint8_t))
+        ((uint8_t*)column->codes)[column->n_rows] = (uint8_t)code;
+    else if (column->code_size == sizeof(uint16_t))
+        ((uint16_t*)column->codes)[column->n_rows] = (uint16_t)code;
+    else
+        ((uint32_t*)column->codes)[column->n_rows] = code;
+    column->n_rows++;
+}
+
+static void csv_dict_stream(FILE* file, const size_t* column_indices, size_t n_columns, csv_dict_column* columns, char delim)
+{
+    csv_dict_builder* builders = csv_malloc(sizeof(csv_dict_builder) * (n_columns > 0 ? n_columns : 1));
+    size_t max_fields = 0;
+    for (size_t c = 0; c < n_columns; ++c)
+    {
+        csv_dict_init(&columns[c], &builders[c]);
+        if (column_indices[c] != SIZE_MAX && column_indices[c] + 1 > max_fields)
+            max_fields = column_indices[c] + 1;
+    }
+
+    char** fields = csv_malloc(sizeof(char*) * (max_fields > 0 ? max_fields : 1));
+    char* line = NULL;
+    size_t len = 0;
+
+    while (getline(&line, &len, file) != -1)
+    {
+        size_t n_fields = csv_split_line(line, delim, fields, max_fields);
+        for (size_t c = 0; c < n_columns; ++c)
+        {
+            // empty and missing cells are spelled the same way csv_parse_line() does
+            const char* cell = column_indices[c] < n_fields && fields[column_indices[c]][0] != 0 ? fields[column_indices[c]] : "(null)";
+            csv_dict_push(&columns[c], &builders[c], cell);
+        }
+    }
+    free(line);
+    csv_dealloc(fields);
+
+    // the hash tables are only needed while building; trim the arrays to their final size
+    for (size_t c = 0; c < n_columns; ++c)
+    {
+        csv_hash_table_free(&builders[c].codes);
+        if (columns[c].n_values > 0)
+            columns[c].values = csv_realloc(columns[c].values, sizeof(char*) * columns[c].n_values);
+        if (columns[c].n_rows > 0)
+            columns[c].codes = csv_realloc(columns[c].codes, columns[c].code_size * columns[c].n_rows);
+    }
+    csv_dealloc(builders);
+}
+
+void csv_select_by_index_as_dict(const char* filename, size_t* column_indices, size_t n_columns, csv_dict_column** columns, char delim, bool has_headers)
+{
+    FILE* file = fopen(filename, "r");
+    if (file != NULL)
+    {
+        // skip the byte order mark and the header line if present
+        csv_skip_bom(file);
+        if (has_headers)
+        {
+            char* line = NULL;
+            size_t len = 0;
+            getline(&line, &len, file);
+            free(line);
+        }
+
+        (*columns) = csv_malloc(sizeof(csv_dict_column) * (n_columns > 0 ? n_columns : 1));
+        csv_dict_stream(file, column_indices, n_columns, *columns, delim);
+
+        fclose(file);
+    }
+    else
+    {
+        printf("File not found!\n");
+        exit(-1);
+    }
+}
+
+void csv_select_by_name_as_dict(const char* filename, char** column_names, size_t n_columns, csv_dict_column** columns, char delim)
+{
+    FILE* file = fopen(filename, "r");
+    if (file != NULL)
+    {
+        size_t* column_indices = csv_malloc(sizeof(size_t) * (n_columns > 0 ? n_columns : 1));
+        csv_find_columns(file, delim, column_names, n_columns, column_indices);
+
+        (*columns) = csv_malloc(sizeof(csv_dict_column) * (n_columns > 0 ? n_columns : 1));
+        csv_dict_stream(file, column_indices, n_columns, *columns, delim);
+
+        csv_dealloc(column_indices);
+        fclose(file);
+    }
+    else
+    {
+        printf("File not found!\n");
+        exit(-1);
+    }
+}
+
+void csv_read_column_by_index_as_dict(const char* filename, size_t column_index, csv_dict_column* column, char delim, bool has_headers)
+{
+    csv_dict_column* columns = NULL;
+    csv_select_by_index_as_dict(filename, &column_index, 1, &columns, delim, has_headers);
+    *column = columns[0];
+    csv_dealloc(columns);
+}
+
+void csv_read_column_by_name_as_dict(const char* filename, const char* column_name, csv_dict_column* column, char delim)
+{
+    csv_dict_column* columns = NULL;
+    csv_select_by_name_as_dict(filename, (char**)&column_name, 1, &columns, delim);
+    *column = columns[0];
+    csv_dealloc(columns);
+}
+
+uint32_t csv_dict_code(const csv_dict_column* column, size_t row)
+{
+    if (column->code_size == sizeof(uint8_t))
+        return ((const uint8_t*)column->codes)[row];
+    else if (column->code_size == sizeof(uint16_t))
+        return ((const uint16_t*)column->codes)[row];
+    return ((const uint32_t*)column->codes)[row];
+}
+
+bool csv_dict_find(const csv_dict_column* column, const char* value, uint32_t* code)
+{
+    // dictionaries are small by design, so a linear scan is cheaper than keeping the hash table around
+    for (size_t i = 0; i < column->n_values; ++i)
+        if (strcmp(column->values[i], value) == 0)
+        {
+            *code = (uint32_t)i;
+            return true;
+        }
+    return false;
+}
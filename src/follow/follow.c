@@ -0,0 +1,266 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+#include "csvinternal.h"
+#include "follow/follow.h"
+
+#define CSV_FOLLOW_CHUNK 65536
+
+static ssize_t csv_follow_pread(int fd, char* buffer, size_t size, off_t offset)
+{
+    ssize_t n_read;
+    do
+        n_read = pread(fd, buffer, size, offset);
+    while (n_read == -1 && errno == EINTR);
+    return n_read;
+}
+
+// makes room for CSV_FOLLOW_CHUNK more bytes after the partial line
+static void csv_follow_reserve(csv_follow* follow)
+{
+    if (follow->partial_capacity - follow->partial_len >= CSV_FOLLOW_CHUNK)
+        return;
+    follow->partial_capacity = follow->partial_capacity * 2 > follow->partial_len + CSV_FOLLOW_CHUNK ? follow->partial_capacity * 2 : follow->partial_len + CSV_FOLLOW_CHUNK;
+    follow->partial = csv_realloc(follow->partial, follow->partial_capacity);
+}
+
+// forget everything about the current file so it is read from its first line
+static void csv_follow_restart(csv_follow* follow)
+{
+    follow->offset = 0;
+    follow->partial_len = 0;
+    follow->at_first_line = true;
+    follow->n_columns = 0;
+}
+
+// a complete line (with its newline) becomes a row unless it is the header
+static void csv_follow_add_line(csv_follow* follow, const char* line, size_t len, char**** data, size_t* n_rows, size_t* rows_capacity)
+{
+    if (follow->at_first_line)
+    {
+        // a byte order mark is not part of the first cell
+        size_t bom = csv_bom_length(line, len);
+        line += bom;
+        len -= bom;
+
+        follow->at_first_line = false;
+        follow->n_columns = csv_count_columns_n(line, len, follow->delim);
+        if (follow->has_headers)
+            return;
+    }
+
+    if (*n_rows == *rows_capacity)
+    {
+        *rows_capacity *= 2;
+        (*data) = csv_realloc((*data), sizeof(char**) * (*rows_capacity));
+    }
+    csv_parse_line_n(line, len, follow->delim, &(*data)[(*n_rows)++]);
+}
+
+// reads everything appended to the current file since the last read
+static void csv_follow_read(csv_follow* follow, char**** data, size_t* n_rows, size_t* rows_capacity)
+{
+    for (;;)
+    {
+        csv_follow_reserve(follow);
+        ssize_t n_read = csv_follow_pread(follow->fd, follow->partial + follow->partial_len, CSV_FOLLOW_CHUNK, follow->offset);
+        if (n_read <= 0)
+            break;
+
+        // only the new bytes need scanning: the partial line before them has no newline
+        size_t scan = follow->partial_len;
+        size_t line_start = 0;
+        follow->offset += n_read;
+        follow->partial_len += n_read;
+        const char* newline;
+        while ((newline = memchr(follow->partial + scan, '\n', follow->partial_len - scan)) != NULL)
+        {
+            size_t line_end = (size_t)(newline - follow->partial) + 1;
+            csv_follow_add_line(follow, follow->partial + line_start, line_end - line_start, data, n_rows, rows_capacity);
+            line_start = line_end;
+            scan = line_end;
+        }
+
+        follow->partial_len -= line_start;
+        memmove(follow->partial, follow->partial + line_start, follow->partial_len);
+    }
+}
+
+// true if the file grew or shrank since the last read, or filename now names another file
+static bool csv_follow_changed(csv_follow* follow)
+{
+    struct stat file_stat;
+    if (fstat(follow->fd, &file_stat) == 0 && file_stat.st_size != follow->offset)
+        return true;
+    return stat(follow->filename, &file_stat) == 0 && (file_stat.st_ino != follow->inode || file_stat.st_dev != follow->device);
+}
+
+void csv_follow_open(const char* filename, csv_follow* follow, char delim, bool has_headers, bool from_end)
+{
+    int fd = open(filename, O_RDONLY);
+    struct stat file_stat;
+    if (fd == -1 || fstat(fd, &file_stat) == -1)
+    {
+        printf("File not found!\n");
+        exit(-1);
+    }
+
+    follow->filename = csv_strdup(filename);
+    follow->fd = fd;
+    follow->device = file_stat.st_dev;
+    follow->inode = file_stat.st_ino;
+    follow->partial = NULL;
+    follow->partial_capacity = 0;
+    follow->delim = delim;
+    follow->has_headers = has_headers;
+    follow->rotations = 0;
+    follow->truncations = 0;
+    csv_follow_restart(follow);
+    if (!from_end || file_stat.st_size == 0)
+        return;
+
+    // start after the last complete line, so a row that is half written right now is still returned once it is complete
+    off_t end = file_stat.st_size;
+    csv_follow_reserve(follow);
+    while (end > 0 && follow->offset == 0)
+    {
+        size_t size = end > CSV_FOLLOW_CHUNK ? CSV_FOLLOW_CHUNK : (size_t)end;
+        ssize_t n_read = csv_follow_pread(fd, follow->partial, size, end - size);
+        if (n_read <= 0)
+            break;
+        for (ssize_t i = n_read; i > 0 && follow->offset == 0; --i)
+            if (follow->partial[i - 1] == '\n')
+                follow->offset = end - size + i;
+        end -= size;
+    }
+    if (follow->offset == 0)
+        return;
+
+    // the first line has gone by, but its column count is still needed
+    size_t first_len = 0;
+    const char* newline = NULL;
+    while (newline == NULL)
+    {
+        csv_follow_reserve(follow);
+        ssize_t n_read = csv_follow_pread(fd, follow->partial + first_len, CSV_FOLLOW_CHUNK, first_len);
+        if (n_read <= 0)
+            break;
+        newline = memchr(follow->partial + first_len, '\n', n_read);
+        first_len += n_read;
+        follow->partial_len = first_len;
+    }
+    follow->n_columns = csv_count_columns_n(follow->partial, newline != NULL ? (size_t)(newline - follow->partial) + 1 : first_len, delim);
+    follow->at_first_line = false;
+    follow->partial_len = 0;
+}
+
+void csv_follow_poll(csv_follow* follow, char**** data, size_t (*data_dims)[2])
+{
+    size_t rows_capacity = 10;
+    size_t n_rows = 0;
+    (*data) = csv_calloc(rows_capacity, sizeof(char**));
+
+    struct stat file_stat;
+    bool rotated = stat(follow->filename, &file_stat) == 0 && (file_stat.st_ino != follow->inode || file_stat.st_dev != follow->device);
+
+    // a file shorter than what has been read was truncated (e.g. copytruncate log rotation)
+    if (fstat(follow->fd, &file_stat) == 0 && file_stat.st_size < follow->offset)
+    {
+        follow->truncations++;
+        csv_follow_restart(follow);
+    }
+    csv_follow_read(follow, data, &n_rows, &rows_capacity);
+
+    if (rotated)
+    {
+        int fd = open(follow->filename, O_RDONLY);
+        if (fd != -1 && fstat(fd, &file_stat) == 0)
+        {
+            // the old file will not be written to again, so its unterminated last line is a row of its own
+            if (follow->partial_len > 0)
+            {
+                follow->partial[follow->partial_len] = '\n';
+                csv_follow_add_line(follow, follow->partial, follow->partial_len + 1, data, &n_rows, &rows_capacity);
+            }
+
+            // the new file is read by the next poll so a single poll never mixes rows of two files
+            close(follow->fd);
+            follow->fd = fd;
+            follow->device = file_stat.st_dev;
+            follow->inode = file_stat.st_ino;
+            follow->rotations++;
+            size_t n_columns = follow->n_columns;
+            csv_follow_restart(follow);
+            (*data_dims)[0] = n_rows;
+            (*data_dims)[1] = n_columns;
+            return;
+        }
+        else if (fd != -1)
+            close(fd);
+    }
+
+    (*data_dims)[0] = n_rows;
+    (*data_dims)[1] = follow->n_columns;
+}
+
+bool csv_follow_wait(csv_follow* follow, int timeout_ms)
+{
+    if (csv_follow_changed(follow))
+        return true;
+
+#ifdef __linux__
+    int watch = inotify_init1(IN_CLOEXEC);
+    if (watch != -1)
+    {
+        // appends and truncation show up on the file, rotation on its directory
+        char* directory = csv_strdup(follow->filename);
+        char* slash = strrchr(directory, '/');
+        if (slash == NULL)
+            strcpy(directory, ".");
+        else
+            slash[slash == directory ? 1 : 0] = 0;
+        inotify_add_watch(watch, follow->filename, IN_MODIFY | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF);
+        inotify_add_watch(watch, directory, IN_CREATE | IN_MOVED_TO);
+        csv_dealloc(directory);
+
+        // the file may have changed before the watches were added
+        bool changed = csv_follow_changed(follow);
+        if (!changed)
+        {
+            struct pollfd event = { watch, POLLIN, 0 };
+            changed = poll(&event, 1, timeout_ms) > 0;
+        }
+        close(watch);
+        return changed;
+    }
+#endif
+
+    struct timespec interval = { 0, 100 * 1000000L };
+    for (int waited = 0; timeout_ms < 0 || waited < timeout_ms; waited += 100)
+    {
+        nanosleep(&interval, NULL);
+        if (csv_follow_changed(follow))
+            return true;
+    }
+    return false;
+}
+
+void csv_follow_close(csv_follow* follow)
+{
+    if (follow->fd != -1)
+        close(follow->fd);
+    follow->fd = -1;
+    csv_dealloc(follow->filename);
+    follow->filename = NULL;
+    csv_dealloc(follow->partial);
+    follow->partial = NULL;
+    follow->partial_len = 0;
+    follow->partial_capacity = 0;
+}
@@ -1,3 +1,4 @@
+#include "csvinternal.h"
 #include "free/free.h"
 
 void csv_free(char**** data, size_t data_dims[2])
@@ -6,13 +7,13 @@ void csv_free(char**** data, size_t data_dims[2])
     {
         for (size_t j = 0; j < data_dims[1]; ++j)
         {
-            free((*data)[i][j]);
+            csv_dealloc((*data)[i][j]);
             (*data)[i][j] = NULL;
         }
-        free((*data)[i]);
+        csv_dealloc((*data)[i]);
         (*data)[i] = NULL;
     }
-    free((*data));
+    csv_dealloc((*data));
     (*data) = NULL;
 }
 
@@ -20,10 +21,10 @@ void csv_free_int(int*** data, size_t data_rows)
 {
     for (size_t i = 0; i < data_rows; ++i)
     {
-        free((*data)[i]);
+        csv_dealloc((*data)[i]);
         (*data)[i] = NULL;
     }
-    free((*data));
+    csv_dealloc((*data));
     (*data) = NULL;
 }
 
@@ -31,10 +32,10 @@ void csv_free_float(float*** data, size_t data_rows)
 {
     for (size_t i = 0; i < data_rows; ++i)
     {
-        free((*data)[i]);
+        csv_dealloc((*data)[i]);
         (*data)[i] = NULL;
     }
-    free((*data));
+    csv_dealloc((*data));
     (*data) = NULL;
 }
 
@@ -42,21 +43,94 @@ void csv_free_column(char*** data, size_t data_rows)
 {
     for (size_t i = 0; i < data_rows; ++i)
     {
-        free((*data)[i]);
+        csv_dealloc((*data)[i]);
         (*data)[i] = NULL;
     }
-    free(*data);
+    csv_dealloc(*data);
     *data = NULL;
 }
 
 void csv_free_column_int(int** data)
 {
-    free(*data);
+    csv_dealloc(*data);
     *data = NULL;
 }
 
 void csv_free_column_float(float** data)
 {
-    free(*data);
+    csv_dealloc(*data);
     *data = NULL;
-}
\ No newline at end of file
+}
+
+void csv_free_column_timestamp(int64_t** data)
+{
+    csv_dealloc(*data);
+    *data = NULL;
+}
+
+void csv_free_stats(csv_stats** stats)
+{
+    csv_dealloc(*stats);
+    *stats = NULL;
+}
+
+void csv_free_groups(csv_groups* groups)
+{
+    csv_arena_free(groups->arena);
+    csv_dealloc(groups->arena);
+    groups->arena = NULL;
+
+    csv_dealloc(groups->keys);
+    groups->keys = NULL;
+    csv_dealloc(groups->values[0]);
+    csv_dealloc(groups->values);
+    groups->values = NULL;
+    groups->n_groups = 0;
+}
+
+void csv_free_profiles(csv_profile** profiles, size_t n_columns)
+{
+    for (size_t i = 0; i < n_columns; ++i)
+    {
+        csv_dealloc((*profiles)[i].name);
+        csv_quantile_sketch_free((*profiles)[i].sketch);
+    }
+    csv_dealloc(*profiles);
+    *profiles = NULL;
+}
+
+void csv_free_dict_column(csv_dict_column* column)
+{
+    csv_arena_free(column->arena);
+    csv_dealloc(column->arena);
+    column->arena = NULL;
+
+    csv_dealloc(column->values);
+    column->values = NULL;
+    csv_dealloc(column->codes);
+    column->codes = NULL;
+    column->n_values = 0;
+    column->n_rows = 0;
+}
+
+void csv_free_dict_columns(csv_dict_column** columns, size_t n_columns)
+{
+    for (size_t i = 0; i < n_columns; ++i)
+        csv_free_dict_column(&(*columns)[i]);
+    csv_dealloc(*columns);
+    *columns = NULL;
+}
+
+void csv_free_structs(void** structs, size_t n_structs, const csv_binding* bindings, size_t n_bindings, size_t struct_size)
+{
+    // only string fields own memory of their own
+    for (size_t b = 0; b < n_bindings; ++b)
+        if (bindings[b].parser == &csv_bind_string)
+            for (size_t i = 0; i < n_structs; ++i)
+            {
+                char** field = (char**)((char*)(*structs) + i * struct_size + bindings[b].offset);
+                csv_dealloc(*field);
+            }
+    csv_dealloc(*structs);
+    *structs = NULL;
+}
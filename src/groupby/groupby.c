@@ -0,0 +1,235 @@
+#include <math.h>
+
+#include "csvinternal.h"
+#include "groupby/groupby.h"
+
+typedef struct csv_group_table
+{
+    csv_hash_table index;
+
+    char*** keys;
+    double* accumulators; // running sum, min or max per group and aggregate
+    size_t* counts;       // numeric cells seen per group and aggregate
+    size_t group_capacity;
+    size_t n_groups;
+
+    size_t n_keys;
+    size_t n_aggregates;
+    csv_arena* arena;
+} csv_group_table;
+
+static size_t csv_group_table_add(csv_group_table* table, char** key)
+{
+    if (table->n_groups >= table->group_capacity)
+    {
+        table->group_capacity *= 2;
+        table->keys = csv_realloc(table->keys, sizeof(char**) * table->group_capacity);
+        table->accumulators = csv_realloc(table->accumulators, sizeof(double) * table->group_capacity * table->n_aggregates);
+        table->counts = csv_realloc(table->counts, sizeof(size_t) * table->group_capacity * table->n_aggregates);
+    }
+
+    size_t group = table->n_groups++;
+    table->keys[group] = csv_arena_alloc(table->arena, sizeof(char*) * table->n_keys);
+    for (size_t k = 0; k < table->n_keys; ++k)
+        table->keys[group][k] = csv_arena_strdup(table->arena, key[k]);
+
+    for (size_t a = 0; a < table->n_aggregates; ++a)
+    {
+        table->accumulators[group * table->n_aggregates + a] = 0.0;
+        table->counts[group * table->n_aggregates + a] = 0;
+    }
+
+    return group;
+}
+
+// returns the group for key, creating it the first time the key is seen
+static size_t csv_group_table_find(csv_group_table* table, char** key)
+{
+    uint64_t hash = 0;
+    for (size_t k = 0; k < table->n_keys; ++k)
+        hash = csv_hash(key[k], strlen(key[k]) + 1, hash); // include \0 so ("a", "bc") != ("ab", "c")
+
+    size_t pos = csv_hash_table_start(&table->index, hash);
+    size_t group;
+    while ((group = csv_hash_table_next(&table->index, hash, &pos)) != SIZE_MAX)
+    {
+        bool equal = true;
+        for (size_t k = 0; k < table->n_keys && equal; ++k)
+            equal = strcmp(table->keys[group][k], key[k]) == 0;
+        if (equal)
+            return group;
+    }
+
+    group = csv_group_table_add(table, key);
+    csv_hash_table_insert(&table->index, hash, pos, group);
+    return group;
+}
+
+static void csv_group_accumulate(csv_group_table* table, size_t group, const csv_aggregate* aggregates, size_t a, const char* cell)
+{
+    char* end;
+    double value = strtod(cell, &end);
+    if (end == cell)
+        return;
+
+    double* accumulator = &table->accumulators[group * table->n_aggregates + a];
+    size_t* count = &table->counts[group * table->n_aggregates + a];
+
+    switch (aggregates[a])
+    {
+        case CSV_AGG_MIN:
+            if (*count == 0 || value < *accumulator)
+                *accumulator = value;
+            break;
+        case CSV_AGG_MAX:
+            if (*count == 0 || value > *accumulator)
+                *accumulator = value;
+            break;
+        case CSV_AGG_SUM:
+        case CSV_AGG_MEAN:
+            *accumulator += value;
+            break;
+        case CSV_AGG_COUNT:
+            break;
+    }
+    (*count)++;
+}
+
+static void csv_group_stream(FILE* file, const size_t* key_indices, size_t n_keys, const size_t* value_indices, const csv_aggregate* aggregates, size_t n_aggregates, csv_groups* groups, char delim)
+{
+    csv_group_table table;
+    csv_hash_table_init(&table.index, 64);
+    table.group_capacity = 16;
+    table.keys = csv_malloc(sizeof(char**) * table.group_capacity);
+    table.accumulators = csv_malloc(sizeof(double) * table.group_capacity * (n_aggregates > 0 ? n_aggregates : 1));
+    table.counts = csv_malloc(sizeof(size_t) * table.group_capacity * (n_aggregates > 0 ? n_aggregates : 1));
+    table.n_groups = 0;
+    table.n_keys = n_keys;
+    table.n_aggregates = n_aggregates;
+    table.arena = csv_malloc(sizeof(csv_arena));
+    table.arena->head = NULL;
+
+    size_t max_fields = 0;
+    for (size_t k = 0; k < n_keys; ++k)
+        if (key_indices[k] != SIZE_MAX && key_indices[k] + 1 > max_fields)
+            max_fields = key_indices[k] + 1;
+    for (size_t a = 0; a < n_aggregates; ++a)
+        if (value_indices[a] != SIZE_MAX && value_indices[a] + 1 > max_fields)
+            max_fields = value_indices[a] + 1;
+
+    char** fields = csv_malloc(sizeof(char*) * (max_fields > 0 ? max_fields : 1));
+    char** key = csv_malloc(sizeof(char*) * (n_keys > 0 ? n_keys : 1));
+    char* line = NULL;
+    size_t len = 0;
+
+    while (getline(&line, &len, file) != -1)
+    {
+        size_t n_fields = csv_split_line(line, delim, fields, max_fields);
+
+        // empty and missing cells group together, spelled the same way csv_parse_line() does
+        for (size_t k = 0; k < n_keys; ++k)
+            key[k] = key_indices[k] < n_fields && fields[key_indices[k]][0] != 0 ? fields[key_indices[k]] : "(null)";
+
+        size_t group = csv_group_table_find(&table, key);
+        for (size_t a = 0; a < n_aggregates; ++a)
+            if (value_indices[a] < n_fields)
+                csv_group_accumulate(&table, group, aggregates, a, fields[value_indices[a]]);
+    }
+    free(line);
+    csv_dealloc(key);
+    csv_dealloc(fields);
+
+    // turn the running accumulators into the final values
+    groups->n_groups = table.n_groups;
+    groups->n_keys = n_keys;
+    groups->n_aggregates = n_aggregates;
+    groups->arena = table.arena;
+    groups->keys = table.keys;
+    groups->values = csv_malloc(sizeof(double*) * (table.n_groups > 0 ? table.n_groups : 1));
+    double* values = csv_malloc(sizeof(double) * (table.n_groups * n_aggregates > 0 ? table.n_groups * n_aggregates : 1));
+
+    for (size_t g = 0; g < table.n_groups; ++g)
+    {
+        groups->values[g] = &values[g * n_aggregates];
+        for (size_t a = 0; a < n_aggregates; ++a)
+        {
+            double accumulator = table.accumulators[g * n_aggregates + a];
+            size_t count = table.counts[g * n_aggregates + a];
+
+            switch (aggregates[a])
+            {
+                case CSV_AGG_COUNT:
+                    groups->values[g][a] = (double)count;
+                    break;
+                case CSV_AGG_SUM:
+                    groups->values[g][a] = accumulator;
+                    break;
+                case CSV_AGG_MEAN:
+                    groups->values[g][a] = count > 0 ? accumulator / count : NAN;
+                    break;
+                case CSV_AGG_MIN:
+                case CSV_AGG_MAX:
+                    groups->values[g][a] = count > 0 ? accumulator : NAN;
+                    break;
+            }
+        }
+    }
+    if (table.n_groups == 0)
+        groups->values[0] = values;
+
+    csv_dealloc(table.accumulators);
+    csv_dealloc(table.counts);
+    csv_hash_table_free(&table.index);
+}
+
+void csv_group_by(const char* filename, char** key_columns, size_t n_keys, char** value_columns, csv_aggregate* aggregates, size_t n_aggregates, csv_groups* groups, char delim)
+{
+    FILE* file = fopen(filename, "r");
+    if (file != NULL)
+    {
+        // resolve key and value columns against the header in one go
+        size_t n_names = n_keys + n_aggregates;
+        char** names = csv_malloc(sizeof(char*) * (n_names > 0 ? n_names : 1));
+        size_t* indices = csv_malloc(sizeof(size_t) * (n_names > 0 ? n_names : 1));
+        memcpy(names, key_columns, sizeof(char*) * n_keys);
+        memcpy(names + n_keys, value_columns, sizeof(char*) * n_aggregates);
+        csv_find_columns(file, delim, names, n_names, indices);
+
+        csv_group_stream(file, indices, n_keys, indices + n_keys, aggregates, n_aggregates, groups, delim);
+
+        csv_dealloc(indices);
+        csv_dealloc(names);
+        fclose(file);
+    }
+    else
+    {
+        printf("File not found!\n");
+        exit(-1);
+    }
+}
+
+void csv_group_by_index(const char* filename, size_t* key_indices, size_t n_keys, size_t* value_indices, csv_aggregate* aggregates, size_t n_aggregates, csv_groups* groups, char delim, bool has_headers)
+{
+    FILE* file = fopen(filename, "r");
+    if (file != NULL)
+    {
+        // skip the byte order mark and the header line if present
+        csv_skip_bom(file);
+        if (has_headers)
+        {
+            char* line = NULL;
+            size_t len = 0;
+            getline(&line, &len, file);
+            free(line);
+        }
+
+        csv_group_stream(file, key_indices, n_keys, value_indices, aggregates, n_aggregates, groups, delim);
+
+        fclose(file);
+    }
+    else
+    {
+        printf("File not found!\n");
+        exit(-1);
+    }
+}
@@ -27,6 +27,15 @@ void csv_ignore_by_name(const char* filename, char** column_names, size_t n_colu
     size_t rows;
     bool allocated = false;
 
+    // csv_get_column_names() reports a missing file as 0 columns, which would leave data unset
+    FILE* file = fopen(filename, "r");
+    if (file == NULL)
+    {
+        printf("File not found!\n");
+        exit(-1);
+    }
+    fclose(file);
+
     // read first line in file to count the total columns
     char** all_columns = NULL;
     size_t total_column_count = csv_get_column_names(filename, delim, &all_columns);
@@ -48,9 +57,9 @@ void csv_ignore_by_name(const char* filename, char** column_names, size_t n_colu
             // allocate memory for user's data when number of rows is known
             if (!allocated)
             {
-                (*data) = calloc(rows, sizeof(char**));
+                (*data) = csv_calloc(rows, sizeof(char**));
                 for (size_t i = 0; i < rows; ++i)
-                    (*data)[i] = calloc(total_column_count - n_columns, sizeof(char*));
+                    (*data)[i] = csv_calloc(total_column_count - n_columns, sizeof(char*));
                 (*data_dims)[0] = rows;
                 (*data_dims)[1] = total_column_count - n_columns;
                 allocated = true;
@@ -58,7 +67,7 @@ void csv_ignore_by_name(const char* filename, char** column_names, size_t n_colu
 
             // copy data from column into user's data and free it back
             for (size_t r = 0; r < rows; ++r)
-                (*data)[r][current_iter] = strdup(current_column[r]);
+                (*data)[r][current_iter] = csv_strdup(current_column[r]);
             csv_free_column(&current_column, rows);
 
             current_iter++;
@@ -89,12 +98,20 @@ void csv_ignore_by_index(const char* filename, size_t* column_indices, size_t n_
     size_t rows;
     bool allocated = false;
 
+    FILE* file = fopen(filename, "r");
+    if (file == NULL)
+    {
+        printf("File not found!\n");
+        exit(-1);
+    }
+    fclose(file);
+
     // read first line in file to count the total columns
     // then create array to store all columns
     char** all_columns = NULL;
     size_t total_column_count = csv_get_column_names(filename, delim, &all_columns);
     csv_free_column(&all_columns, total_column_count);
-    size_t* all_column_indices = calloc(total_column_count, sizeof(size_t));
+    size_t* all_column_indices = csv_calloc(total_column_count, sizeof(size_t));
     for (size_t i = 0; i < total_column_count; ++i)
         all_column_indices[i] = i;
 
@@ -115,9 +132,9 @@ void csv_ignore_by_index(const char* filename, size_t* column_indices, size_t n_
             // allocate memory for user's data when number of rows is known
             if (!allocated)
             {
-                (*data) = calloc(rows, sizeof(char**));
+                (*data) = csv_calloc(rows, sizeof(char**));
                 for (size_t i = 0; i < rows; ++i)
-                    (*data)[i] = calloc(total_column_count - n_columns, sizeof(char*));
+                    (*data)[i] = csv_calloc(total_column_count - n_columns, sizeof(char*));
                 (*data_dims)[0] = rows;
                 (*data_dims)[1] = total_column_count - n_columns;
                 allocated = true;
@@ -125,13 +142,13 @@ void csv_ignore_by_index(const char* filename, size_t* column_indices, size_t n_
 
             // copy data from column into user's data and free it back
             for (size_t r = 0; r < rows; ++r)
-                (*data)[r][current_iter] = strdup(current_column[r]);
+                (*data)[r][current_iter] = csv_strdup(current_column[r]);
             csv_free_column(&current_column, rows);
 
             current_iter++;
         }
     }
-    free(all_column_indices);
+    csv_dealloc(all_column_indices);
 }
 
 void csv_ignore_by_index_as_float(const char* filename, size_t* column_indices, size_t n_columns, float*** data, size_t (*data_dims)[2], char delim, bool has_headers)
@@ -148,4 +165,95 @@ void csv_ignore_by_index_as_int(const char* filename, size_t* column_indices, si
     csv_ignore_by_index(filename, column_indices, n_columns, &s_data, data_dims, delim, has_headers);
     csv_data_to_int(s_data, *data_dims, data);
     csv_free(&s_data, *data_dims);
-}
\ No newline at end of file
+}
+
+void csv_ignore_by_name_from(csv_source* source, char** column_names, size_t n_columns, char**** data, size_t (*data_dims)[2], char delim)
+{
+    csv_reader reader;
+    csv_reader_init(&reader, source);
+
+    // keep every header column that is not being ignored, then select them in the same pass
+    char** all_columns = NULL;
+    size_t total_column_count = csv_reader_header(&reader, delim, &all_columns);
+    size_t* kept_indices = csv_malloc(sizeof(size_t) * (total_column_count > 0 ? total_column_count : 1));
+    size_t n_kept = 0;
+    for (size_t i = 0; i < total_column_count; ++i)
+    {
+        bool ignored = false;
+        for (size_t c = 0; c < n_columns && !ignored; ++c)
+            ignored = strcmp(all_columns[i], column_names[c]) == 0;
+        if (!ignored)
+            kept_indices[n_kept++] = i;
+    }
+    csv_free_column(&all_columns, total_column_count);
+
+    csv_select_rows(&reader, kept_indices, n_kept, data, data_dims, delim);
+
+    csv_dealloc(kept_indices);
+    csv_reader_free(&reader);
+}
+
+void csv_ignore_by_name_as_float_from(csv_source* source, char** column_names, size_t n_columns, float*** data, size_t (*data_dims)[2], char delim)
+{
+    char*** s_data = NULL;
+    csv_ignore_by_name_from(source, column_names, n_columns, &s_data, data_dims, delim);
+    csv_data_to_float(s_data, *data_dims, data);
+    csv_free(&s_data, *data_dims);
+}
+
+void csv_ignore_by_name_as_int_from(csv_source* source, char** column_names, size_t n_columns, int*** data, size_t (*data_dims)[2], char delim)
+{
+    char*** s_data = NULL;
+    csv_ignore_by_name_from(source, column_names, n_columns, &s_data, data_dims, delim);
+    csv_data_to_int(s_data, *data_dims, data);
+    csv_free(&s_data, *data_dims);
+}
+
+void csv_ignore_by_index_from(csv_source* source, size_t* column_indices, size_t n_columns, char**** data, size_t (*data_dims)[2], char delim, bool has_headers)
+{
+    csv_reader reader;
+    csv_reader_init(&reader, source);
+
+    // the first line gives the total column count; without headers it is data, so it is read again below
+    const char* line;
+    size_t len;
+    size_t total_column_count = 0;
+    if (csv_reader_next(&reader, &line, &len))
+    {
+        total_column_count = csv_count_columns_n(line, len, delim);
+        if (!has_headers)
+            csv_reader_unread(&reader);
+    }
+
+    size_t* kept_indices = csv_malloc(sizeof(size_t) * (total_column_count > 0 ? total_column_count : 1));
+    size_t n_kept = 0;
+    for (size_t i = 0; i < total_column_count; ++i)
+    {
+        bool ignored = false;
+        for (size_t c = 0; c < n_columns && !ignored; ++c)
+            ignored = column_indices[c] == i;
+        if (!ignored)
+            kept_indices[n_kept++] = i;
+    }
+
+    csv_select_rows(&reader, kept_indices, n_kept, data, data_dims, delim);
+
+    csv_dealloc(kept_indices);
+    csv_reader_free(&reader);
+}
+
+void csv_ignore_by_index_as_float_from(csv_source* source, size_t* column_indices, size_t n_columns, float*** data, size_t (*data_dims)[2], char delim, bool has_headers)
+{
+    char*** s_data = NULL;
+    csv_ignore_by_index_from(source, column_indices, n_columns, &s_data, data_dims, delim, has_headers);
+    csv_data_to_float(s_data, *data_dims, data);
+    csv_free(&s_data, *data_dims);
+}
+
+void csv_ignore_by_index_as_int_from(csv_source* source, size_t* column_indices, size_t n_columns, int*** data, size_t (*data_dims)[2], char delim, bool has_headers)
+{
+    char*** s_data = NULL;
+    csv_ignore_by_index_from(source, column_indices, n_columns, &s_data, data_dims, delim, has_headers);
+    csv_data_to_int(s_data, *data_dims, data);
+    csv_free(&s_data, *data_dims);
+}
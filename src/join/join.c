@@ -0,0 +1,515 @@
+#include <sys/stat.h>
+
+#include "csvinternal.h"
+#include "join/join.h"
+
+#define CSV_JOIN_DEFAULT_BUDGET ((size_t)256 << 20)
+#define CSV_JOIN_MAX_PARTITIONS 256
+// partitions use a different seed than the table so each partition's table still spreads well
+#define CSV_JOIN_PARTITION_SEED 0x9e3779b97f4a7c15ULL
+
+// one row of the build side; rows with the same key are chained in input order
+typedef struct csv_join_entry
+{
+    uint64_t hash;
+    const char* key;
+    size_t key_len;
+    const char* payload;
+    size_t payload_len;
+    struct csv_join_entry* next_match;
+    struct csv_join_entry* last_match; // only kept up to date on the first row of each key
+    struct csv_join_entry* next_row;
+    bool matched;
+} csv_join_entry;
+
+// the first row of each distinct key, found through a hash table of their indices
+typedef struct csv_join_table
+{
+    csv_hash_table index;
+    csv_join_entry** heads;
+    size_t heads_capacity;
+    size_t n_distinct;
+    csv_join_entry* first_row;
+    csv_join_entry* last_row;
+    size_t used;
+    csv_arena arena;
+} csv_join_table;
+
+typedef struct csv_join_buffer
+{
+    char* data;
+    size_t len;
+    size_t capacity;
+} csv_join_buffer;
+
+typedef struct csv_join_context
+{
+    const size_t* left_keys;
+    const size_t* right_keys;
+    size_t n_keys;
+    csv_join_type type;
+    char delim;
+    bool build_left;
+    size_t n_right_columns;
+    char** fields;
+    size_t max_fields;
+    csv_join_buffer key;
+    csv_join_buffer row;
+    FILE* output;
+} csv_join_context;
+
+static void csv_join_append(csv_join_buffer* buffer, const char* data, size_t len)
+{
+    if (buffer->len + len > buffer->capacity)
+    {
+        buffer->capacity = buffer->capacity * 2 > buffer->len + len ? buffer->capacity * 2 : buffer->len + len + 256;
+        buffer->data = csv_realloc(buffer->data, buffer->capacity);
+    }
+    memcpy(buffer->data + buffer->len, data, len);
+    buffer->len += len;
+}
+
+// splits a getline() line in place into ctx->fields; the line terminator is not part of the last cell
+static size_t csv_join_split(csv_join_context* ctx, char* line, size_t len)
+{
+    while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+        line[--len] = 0;
+
+    size_t n_fields = csv_count_columns_n(line, len, ctx->delim);
+    if (n_fields > ctx->max_fields)
+    {
+        ctx->max_fields = n_fields;
+        ctx->fields = csv_realloc(ctx->fields, sizeof(char*) * ctx->max_fields);
+    }
+    return csv_split_line(line, ctx->delim, ctx->fields, n_fields);
+}
+
+// joins the key cells into ctx->key, each followed by \0; false if any of them is empty or missing
+static bool csv_join_make_key(csv_join_context* ctx, size_t n_fields, const size_t* key_indices)
+{
+    ctx->key.len = 0;
+    for (size_t k = 0; k < ctx->n_keys; ++k)
+    {
+        if (key_indices[k] >= n_fields)
+            return false;
+
+        const char* cell = ctx->fields[key_indices[k]];
+        size_t len = strlen(cell);
+        if (len >= 2 && cell[0] == '\"' && cell[len - 1] == '\"')
+        {
+            cell++;
+            len -= 2;
+        }
+        if (len == 0)
+            return false;
+
+        csv_join_append(&ctx->key, cell, len);
+        csv_join_append(&ctx->key, "", 1);
+    }
+    return true;
+}
+
+// appends the split row back as it was in the file
+static void csv_join_append_left(csv_join_context* ctx, size_t n_fields)
+{
+    for (size_t i = 0; i < n_fields; ++i)
+    {
+        if (i > 0)
+            csv_join_append(&ctx->row, &ctx->delim, 1);
+        csv_join_append(&ctx->row, ctx->fields[i], strlen(ctx->fields[i]));
+    }
+}
+
+// appends the right row's non-key cells, each preceded by the delimiter; n_fields = 0 appends empty cells
+static void csv_join_append_right(csv_join_context* ctx, size_t n_fields)
+{
+    for (size_t c = 0; c < ctx->n_right_columns; ++c)
+    {
+        bool is_key = false;
+        for (size_t k = 0; k < ctx->n_keys && !is_key; ++k)
+            is_key = ctx->right_keys[k] == c;
+        if (is_key)
+            continue;
+
+        csv_join_append(&ctx->row, &ctx->delim, 1);
+        if (c < n_fields)
+            csv_join_append(&ctx->row, ctx->fields[c], strlen(ctx->fields[c]));
+    }
+}
+
+// returns the first row with this key, or NULL with pos left where the key would be inserted
+static csv_join_entry* csv_join_find(const csv_join_table* table, uint64_t hash, const char* key, size_t key_len, size_t* pos)
+{
+    *pos = csv_hash_table_start(&table->index, hash);
+    size_t head;
+    while ((head = csv_hash_table_next(&table->index, hash, pos)) != SIZE_MAX)
+    {
+        csv_join_entry* entry = table->heads[head];
+        if (entry->key_len == key_len && memcmp(entry->key, key, key_len) == 0)
+            return entry;
+    }
+    return NULL;
+}
+
+// the bytes the table itself takes, counted against the memory budget next to the rows
+static size_t csv_join_table_size(const csv_join_table* table)
+{
+    return table->index.capacity * sizeof(csv_hash_slot) + table->heads_capacity * sizeof(csv_join_entry*);
+}
+
+static void csv_join_free_table(csv_join_table* table)
+{
+    csv_hash_table_free(&table->index);
+    csv_dealloc(table->heads);
+    csv_arena_free(&table->arena);
+    memset(table, 0, sizeof(csv_join_table));
+}
+
+// loads the build side into the table, keeping only the rendered cells the output needs
+// returns false as soon as the table outgrows memory_budget
+static bool csv_join_build(csv_join_context* ctx, FILE* file, csv_join_table* table, size_t memory_budget)
+{
+    const size_t* key_indices = ctx->build_left ? ctx->left_keys : ctx->right_keys;
+    bool fits = true;
+
+    char* line = NULL;
+    size_t len = 0;
+    ssize_t read;
+    while (fits && (read = getline(&line, &len, file)) != -1)
+    {
+        size_t n_fields = csv_join_split(ctx, line, read);
+        bool has_key = csv_join_make_key(ctx, n_fields, key_indices);
+
+        // rows that can never match only matter when they are left rows a left join must still write
+        if (!has_key && !(ctx->build_left && ctx->type == CSV_JOIN_LEFT))
+            continue;
+
+        ctx->row.len = 0;
+        if (ctx->build_left)
+            csv_join_append_left(ctx, n_fields);
+        else if (ctx->type != CSV_JOIN_SEMI)
+            csv_join_append_right(ctx, n_fields);
+
+        csv_join_entry* entry = csv_arena_alloc(&table->arena, sizeof(csv_join_entry));
+        char* key = csv_arena_alloc(&table->arena, ctx->key.len + ctx->row.len);
+        memcpy(key, ctx->key.data, ctx->key.len);
+        memcpy(key + ctx->key.len, ctx->row.data, ctx->row.len);
+        entry->key = key;
+        entry->key_len = ctx->key.len;
+        entry->payload = key + ctx->key.len;
+        entry->payload_len = ctx->row.len;
+        entry->next_match = NULL;
+        entry->last_match = entry;
+        entry->next_row = NULL;
+        entry->matched = false;
+
+        if (table->last_row != NULL)
+            table->last_row->next_row = entry;
+        else
+            table->first_row = entry;
+        table->last_row = entry;
+
+        if (has_key)
+        {
+            if (table->index.capacity == 0)
+                csv_hash_table_init(&table->index, 1024);
+
+            size_t pos;
+            entry->hash = csv_hash(entry->key, entry->key_len, 0);
+            csv_join_entry* head = csv_join_find(table, entry->hash, entry->key, entry->key_len, &pos);
+            if (head != NULL)
+            {
+                head->last_match->next_match = entry;
+                head->last_match = entry;
+            }
+            else
+            {
+                if (table->n_distinct == table->heads_capacity)
+                {
+                    table->heads_capacity = table->heads_capacity == 0 ? 512 : table->heads_capacity * 2;
+                    table->heads = csv_realloc(table->heads, sizeof(csv_join_entry*) * table->heads_capacity);
+                }
+                table->heads[table->n_distinct] = entry;
+                csv_hash_table_insert(&table->index, entry->hash, pos, table->n_distinct++);
+            }
+        }
+
+        table->used += sizeof(csv_join_entry) + ctx->key.len + ctx->row.len + sizeof(void*);
+        fits = table->used + csv_join_table_size(table) <= memory_budget;
+    }
+
+    // getline() buffer
+    free(line);
+    return fits;
+}
+
+// streams the other side through the table, writing rows as they are produced
+static void csv_join_probe(csv_join_context* ctx, FILE* file, csv_join_table* table)
+{
+    const size_t* key_indices = ctx->build_left ? ctx->right_keys : ctx->left_keys;
+
+    char* line = NULL;
+    size_t len = 0;
+    ssize_t read;
+    while ((read = getline(&line, &len, file)) != -1)
+    {
+        size_t n_fields = csv_join_split(ctx, line, read);
+        csv_join_entry* match = NULL;
+        size_t pos;
+        if (table->n_distinct > 0 && csv_join_make_key(ctx, n_fields, key_indices))
+            match = csv_join_find(table, csv_hash(ctx->key.data, ctx->key.len, 0), ctx->key.data, ctx->key.len, &pos);
+
+        if (!ctx->build_left)
+        {
+            // left rows streaming past right rows in the table
+            if (match == NULL && ctx->type != CSV_JOIN_LEFT)
+                continue;
+
+            ctx->row.len = 0;
+            csv_join_append_left(ctx, n_fields);
+            if (match == NULL)
+                csv_join_append_right(ctx, 0);
+            if (match == NULL || ctx->type == CSV_JOIN_SEMI)
+            {
+                csv_join_append(&ctx->row, "\n", 1);
+                fwrite(ctx->row.data, 1, ctx->row.len, ctx->output);
+                continue;
+            }
+
+            for (csv_join_entry* entry = match; entry != NULL; entry = entry->next_match)
+            {
+                fwrite(ctx->row.data, 1, ctx->row.len, ctx->output);
+                fwrite(entry->payload, 1, entry->payload_len, ctx->output);
+                fputc('\n', ctx->output);
+            }
+        }
+        else
+        {
+            // right rows streaming past left rows in the table; unmatched and semi rows are written by csv_join_finish()
+            if (match == NULL)
+                continue;
+
+            ctx->row.len = 0;
+            if (ctx->type != CSV_JOIN_SEMI)
+                csv_join_append_right(ctx, n_fields);
+            for (csv_join_entry* entry = match; entry != NULL; entry = entry->next_match)
+            {
+                entry->matched = true;
+                if (ctx->type == CSV_JOIN_SEMI)
+                    continue;
+                fwrite(entry->payload, 1, entry->payload_len, ctx->output);
+                fwrite(ctx->row.data, 1, ctx->row.len, ctx->output);
+                fputc('\n', ctx->output);
+            }
+        }
+    }
+
+    // getline() buffer
+    free(line);
+}
+
+// left rows held in the table are only known to be (un)matched once the right side has been streamed
+static void csv_join_finish(csv_join_context* ctx, csv_join_table* table)
+{
+    if (!ctx->build_left || ctx->type == CSV_JOIN_INNER)
+        return;
+
+    ctx->row.len = 0;
+    if (ctx->type == CSV_JOIN_LEFT)
+        csv_join_append_right(ctx, 0);
+
+    for (csv_join_entry* entry = table->first_row; entry != NULL; entry = entry->next_row)
+        if (entry->matched == (ctx->type == CSV_JOIN_SEMI))
+        {
+            fwrite(entry->payload, 1, entry->payload_len, ctx->output);
+            fwrite(ctx->row.data, 1, ctx->row.len, ctx->output);
+            fputc('\n', ctx->output);
+        }
+}
+
+// copies each line of file into the partition its key hashes to; rows without a key go to partition 0
+static void csv_join_partition(csv_join_context* ctx, FILE* file, const size_t* key_indices, FILE** partitions, size_t n_partitions)
+{
+    char* line = NULL;
+    size_t len = 0;
+    ssize_t read;
+    while ((read = getline(&line, &len, file)) != -1)
+    {
+        // split a copy so the original bytes can be written out
+        ctx->row.len = 0;
+        csv_join_append(&ctx->row, line, read);
+        csv_join_append(&ctx->row, "", 1);
+        size_t n_fields = csv_join_split(ctx, ctx->row.data, read);
+
+        size_t partition = 0;
+        if (csv_join_make_key(ctx, n_fields, key_indices))
+            partition = csv_hash(ctx->key.data, ctx->key.len, CSV_JOIN_PARTITION_SEED) % n_partitions;
+
+        fwrite(line, 1, read, partitions[partition]);
+        if (line[read - 1] != '\n')
+            fputc('\n', partitions[partition]);
+    }
+
+    // getline() buffer
+    free(line);
+}
+
+static FILE* csv_join_temp_file(void)
+{
+    FILE* file = tmpfile();
+    if (file == NULL)
+    {
+        printf("Could not create a temporary file!\n");
+        exit(-1);
+    }
+    return file;
+}
+
+static void csv_join_files(csv_join_context* ctx, FILE* left, FILE* right, size_t memory_budget)
+{
+    struct stat left_stat;
+    struct stat right_stat;
+    fstat(fileno(left), &left_stat);
+    fstat(fileno(right), &right_stat);
+    ctx->build_left = left_stat.st_size < right_stat.st_size;
+
+    FILE* build = ctx->build_left ? left : right;
+    FILE* probe = ctx->build_left ? right : left;
+    size_t build_size = ctx->build_left ? left_stat.st_size : right_stat.st_size;
+    long build_start = ftell(build);
+
+    csv_join_table table;
+    memset(&table, 0, sizeof(csv_join_table));
+    if (csv_join_build(ctx, build, &table, memory_budget))
+    {
+        csv_join_probe(ctx, probe, &table);
+        csv_join_finish(ctx, &table);
+        csv_join_free_table(&table);
+        return;
+    }
+    csv_join_free_table(&table);
+    fseek(build, build_start, SEEK_SET);
+
+    // grace hash join: equal keys land in the same partition pair, and each build partition should fit the budget
+    size_t n_partitions = build_size / (memory_budget / 2 > 0 ? memory_budget / 2 : 1) + 1;
+    if (n_partitions < 2)
+        n_partitions = 2;
+    if (n_partitions > CSV_JOIN_MAX_PARTITIONS)
+        n_partitions = CSV_JOIN_MAX_PARTITIONS;
+
+    FILE** build_partitions = csv_malloc(sizeof(FILE*) * n_partitions);
+    FILE** probe_partitions = csv_malloc(sizeof(FILE*) * n_partitions);
+    for (size_t p = 0; p < n_partitions; ++p)
+    {
+        build_partitions[p] = csv_join_temp_file();
+        probe_partitions[p] = csv_join_temp_file();
+    }
+    csv_join_partition(ctx, build, ctx->build_left ? ctx->left_keys : ctx->right_keys, build_partitions, n_partitions);
+    csv_join_partition(ctx, probe, ctx->build_left ? ctx->right_keys : ctx->left_keys, probe_partitions, n_partitions);
+
+    for (size_t p = 0; p < n_partitions; ++p)
+    {
+        rewind(build_partitions[p]);
+        rewind(probe_partitions[p]);
+
+        // a partition is loaded whatever its size: heavily repeated keys cannot be split further
+        csv_join_build(ctx, build_partitions[p], &table, SIZE_MAX);
+        csv_join_probe(ctx, probe_partitions[p], &table);
+        csv_join_finish(ctx, &table);
+        csv_join_free_table(&table);
+
+        fclose(build_partitions[p]);
+        fclose(probe_partitions[p]);
+    }
+    csv_dealloc(build_partitions);
+    csv_dealloc(probe_partitions);
+}
+
+void csv_join(const char* left_filename, const char* right_filename, char** key_columns, size_t n_keys, csv_join_type type, const char* output_filename, size_t memory_budget, char delim)
+{
+    FILE* left = fopen(left_filename, "r");
+    FILE* right = fopen(right_filename, "r");
+    if (left == NULL || right == NULL)
+    {
+        printf("File not found!\n");
+        exit(-1);
+    }
+
+    // resolve the names against each header; unknown columns never match
+    size_t* left_key_indices = csv_malloc(sizeof(size_t) * (n_keys > 0 ? n_keys : 1));
+    size_t* right_key_indices = csv_malloc(sizeof(size_t) * (n_keys > 0 ? n_keys : 1));
+    csv_find_columns(left, delim, key_columns, n_keys, left_key_indices);
+    csv_find_columns(right, delim, key_columns, n_keys, right_key_indices);
+    fclose(left);
+    fclose(right);
+
+    csv_join_by_index(left_filename, right_filename, left_key_indices, right_key_indices, n_keys, type, output_filename, memory_budget, delim, true);
+
+    csv_dealloc(left_key_indices);
+    csv_dealloc(right_key_indices);
+}
+
+void csv_join_by_index(const char* left_filename, const char* right_filename, size_t* left_key_indices, size_t* right_key_indices, size_t n_keys, csv_join_type type, const char* output_filename, size_t memory_budget, char delim, bool has_headers)
+{
+    FILE* left = fopen(left_filename, "r");
+    FILE* right = fopen(right_filename, "r");
+    if (left == NULL || right == NULL)
+    {
+        printf("File not found!\n");
+        exit(-1);
+    }
+    FILE* output = fopen(output_filename, "w");
+    if (output == NULL)
+    {
+        printf("Could not write %s!\n", output_filename);
+        exit(-1);
+    }
+
+    csv_join_context ctx;
+    memset(&ctx, 0, sizeof(csv_join_context));
+    ctx.left_keys = left_key_indices;
+    ctx.right_keys = right_key_indices;
+    ctx.n_keys = n_keys;
+    ctx.type = type;
+    ctx.delim = delim;
+    ctx.output = output;
+    csv_skip_bom(left);
+    csv_skip_bom(right);
+
+    // the right file's first line gives its column count; header lines are joined the same way as rows
+    char* line = NULL;
+    size_t len = 0;
+    ssize_t read;
+    if (has_headers)
+    {
+        ctx.row.len = 0;
+        if ((read = getline(&line, &len, left)) != -1)
+            csv_join_append_left(&ctx, csv_join_split(&ctx, line, read));
+        if ((read = getline(&line, &len, right)) != -1)
+        {
+            size_t n_fields = csv_join_split(&ctx, line, read);
+            ctx.n_right_columns = n_fields;
+            if (type != CSV_JOIN_SEMI)
+                csv_join_append_right(&ctx, n_fields);
+        }
+        csv_join_append(&ctx.row, "\n", 1);
+        fwrite(ctx.row.data, 1, ctx.row.len, output);
+    }
+    else
+    {
+        if ((read = getline(&line, &len, right)) != -1)
+            ctx.n_right_columns = csv_count_columns(line, delim);
+        rewind(right);
+        csv_skip_bom(right);
+    }
+    free(line);
+
+    csv_join_files(&ctx, left, right, memory_budget > 0 ? memory_budget : CSV_JOIN_DEFAULT_BUDGET);
+
+    csv_dealloc(ctx.fields);
+    csv_dealloc(ctx.key.data);
+    csv_dealloc(ctx.row.data);
+    fclose(left);
+    fclose(right);
+    fclose(output);
+}
@@ -0,0 +1,278 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "csvinternal.h"
+#include "keyindex/keyindex.h"
+
+#define CSV_KEY_MAGIC "CSVKIDX1"
+#define CSV_KEY_SUFFIX ".keyidx"
+#define CSV_KEY_OFFSET_BITS 48
+#define CSV_KEY_OFFSET_MASK (((uint64_t)1 << CSV_KEY_OFFSET_BITS) - 1)
+#define CSV_KEY_READ_CHUNK 4096
+
+// sidecar layout (native endianness): csv_key_header, then uint64_t slots[n_slots]
+// a slot is 0 when empty, otherwise the top 16 bits of the key's hash above the row's byte offset + 1
+typedef struct csv_key_header
+{
+    char magic[8];
+    uint64_t source_size;
+    int64_t source_mtime_sec;
+    int64_t source_mtime_nsec;
+    uint64_t delim;
+    uint64_t key_column;
+    uint64_t n_slots;
+    uint64_t n_keys;
+} csv_key_header;
+
+static char* csv_key_path(const char* filename)
+{
+    char* path = csv_malloc(strlen(filename) + strlen(CSV_KEY_SUFFIX) + 1);
+    strcpy(path, filename);
+    strcat(path, CSV_KEY_SUFFIX);
+    return path;
+}
+
+static FILE* csv_key_open(const char* filename, const char* key_column, char delim, size_t* key_index, size_t* n_columns)
+{
+    FILE* file = fopen(filename, "r");
+    if (file == NULL)
+    {
+        printf("File not found!\n");
+        exit(-1);
+    }
+    char* names[1] = { (char*)key_column };
+    *n_columns = csv_find_columns(file, delim, names, 1, key_index);
+    return file;
+}
+
+// the key cell of a line; a missing cell is the same as an empty one
+static void csv_key_cell(const char* line, size_t len, char delim, size_t key_index, const char** cell, size_t* cell_len)
+{
+    if (!csv_find_cell(line, len, delim, key_index, cell, cell_len))
+    {
+        *cell = "";
+        *cell_len = 0;
+    }
+}
+
+void csv_build_key_index(const char* filename, const char* key_column, char delim)
+{
+    size_t key_index;
+    size_t n_columns;
+    FILE* file = csv_key_open(filename, key_column, delim, &key_index, &n_columns);
+    size_t data_start = ftell(file);
+    struct stat source_stat;
+    fstat(fileno(file), &source_stat);
+    size_t size = source_stat.st_size;
+
+    // slots hold row offsets below CSV_KEY_OFFSET_MASK, so a larger file cannot be indexed at all
+    char* path = csv_key_path(filename);
+    if (size > CSV_KEY_OFFSET_MASK)
+    {
+        printf("Could not write %s!\n", path);
+        exit(-1);
+    }
+
+    const char* map = NULL;
+    if (size > 0)
+    {
+        map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+        if (map == MAP_FAILED)
+        {
+            printf("File not found!\n");
+            exit(-1);
+        }
+    }
+    fclose(file);
+
+    // the line count bounds the number of keys, which sizes the table to at most 3/4 full
+    size_t n_lines = 0;
+    for (const char* c = map; c != NULL && (size_t)(c - map) < size; ++n_lines)
+    {
+        c = memchr(c, '\n', size - (c - map));
+        if (c != NULL)
+            c++;
+    }
+    uint64_t n_slots = 16;
+    while (n_slots < n_lines + n_lines / 3 + 1)
+        n_slots *= 2;
+    uint64_t* slots = csv_calloc(n_slots, sizeof(uint64_t));
+
+    // rows are inserted in file order, so duplicate keys are probed in file order too
+    uint64_t n_keys = 0;
+    size_t start = data_start;
+    while (key_index != SIZE_MAX && start < size)
+    {
+        const char* newline = memchr(map + start, '\n', size - start);
+        size_t line_end = newline != NULL ? (size_t)(newline - map) + 1 : size;
+        const char* cell;
+        size_t cell_len;
+        csv_key_cell(map + start, line_end - start, delim, key_index, &cell, &cell_len);
+
+        uint64_t hash = csv_hash(cell, cell_len, 0);
+        uint64_t slot = hash & (n_slots - 1);
+        while (slots[slot] != 0)
+            slot = (slot + 1) & (n_slots - 1);
+        slots[slot] = (hash & ~CSV_KEY_OFFSET_MASK) | ((uint64_t)start + 1);
+        n_keys++;
+        start = line_end;
+    }
+    if (map != NULL)
+        munmap((void*)map, size);
+
+    csv_key_header header;
+    memset(&header, 0, sizeof(csv_key_header));
+    memcpy(header.magic, CSV_KEY_MAGIC, 8);
+    header.source_size = source_stat.st_size;
+    header.source_mtime_sec = source_stat.st_mtim.tv_sec;
+    header.source_mtime_nsec = source_stat.st_mtim.tv_nsec;
+    header.delim = (unsigned char)delim;
+    header.key_column = key_index;
+    header.n_slots = n_slots;
+    header.n_keys = n_keys;
+
+    // written to a temporary file and renamed into place so readers never see a partial index
+    char* tmp_path;
+    int fd = csv_create_temp_file(path, &tmp_path);
+    FILE* sidecar = fd != -1 ? fdopen(fd, "wb") : NULL;
+    if (sidecar == NULL)
+    {
+        if (fd != -1)
+            unlink(tmp_path);
+        printf("Could not write %s!\n", path);
+        exit(-1);
+    }
+    fwrite(&header, sizeof(csv_key_header), 1, sidecar);
+    fwrite(slots, sizeof(uint64_t), n_slots, sidecar);
+    fclose(sidecar);
+    rename(tmp_path, path);
+
+    csv_dealloc(slots);
+    csv_dealloc(tmp_path);
+    csv_dealloc(path);
+}
+
+// maps the key index if it describes this version of the file and this key column
+static const csv_key_header* csv_key_load(const char* filename, const struct stat* source_stat, char delim, size_t key_index, size_t* map_size)
+{
+    char* path = csv_key_path(filename);
+    int fd = open(path, O_RDONLY);
+    csv_dealloc(path);
+    struct stat index_stat;
+    if (fd == -1 || fstat(fd, &index_stat) == -1 || (size_t)index_stat.st_size < sizeof(csv_key_header))
+    {
+        if (fd != -1)
+            close(fd);
+        return NULL;
+    }
+
+    *map_size = index_stat.st_size;
+    const csv_key_header* header = mmap(NULL, *map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (header == MAP_FAILED)
+        return NULL;
+
+    if (memcmp(header->magic, CSV_KEY_MAGIC, 8) == 0
+        && header->source_size == (uint64_t)source_stat->st_size
+        && header->source_mtime_sec == (int64_t)source_stat->st_mtim.tv_sec
+        && header->source_mtime_nsec == (int64_t)source_stat->st_mtim.tv_nsec
+        && header->delim == (uint64_t)(unsigned char)delim
+        && header->key_column == (uint64_t)key_index
+        && *map_size == sizeof(csv_key_header) + header->n_slots * sizeof(uint64_t))
+        return header;
+
+    munmap((void*)header, *map_size);
+    return NULL;
+}
+
+// reads the line starting at offset into buffer; returns its length including the newline
+static size_t csv_key_read_line(int fd, uint64_t offset, char** buffer, size_t* capacity)
+{
+    size_t len = 0;
+    for (;;)
+    {
+        if (*capacity - len < CSV_KEY_READ_CHUNK)
+        {
+            *capacity = *capacity * 2 > len + CSV_KEY_READ_CHUNK ? *capacity * 2 : len + CSV_KEY_READ_CHUNK;
+            *buffer = csv_realloc(*buffer, *capacity);
+        }
+        ssize_t n_read = pread(fd, *buffer + len, CSV_KEY_READ_CHUNK, offset + len);
+        if (n_read <= 0)
+            return len;
+        const char* newline = memchr(*buffer + len, '\n', n_read);
+        if (newline != NULL)
+            return (size_t)(newline - *buffer) + 1;
+        len += n_read;
+    }
+}
+
+// adds the line as a row if its key cell is exactly key
+static void csv_key_match(const char* line, size_t len, char delim, size_t key_index, const char* key, size_t key_len,
+                          char**** data, size_t* n_rows, size_t* rows_capacity)
+{
+    const char* cell;
+    size_t cell_len;
+    csv_key_cell(line, len, delim, key_index, &cell, &cell_len);
+    if (cell_len != key_len || memcmp(cell, key, key_len) != 0)
+        return;
+
+    if (*n_rows == *rows_capacity)
+    {
+        *rows_capacity *= 2;
+        (*data) = csv_realloc((*data), sizeof(char**) * (*rows_capacity));
+    }
+    csv_parse_line_n(line, len, delim, &(*data)[(*n_rows)++]);
+}
+
+void csv_lookup(const char* filename, const char* key_column, const char* key, char**** data, size_t (*data_dims)[2], char delim)
+{
+    size_t key_index;
+    size_t n_columns;
+    FILE* file = csv_key_open(filename, key_column, delim, &key_index, &n_columns);
+    struct stat source_stat;
+    fstat(fileno(file), &source_stat);
+
+    size_t rows_capacity = 10;
+    size_t n_rows = 0;
+    (*data) = csv_calloc(rows_capacity, sizeof(char**));
+    size_t key_len = strlen(key);
+
+    // an unknown column matches nothing
+    size_t map_size;
+    const csv_key_header* header = key_index != SIZE_MAX ? csv_key_load(filename, &source_stat, delim, key_index, &map_size) : NULL;
+    if (header != NULL)
+    {
+        // every row whose key shares the hash's top bits is read and compared, so collisions cost a read but never a wrong row
+        const uint64_t* slots = (const uint64_t*)(header + 1);
+        uint64_t hash = csv_hash(key, key_len, 0);
+        uint64_t slot = hash & (header->n_slots - 1);
+        char* buffer = NULL;
+        size_t capacity = 0;
+        for (; slots[slot] != 0; slot = (slot + 1) & (header->n_slots - 1))
+        {
+            if ((slots[slot] & ~CSV_KEY_OFFSET_MASK) != (hash & ~CSV_KEY_OFFSET_MASK))
+                continue;
+            uint64_t offset = (slots[slot] & CSV_KEY_OFFSET_MASK) - 1;
+            size_t len = csv_key_read_line(fileno(file), offset, &buffer, &capacity);
+            csv_key_match(buffer, len, delim, key_index, key, key_len, data, &n_rows, &rows_capacity);
+        }
+        csv_dealloc(buffer);
+        munmap((void*)header, map_size);
+    }
+    else if (key_index != SIZE_MAX)
+    {
+        char* line = NULL;
+        size_t len = 0;
+        ssize_t read;
+        while ((read = getline(&line, &len, file)) != -1)
+            csv_key_match(line, read, delim, key_index, key, key_len, data, &n_rows, &rows_capacity);
+        // getline() buffer
+        free(line);
+    }
+    fclose(file);
+
+    (*data_dims)[0] = n_rows;
+    (*data_dims)[1] = n_columns;
+}
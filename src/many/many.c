@@ -0,0 +1,194 @@
+#include "csvinternal.h"
+#include "many/many.h"
+#include "read/read.h"
+#include "select/select.h"
+#include "cast/cast.h"
+#include "free/free.h"
+
+typedef enum csv_many_source
+{
+    CSV_MANY_READ,
+    CSV_MANY_SELECT_BY_INDEX,
+    CSV_MANY_SELECT_BY_NAME
+} csv_many_source;
+
+typedef enum csv_many_type
+{
+    CSV_MANY_STRING,
+    CSV_MANY_INT,
+    CSV_MANY_FLOAT
+} csv_many_type;
+
+// what one worker produced for one file. rows is the file's char***, int** or float** row array
+typedef struct csv_many_file
+{
+    void** rows;
+    size_t data_dims[2];
+    char** headers;
+    size_t n_headers;
+} csv_many_file;
+
+typedef struct csv_many_job
+{
+    char** filenames;
+    csv_many_file* files;
+    csv_many_source source;
+    csv_many_type type;
+    size_t* column_indices;
+    char** column_names;
+    size_t n_columns;
+    char delim;
+    bool has_headers;
+} csv_many_job;
+
+static void csv_many_task(void* context, size_t index)
+{
+    csv_many_job* job = context;
+    csv_many_file* file = &job->files[index];
+    const char* filename = job->filenames[index];
+    char*** s_data = NULL;
+
+    file->headers = NULL;
+    file->n_headers = 0;
+    if (job->has_headers)
+        file->n_headers = csv_get_column_names(filename, job->delim, &file->headers);
+
+    switch (job->source)
+    {
+        case CSV_MANY_READ:
+            csv_read(filename, &s_data, &file->data_dims, job->delim, job->has_headers);
+            break;
+        case CSV_MANY_SELECT_BY_INDEX:
+            csv_select_by_index(filename, job->column_indices, job->n_columns, &s_data, &file->data_dims, job->delim, job->has_headers);
+            break;
+        case CSV_MANY_SELECT_BY_NAME:
+            csv_select_by_name(filename, job->column_names, job->n_columns, &s_data, &file->data_dims, job->delim);
+            break;
+    }
+
+    // cast inside the worker so the conversion is parallel too
+    if (job->type == CSV_MANY_INT)
+    {
+        int** int_data = NULL;
+        csv_data_to_int(s_data, file->data_dims, &int_data);
+        csv_free(&s_data, file->data_dims);
+        file->rows = (void**)int_data;
+    }
+    else if (job->type == CSV_MANY_FLOAT)
+    {
+        float** float_data = NULL;
+        csv_data_to_float(s_data, file->data_dims, &float_data);
+        csv_free(&s_data, file->data_dims);
+        file->rows = (void**)float_data;
+    }
+    else
+        file->rows = (void**)s_data;
+}
+
+static bool csv_many_same_headers(const csv_many_file* a, const csv_many_file* b)
+{
+    if (a->n_headers != b->n_headers)
+        return false;
+    for (size_t i = 0; i < a->n_headers; ++i)
+        if (strcmp(a->headers[i], b->headers[i]) != 0)
+            return false;
+    return true;
+}
+
+// parses every file on the pool then moves the per-file row arrays into one array, without copying any cells
+static void** csv_many_run(csv_many_job* job, size_t n_files, size_t (*data_dims)[2], size_t n_threads)
+{
+    job->files = csv_calloc(n_files > 0 ? n_files : 1, sizeof(csv_many_file));
+    csv_parallel_for(n_files, n_threads, &csv_many_task, job);
+
+    size_t total_rows = 0;
+    for (size_t f = 0; f < n_files; ++f)
+    {
+        const csv_many_file* file = &job->files[f];
+        bool matches = job->has_headers ? csv_many_same_headers(file, &job->files[0]) : file->data_dims[1] == job->files[0].data_dims[1];
+        if (!matches)
+        {
+            printf("Columns of %s do not match %s!\n", job->filenames[f], job->filenames[0]);
+            exit(-1);
+        }
+        total_rows += file->data_dims[0];
+    }
+
+    // the output is allocated exactly once
+    void** rows = csv_malloc(sizeof(void*) * (total_rows > 0 ? total_rows : 1));
+    size_t current_row = 0;
+    for (size_t f = 0; f < n_files; ++f)
+    {
+        csv_many_file* file = &job->files[f];
+        memcpy(&rows[current_row], file->rows, sizeof(void*) * file->data_dims[0]);
+        current_row += file->data_dims[0];
+
+        csv_dealloc(file->rows);
+        if (file->headers != NULL)
+            csv_free_column(&file->headers, file->n_headers);
+    }
+
+    (*data_dims)[0] = total_rows;
+    (*data_dims)[1] = n_files > 0 ? job->files[0].data_dims[1] : 0;
+    csv_dealloc(job->files);
+    return rows;
+}
+
+static void** csv_many(char** filenames, size_t n_files, csv_many_source source, csv_many_type type, size_t* column_indices, char** column_names, size_t n_columns, size_t (*data_dims)[2], char delim, bool has_headers, size_t n_threads)
+{
+    csv_many_job job;
+    job.filenames = filenames;
+    job.source = source;
+    job.type = type;
+    job.column_indices = column_indices;
+    job.column_names = column_names;
+    job.n_columns = n_columns;
+    job.delim = delim;
+    job.has_headers = has_headers;
+    return csv_many_run(&job, n_files, data_dims, n_threads);
+}
+
+void csv_read_many(char** filenames, size_t n_files, char**** data, size_t (*data_dims)[2], char delim, bool has_headers, size_t n_threads)
+{
+    (*data) = (char***)csv_many(filenames, n_files, CSV_MANY_READ, CSV_MANY_STRING, NULL, NULL, 0, data_dims, delim, has_headers, n_threads);
+}
+
+void csv_read_many_int(char** filenames, size_t n_files, int*** data, size_t (*data_dims)[2], char delim, bool has_headers, size_t n_threads)
+{
+    (*data) = (int**)csv_many(filenames, n_files, CSV_MANY_READ, CSV_MANY_INT, NULL, NULL, 0, data_dims, delim, has_headers, n_threads);
+}
+
+void csv_read_many_float(char** filenames, size_t n_files, float*** data, size_t (*data_dims)[2], char delim, bool has_headers, size_t n_threads)
+{
+    (*data) = (float**)csv_many(filenames, n_files, CSV_MANY_READ, CSV_MANY_FLOAT, NULL, NULL, 0, data_dims, delim, has_headers, n_threads);
+}
+
+void csv_select_many_by_index(char** filenames, size_t n_files, size_t* column_indices, size_t n_columns, char**** data, size_t (*data_dims)[2], char delim, bool has_headers, size_t n_threads)
+{
+    (*data) = (char***)csv_many(filenames, n_files, CSV_MANY_SELECT_BY_INDEX, CSV_MANY_STRING, column_indices, NULL, n_columns, data_dims, delim, has_headers, n_threads);
+}
+
+void csv_select_many_by_index_as_float(char** filenames, size_t n_files, size_t* column_indices, size_t n_columns, float*** data, size_t (*data_dims)[2], char delim, bool has_headers, size_t n_threads)
+{
+    (*data) = (float**)csv_many(filenames, n_files, CSV_MANY_SELECT_BY_INDEX, CSV_MANY_FLOAT, column_indices, NULL, n_columns, data_dims, delim, has_headers, n_threads);
+}
+
+void csv_select_many_by_index_as_int(char** filenames, size_t n_files, size_t* column_indices, size_t n_columns, int*** data, size_t (*data_dims)[2], char delim, bool has_headers, size_t n_threads)
+{
+    (*data) = (int**)csv_many(filenames, n_files, CSV_MANY_SELECT_BY_INDEX, CSV_MANY_INT, column_indices, NULL, n_columns, data_dims, delim, has_headers, n_threads);
+}
+
+void csv_select_many_by_name(char** filenames, size_t n_files, char** column_names, size_t n_columns, char**** data, size_t (*data_dims)[2], char delim, size_t n_threads)
+{
+    (*data) = (char***)csv_many(filenames, n_files, CSV_MANY_SELECT_BY_NAME, CSV_MANY_STRING, NULL, column_names, n_columns, data_dims, delim, true, n_threads);
+}
+
+void csv_select_many_by_name_as_float(char** filenames, size_t n_files, char** column_names, size_t n_columns, float*** data, size_t (*data_dims)[2], char delim, size_t n_threads)
+{
+    (*data) = (float**)csv_many(filenames, n_files, CSV_MANY_SELECT_BY_NAME, CSV_MANY_FLOAT, NULL, column_names, n_columns, data_dims, delim, true, n_threads);
+}
+
+void csv_select_many_by_name_as_int(char** filenames, size_t n_files, char** column_names, size_t n_columns, int*** data, size_t (*data_dims)[2], char delim, size_t n_threads)
+{
+    (*data) = (int**)csv_many(filenames, n_files, CSV_MANY_SELECT_BY_NAME, CSV_MANY_INT, NULL, column_names, n_columns, data_dims, delim, true, n_threads);
+}
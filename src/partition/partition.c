@@ -0,0 +1,341 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "csvinternal.h"
+#include "partition/partition.h"
+
+// a partition's rows are written once its buffer holds this much
+#define CSV_PARTITION_BUFFER (64 * 1024)
+// when the buffers of all partitions together take more than this, they are all written and freed
+#define CSV_PARTITION_MEMORY (64 * 1024 * 1024)
+#define CSV_PARTITION_OPEN_FILES 64
+// longest value used as is in a file name
+#define CSV_PARTITION_NAME_LENGTH 100
+
+typedef struct csv_partition_file
+{
+    char* path;
+    char* buffer;
+    size_t len;
+    size_t capacity;
+    int fd;
+    bool created;
+    size_t last_used;
+} csv_partition_file;
+
+typedef struct csv_partitioner
+{
+    const char* output_dir;
+    size_t n_buckets;
+    size_t max_open_files;
+    char* header;
+    size_t header_len;
+
+    csv_partition_file* files;
+    size_t n_files;
+    size_t files_capacity;
+    size_t memory;
+
+    // by value: the value of each partition and a table to find it; by hash: the partition of each bucket
+    char** keys;
+    size_t* key_lens;
+    csv_hash_table values;
+    size_t* buckets;
+    csv_arena arena;
+
+    // the partitions whose files are open; the least recently written is closed first
+    size_t* open;
+    size_t n_open;
+    size_t clock;
+} csv_partitioner;
+
+static void csv_partition_write(const char* path, int fd, const char* data, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t n_written = write(fd, data, len);
+        if (n_written < 0 && errno == EINTR)
+            continue;
+        if (n_written <= 0)
+        {
+            printf("Could not write %s!\n", path);
+            exit(-1);
+        }
+        data += n_written;
+        len -= n_written;
+    }
+}
+
+static void csv_partition_flush(csv_partitioner* partitioner, size_t index)
+{
+    csv_partition_file* file = &partitioner->files[index];
+    if (file->len == 0 && file->created)
+        return;
+
+    if (file->fd == -1)
+    {
+        if (partitioner->n_open == partitioner->max_open_files)
+        {
+            size_t oldest = 0;
+            for (size_t i = 1; i < partitioner->n_open; ++i)
+                if (partitioner->files[partitioner->open[i]].last_used < partitioner->files[partitioner->open[oldest]].last_used)
+                    oldest = i;
+            csv_partition_file* evicted = &partitioner->files[partitioner->open[oldest]];
+            close(evicted->fd);
+            evicted->fd = -1;
+            partitioner->open[oldest] = partitioner->open[--partitioner->n_open];
+        }
+
+        // the first open creates the file (replacing an old one) and writes the header; later opens append
+        file->fd = open(file->path, O_WRONLY | O_CREAT | (file->created ? O_APPEND : O_TRUNC), 0644);
+        if (file->fd == -1)
+        {
+            printf("Could not write %s!\n", file->path);
+            exit(-1);
+        }
+        partitioner->open[partitioner->n_open++] = index;
+        if (!file->created)
+        {
+            csv_partition_write(file->path, file->fd, partitioner->header, partitioner->header_len);
+            file->created = true;
+        }
+    }
+
+    file->last_used = ++partitioner->clock;
+    csv_partition_write(file->path, file->fd, file->buffer, file->len);
+    file->len = 0;
+}
+
+static void csv_partition_flush_all(csv_partitioner* partitioner, bool release)
+{
+    for (size_t p = 0; p < partitioner->n_files; ++p)
+    {
+        csv_partition_flush(partitioner, p);
+        if (release)
+        {
+            csv_dealloc(partitioner->files[p].buffer);
+            partitioner->files[p].buffer = NULL;
+            partitioner->files[p].capacity = 0;
+        }
+    }
+    if (release)
+        partitioner->memory = 0;
+}
+
+static void csv_partition_append(csv_partitioner* partitioner, size_t index, const char* row, size_t len)
+{
+    csv_partition_file* file = &partitioner->files[index];
+    bool newline = len == 0 || row[len - 1] != '\n';
+    size_t needed = file->len + len + (newline ? 1 : 0);
+    if (needed > file->capacity)
+    {
+        size_t capacity = file->capacity == 0 ? 4096 : file->capacity * 2;
+        if (capacity < needed)
+            capacity = needed;
+        partitioner->memory += capacity - file->capacity;
+        file->buffer = csv_realloc(file->buffer, capacity);
+        file->capacity = capacity;
+    }
+
+    // the last row of the input may lack its newline, but it is not the last row of its partition file
+    memcpy(file->buffer + file->len, row, len);
+    file->len += len;
+    if (newline)
+        file->buffer[file->len++] = '\n';
+
+    if (file->len >= CSV_PARTITION_BUFFER)
+        csv_partition_flush(partitioner, index);
+    else if (partitioner->memory > CSV_PARTITION_MEMORY)
+        csv_partition_flush_all(partitioner, true);
+}
+
+static size_t csv_partition_add(csv_partitioner* partitioner, char* path)
+{
+    if (partitioner->n_files == partitioner->files_capacity)
+    {
+        partitioner->files_capacity *= 2;
+        partitioner->files = csv_realloc(partitioner->files, sizeof(csv_partition_file) * partitioner->files_capacity);
+        partitioner->keys = csv_realloc(partitioner->keys, sizeof(char*) * partitioner->files_capacity);
+        partitioner->key_lens = csv_realloc(partitioner->key_lens, sizeof(size_t) * partitioner->files_capacity);
+    }
+
+    size_t index = partitioner->n_files++;
+    csv_partition_file* file = &partitioner->files[index];
+    memset(file, 0, sizeof(csv_partition_file));
+    file->path = path;
+    file->fd = -1;
+    return index;
+}
+
+// output_dir/name.csv, where name is the value with unsafe characters replaced (and a hash of the value appended if anything had to be replaced)
+static char* csv_partition_value_path(const csv_partitioner* partitioner, const char* value, size_t len)
+{
+    const char* name = len > 0 ? value : "(null)";
+    size_t name_len = len > 0 ? len : 6;
+    bool changed = name_len > CSV_PARTITION_NAME_LENGTH;
+    if (changed)
+        name_len = CSV_PARTITION_NAME_LENGTH;
+
+    size_t dir_len = strlen(partitioner->output_dir);
+    char* path = csv_malloc(dir_len + 1 + name_len + 17 + 5);
+    char* c = path + dir_len + 1;
+    memcpy(path, partitioner->output_dir, dir_len);
+    path[dir_len] = '/';
+    for (size_t i = 0; i < name_len; ++i)
+    {
+        char ch = name[i];
+        bool safe = (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9') || ch == '.' || ch == '_' || ch == '-';
+        *c++ = safe ? ch : '_';
+        changed = changed || !safe;
+    }
+    if (changed)
+        c += sprintf(c, "-%016llx", (unsigned long long)csv_hash(value, len, 0));
+    strcpy(c, ".csv");
+    return path;
+}
+
+// returns the partition of the value of len bytes, creating it the first time the value is seen
+static size_t csv_partition_of_value(csv_partitioner* partitioner, const char* value, size_t len)
+{
+    uint64_t hash = csv_hash(value, len, 0);
+    if (partitioner->n_buckets > 0)
+    {
+        size_t bucket = hash % partitioner->n_buckets;
+        if (partitioner->buckets[bucket] == SIZE_MAX)
+        {
+            char* path = csv_malloc(strlen(partitioner->output_dir) + 32);
+            sprintf(path, "%s/part-%05zu.csv", partitioner->output_dir, bucket);
+            partitioner->buckets[bucket] = csv_partition_add(partitioner, path);
+        }
+        return partitioner->buckets[bucket];
+    }
+
+    size_t pos = csv_hash_table_start(&partitioner->values, hash);
+    size_t partition;
+    while ((partition = csv_hash_table_next(&partitioner->values, hash, &pos)) != SIZE_MAX)
+        if (partitioner->key_lens[partition] == len && memcmp(partitioner->keys[partition], value, len) == 0)
+            return partition;
+
+    partition = csv_partition_add(partitioner, csv_partition_value_path(partitioner, value, len));
+    partitioner->keys[partition] = csv_arena_alloc(&partitioner->arena, len + 1);
+    memcpy(partitioner->keys[partition], value, len);
+    partitioner->key_lens[partition] = len;
+    csv_hash_table_insert(&partitioner->values, hash, pos, partition);
+
+    return partition;
+}
+
+void csv_partition(const char* filename, const char* key_column, const char* output_dir, size_t n_buckets, size_t max_open_files, char*** partition_files, size_t* n_partitions, char delim)
+{
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1)
+    {
+        printf("File not found!\n");
+        exit(-1);
+    }
+
+    csv_partitioner partitioner;
+    memset(&partitioner, 0, sizeof(csv_partitioner));
+    partitioner.output_dir = output_dir;
+    partitioner.n_buckets = n_buckets;
+    partitioner.max_open_files = max_open_files > 0 ? max_open_files : CSV_PARTITION_OPEN_FILES;
+    partitioner.open = csv_malloc(sizeof(size_t) * partitioner.max_open_files);
+    partitioner.files_capacity = 16;
+    partitioner.files = csv_malloc(sizeof(csv_partition_file) * partitioner.files_capacity);
+    partitioner.keys = csv_malloc(sizeof(char*) * partitioner.files_capacity);
+    partitioner.key_lens = csv_malloc(sizeof(size_t) * partitioner.files_capacity);
+    csv_hash_table_init(&partitioner.values, 64);
+    if (n_buckets > 0)
+    {
+        partitioner.buckets = csv_malloc(sizeof(size_t) * n_buckets);
+        for (size_t b = 0; b < n_buckets; ++b)
+            partitioner.buckets[b] = SIZE_MAX;
+    }
+
+    csv_source source = csv_source_from_fd(fd);
+    csv_reader reader;
+    csv_reader_init(&reader, &source);
+
+    // records rather than lines, so a quoted newline never splits a row between files
+    const char* record;
+    size_t len;
+    size_t column_index = SIZE_MAX;
+    if (csv_reader_next_record(&reader, &record, &len))
+    {
+        partitioner.header = csv_malloc(len + 1);
+        memcpy(partitioner.header, record, len);
+        partitioner.header_len = len;
+        if (len == 0 || record[len - 1] != '\n')
+            partitioner.header[partitioner.header_len++] = '\n';
+
+        char** columns;
+        size_t n_columns = csv_parse_line_n(record, csv_header_length(record, len), delim, &columns);
+        for (size_t c = 0; c < n_columns; ++c)
+        {
+            if (column_index == SIZE_MAX && strcmp(columns[c], key_column) == 0)
+                column_index = c;
+            csv_dealloc(columns[c]);
+        }
+        csv_dealloc(columns);
+    }
+    if (column_index != SIZE_MAX)
+        mkdir(output_dir, 0777);
+
+    char* value = NULL;
+    size_t value_capacity = 0;
+    while (column_index != SIZE_MAX && csv_reader_next_record(&reader, &record, &len))
+    {
+        const char* cell;
+        size_t cell_len;
+        if (!csv_find_cell(record, len, delim, column_index, &cell, &cell_len))
+            cell_len = 0;
+        else if (cell_len > 0 && cell[cell_len - 1] == '\r' && cell + cell_len + 1 >= record + len)
+            cell_len--;
+
+        // a quoted value is compared without its quotes, so "a" and a are the same partition
+        const char* key = cell;
+        if (cell_len >= 2 && cell[0] == '\"' && cell[cell_len - 1] == '\"')
+        {
+            if (cell_len > value_capacity)
+            {
+                value_capacity = cell_len * 2;
+                value = csv_realloc(value, value_capacity);
+            }
+            size_t value_len = 0;
+            for (size_t i = 1; i + 1 < cell_len; ++i)
+            {
+                value[value_len++] = cell[i];
+                if (cell[i] == '\"' && cell[i + 1] == '\"')
+                    i++;
+            }
+            key = value;
+            cell_len = value_len;
+        }
+
+        csv_partition_append(&partitioner, csv_partition_of_value(&partitioner, key, cell_len), record, len);
+    }
+    csv_reader_free(&reader);
+    close(fd);
+
+    csv_partition_flush_all(&partitioner, true);
+    for (size_t i = 0; i < partitioner.n_open; ++i)
+        close(partitioner.files[partitioner.open[i]].fd);
+
+    // the paths are handed to the caller
+    (*partition_files) = csv_malloc(sizeof(char*) * (partitioner.n_files > 0 ? partitioner.n_files : 1));
+    for (size_t p = 0; p < partitioner.n_files; ++p)
+        (*partition_files)[p] = partitioner.files[p].path;
+    *n_partitions = partitioner.n_files;
+
+    csv_dealloc(value);
+    csv_dealloc(partitioner.header);
+    csv_dealloc(partitioner.files);
+    csv_dealloc(partitioner.keys);
+    csv_dealloc(partitioner.key_lens);
+    csv_hash_table_free(&partitioner.values);
+    csv_dealloc(partitioner.buckets);
+    csv_dealloc(partitioner.open);
+    csv_arena_free(&partitioner.arena);
+}
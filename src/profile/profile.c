@@ -0,0 +1,339 @@
+#include <math.h>
+
+#include "csvinternal.h"
+#include "profile/profile.h"
+
+// HyperLogLog with 2^12 registers: 4 KiB per column and ~1.6% standard error
+#define CSV_HLL_PRECISION 12
+#define CSV_HLL_REGISTERS (1 << CSV_HLL_PRECISION)
+
+// KLL accuracy parameter; the sketch keeps roughly 3k values per column
+#define CSV_KLL_K 200
+
+struct csv_quantile_sketch
+{
+    // compactor levels while streaming. an item on level h stands for 2^h original values
+    double** levels;
+    size_t* sizes;
+    size_t* allocated;
+    size_t n_levels;
+    uint64_t rng;
+
+    // once finished, the retained items sorted by value with cumulative weights for querying
+    double* values;
+    uint64_t* cumulative;
+    size_t n_values;
+};
+
+static size_t csv_kll_capacity(const struct csv_quantile_sketch* sketch, size_t level)
+{
+    // lower levels shrink geometrically (by 2/3) so the total size stays bounded
+    double capacity = CSV_KLL_K;
+    for (size_t h = level + 1; h < sketch->n_levels; ++h)
+        capacity *= 2.0 / 3.0;
+    return capacity < 2.0 ? 2 : (size_t)ceil(capacity);
+}
+
+static void csv_kll_append(struct csv_quantile_sketch* sketch, size_t level, double value)
+{
+    if (level >= sketch->n_levels)
+    {
+        sketch->n_levels++;
+        sketch->levels = csv_realloc(sketch->levels, sizeof(double*) * sketch->n_levels);
+        sketch->sizes = csv_realloc(sketch->sizes, sizeof(size_t) * sketch->n_levels);
+        sketch->allocated = csv_realloc(sketch->allocated, sizeof(size_t) * sketch->n_levels);
+        sketch->levels[level] = NULL;
+        sketch->sizes[level] = 0;
+        sketch->allocated[level] = 0;
+    }
+
+    if (sketch->sizes[level] >= sketch->allocated[level])
+    {
+        sketch->allocated[level] = sketch->allocated[level] == 0 ? 16 : sketch->allocated[level] * 2;
+        sketch->levels[level] = csv_realloc(sketch->levels[level], sizeof(double) * sketch->allocated[level]);
+    }
+    sketch->levels[level][sketch->sizes[level]++] = value;
+}
+
+static int csv_double_cmp(const void* a, const void* b)
+{
+    const double _a = *(double*)a;
+    const double _b = *(double*)b;
+
+    if (_a == _b)
+        return 0;
+    else if (_a > _b)
+        return 1;
+    return -1;
+}
+
+static void csv_kll_compact(struct csv_quantile_sketch* sketch)
+{
+    size_t total = 0;
+    size_t total_capacity = 0;
+    for (size_t h = 0; h < sketch->n_levels; ++h)
+    {
+        total += sketch->sizes[h];
+        total_capacity += csv_kll_capacity(sketch, h);
+    }
+    if (total < total_capacity)
+        return;
+
+    // compact the lowest level that is over its capacity: sort it and promote every other item
+    for (size_t h = 0; h < sketch->n_levels; ++h)
+    {
+        if (sketch->sizes[h] < csv_kll_capacity(sketch, h))
+            continue;
+
+        double* items = sketch->levels[h];
+        size_t n_items = sketch->sizes[h];
+        qsort(items, n_items, sizeof(double), &csv_double_cmp);
+
+        // xorshift64 picks the odd or even items so the error is unbiased
+        sketch->rng ^= sketch->rng << 13;
+        sketch->rng ^= sketch->rng >> 7;
+        sketch->rng ^= sketch->rng << 17;
+        size_t offset = sketch->rng & 1;
+
+        // an odd item out stays behind on this level
+        size_t n_compacted = n_items & ~(size_t)1;
+        for (size_t i = offset; i < n_compacted; i += 2)
+            csv_kll_append(sketch, h + 1, sketch->levels[h][i]);
+
+        // csv_kll_append() may have moved the level arrays
+        items = sketch->levels[h];
+        if (n_items & 1)
+            items[0] = items[n_items - 1];
+        sketch->sizes[h] = n_items & 1;
+        return;
+    }
+}
+
+static void csv_kll_update(struct csv_quantile_sketch* sketch, double value)
+{
+    csv_kll_append(sketch, 0, value);
+    csv_kll_compact(sketch);
+}
+
+typedef struct csv_weighted_value
+{
+    double value;
+    uint64_t weight;
+} csv_weighted_value;
+
+static int csv_weighted_value_cmp(const void* a, const void* b)
+{
+    return csv_double_cmp(&((csv_weighted_value*)a)->value, &((csv_weighted_value*)b)->value);
+}
+
+// replaces the compactor levels with a sorted, cumulatively weighted array for querying
+static void csv_kll_finish(struct csv_quantile_sketch* sketch)
+{
+    size_t n_values = 0;
+    for (size_t h = 0; h < sketch->n_levels; ++h)
+        n_values += sketch->sizes[h];
+
+    csv_weighted_value* items = csv_malloc(sizeof(csv_weighted_value) * (n_values > 0 ? n_values : 1));
+    size_t i = 0;
+    for (size_t h = 0; h < sketch->n_levels; ++h)
+    {
+        for (size_t j = 0; j < sketch->sizes[h]; ++j)
+        {
+            items[i].value = sketch->levels[h][j];
+            items[i].weight = (uint64_t)1 << h;
+            i++;
+        }
+        csv_dealloc(sketch->levels[h]);
+    }
+    csv_dealloc(sketch->levels);
+    csv_dealloc(sketch->sizes);
+    csv_dealloc(sketch->allocated);
+    sketch->levels = NULL;
+    sketch->sizes = NULL;
+    sketch->allocated = NULL;
+    sketch->n_levels = 0;
+
+    qsort(items, n_values, sizeof(csv_weighted_value), &csv_weighted_value_cmp);
+
+    sketch->values = csv_malloc(sizeof(double) * (n_values > 0 ? n_values : 1));
+    sketch->cumulative = csv_malloc(sizeof(uint64_t) * (n_values > 0 ? n_values : 1));
+    sketch->n_values = n_values;
+    uint64_t cumulative = 0;
+    for (i = 0; i < n_values; ++i)
+    {
+        cumulative += items[i].weight;
+        sketch->values[i] = items[i].value;
+        sketch->cumulative[i] = cumulative;
+    }
+    csv_dealloc(items);
+}
+
+void csv_quantile_sketch_free(struct csv_quantile_sketch* sketch)
+{
+    if (sketch == NULL)
+        return;
+
+    for (size_t h = 0; h < sketch->n_levels; ++h)
+        csv_dealloc(sketch->levels[h]);
+    csv_dealloc(sketch->levels);
+    csv_dealloc(sketch->sizes);
+    csv_dealloc(sketch->allocated);
+    csv_dealloc(sketch->values);
+    csv_dealloc(sketch->cumulative);
+    csv_dealloc(sketch);
+}
+
+double csv_profile_quantile(const csv_profile* profile, double q)
+{
+    const struct csv_quantile_sketch* sketch = profile->sketch;
+    if (sketch == NULL || sketch->n_values == 0)
+        return NAN;
+
+    if (q <= 0.0)
+        return profile->min;
+    if (q >= 1.0)
+        return profile->max;
+
+    // first retained value whose cumulative weight reaches the requested rank
+    double rank = q * (double)sketch->cumulative[sketch->n_values - 1];
+    size_t low = 0;
+    size_t high = sketch->n_values - 1;
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+        if ((double)sketch->cumulative[mid] < rank)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return sketch->values[low];
+}
+
+static void csv_hll_update(unsigned char* registers, const char* cell)
+{
+    uint64_t hash = csv_hash(cell, strlen(cell), 0);
+    size_t index = hash >> (64 - CSV_HLL_PRECISION);
+
+    // rank is the position of the first set bit in the remaining bits
+    uint64_t remaining = hash << CSV_HLL_PRECISION;
+    unsigned char rank = remaining == 0 ? 64 - CSV_HLL_PRECISION + 1 : __builtin_clzll(remaining) + 1;
+    if (rank > registers[index])
+        registers[index] = rank;
+}
+
+static double csv_hll_estimate(const unsigned char* registers)
+{
+    double m = CSV_HLL_REGISTERS;
+    double sum = 0.0;
+    size_t zeros = 0;
+    for (size_t i = 0; i < CSV_HLL_REGISTERS; ++i)
+    {
+        sum += ldexp(1.0, -registers[i]);
+        if (registers[i] == 0)
+            zeros++;
+    }
+
+    double alpha = 0.7213 / (1.0 + 1.079 / m);
+    double estimate = alpha * m * m / sum;
+
+    // linear counting is far more accurate while many registers are still empty
+    if (estimate <= 2.5 * m && zeros > 0)
+        estimate = m * log(m / zeros);
+    return estimate;
+}
+
+void csv_profile_columns(const char* filename, csv_profile** profiles, size_t* n_columns, char delim, bool has_headers)
+{
+    FILE* file = fopen(filename, "r");
+    if (file != NULL)
+    {
+        char* line = NULL;
+        size_t len = 0;
+        size_t columns = 0;
+        char** fields = NULL;
+        unsigned char* registers = NULL;
+        bool first_line = true;
+
+        (*profiles) = NULL;
+
+        while (getline(&line, &len, file) != -1)
+        {
+            // the first line decides how many columns are profiled
+            if (first_line)
+            {
+                // a byte order mark is not part of the first cell
+                size_t bom = csv_bom_length(line, strlen(line));
+                memmove(line, line + bom, strlen(line) + 1 - bom);
+
+                columns = csv_count_columns(line, delim);
+                fields = csv_malloc(sizeof(char*) * columns);
+                registers = csv_calloc(columns, CSV_HLL_REGISTERS);
+                (*profiles) = csv_calloc(columns, sizeof(csv_profile));
+                for (size_t c = 0; c < columns; ++c)
+                {
+                    (*profiles)[c].min = NAN;
+                    (*profiles)[c].max = NAN;
+                    (*profiles)[c].sketch = csv_calloc(1, sizeof(struct csv_quantile_sketch));
+                    (*profiles)[c].sketch->rng = 0x9e3779b97f4a7c15ULL + c;
+                }
+                first_line = false;
+
+                if (has_headers)
+                {
+                    line[csv_header_length(line, strlen(line))] = 0;
+                    csv_split_line(line, delim, fields, columns);
+                    for (size_t c = 0; c < columns; ++c)
+                        (*profiles)[c].name = csv_strdup(fields[c]);
+                    continue;
+                }
+            }
+
+            size_t n_fields = csv_split_line(line, delim, fields, columns);
+            for (size_t c = 0; c < columns; ++c)
+            {
+                csv_profile* profile = &(*profiles)[c];
+                if (c >= n_fields || fields[c][0] == 0)
+                {
+                    profile->null_count++;
+                    continue;
+                }
+
+                profile->count++;
+                csv_hll_update(&registers[c * CSV_HLL_REGISTERS], fields[c]);
+
+                char* end;
+                double value = strtod(fields[c], &end);
+                if (end == fields[c])
+                    continue;
+
+                if (profile->numeric_count == 0 || value < profile->min)
+                    profile->min = value;
+                if (profile->numeric_count == 0 || value > profile->max)
+                    profile->max = value;
+                profile->numeric_count++;
+                csv_kll_update(profile->sketch, value);
+            }
+        }
+
+        for (size_t c = 0; c < columns; ++c)
+        {
+            csv_profile* profile = &(*profiles)[c];
+            profile->distinct = csv_hll_estimate(&registers[c * CSV_HLL_REGISTERS]);
+            csv_kll_finish(profile->sketch);
+            profile->p50 = csv_profile_quantile(profile, 0.50);
+            profile->p90 = csv_profile_quantile(profile, 0.90);
+            profile->p99 = csv_profile_quantile(profile, 0.99);
+        }
+
+        *n_columns = columns;
+        csv_dealloc(registers);
+        csv_dealloc(fields);
+        free(line);
+        fclose(file);
+    }
+    else
+    {
+        printf("File not found!\n");
+        exit(-1);
+    }
+}
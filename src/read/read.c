@@ -1,79 +1,226 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "csvinternal.h"
 #include "read/read.h"
 #include "cast/cast.h"
 #include "free/free.h"
 
-void csv_read(const char* filename, char**** data, size_t (*data_dims)[2], char delim, bool has_headers)
+// opens filename for the file-based functions, which exit when the file does not exist
+static FILE* csv_open_file(const char* filename)
 {
     FILE* file = fopen(filename, "r");
-    if (file != NULL)
+    if (file == NULL)
     {
-        char* line = NULL;
-        char **tokens = NULL;
-        size_t len = 0;
-        size_t read = 0;
+        printf("File not found!\n");
+        exit(-1);
+    }
+    return file;
+}
 
-        // start with allocating memory for 10 lines, then double each time capacity is reached
-        size_t row_allocation_size = 10;
-        (*data) = calloc(row_allocation_size, sizeof(char**));
+// reads at most max_rows data rows and stops reading the input as soon as they have been parsed
+void csv_read_rows(csv_reader* reader, size_t max_rows, char**** data, size_t (*data_dims)[2], char delim, bool has_headers)
+{
+    const char* line = NULL;
+    size_t len = 0;
 
-        size_t current_row = 0;
-        size_t n_tokens;
+    // start with allocating memory for 10 lines, then double each time capacity is reached
+    size_t row_allocation_size = 10;
+    (*data) = csv_calloc(row_allocation_size, sizeof(char**));
+
+    size_t current_row = 0;
 
-        bool counted_columns = false;
+    bool counted_columns = false;
+    (*data_dims)[1] = 0;
 
-        while ((read = getline(&line, &len, file)) != -1)
+    // the first line is always read so the column count is known, even when max_rows is 0
+    while ((current_row < max_rows || !counted_columns) && csv_reader_next(reader, &line, &len))
+    {
+        // count the columns and store them into first index in data_dims
+        if (!counted_columns)
         {
-            // count the columns and store them into first index in data_dims
-            if (!counted_columns)
-            {
-                (*data_dims)[1] = csv_count_columns(line, delim);
-                counted_columns = true;
-            }
-
-            // skip header line if present
-            if (has_headers)
-            {
-                has_headers = false;
-                continue;
-            }
-
-            n_tokens = csv_parse_line(line, delim, &tokens);
-            (*data)[current_row] = malloc(sizeof(char*) * n_tokens);
-            for (size_t i = 0; i < n_tokens; ++i)
-            {
-                // duplicate a copy of tokens[i] into data then free it so we can use tokens on next iteration
-                (*data)[current_row][i] = strdup(tokens[i]);
-                free(tokens[i]);
-                tokens[i] = NULL;
-            }
-
-            current_row++;
-            if (current_row >= row_allocation_size)
-            {
-                row_allocation_size *= 2;
-                (*data) = realloc((*data), sizeof(char**) * row_allocation_size);
-            }
-
-            // free tokens to use them on next iteration
-            free(tokens);
-            tokens = NULL;
+            (*data_dims)[1] = csv_count_columns_n(line, len, delim);
+            counted_columns = true;
+        }
+
+        // skip header line if present
+        if (has_headers)
+        {
+            has_headers = false;
+            continue;
         }
-        free(line);
-        fclose(file);
 
-        // store row count into 0th index in data_dims
-        (*data_dims)[0] = current_row;
+        if (current_row >= max_rows)
+            break;
+
+        // the tokens array becomes the row as is
+        csv_parse_line_n(line, len, delim, &(*data)[current_row]);
+
+        current_row++;
+        if (current_row >= row_allocation_size)
+        {
+            row_allocation_size *= 2;
+            (*data) = csv_realloc((*data), sizeof(char**) * row_allocation_size);
+        }
     }
-    else
+
+    // store row count into 0th index in data_dims
+    (*data_dims)[0] = current_row;
+}
+
+// reads the cell at column_index of every remaining line
+static void csv_read_column_rows(csv_reader* reader, size_t column_index, char*** data, size_t* data_rows, char delim)
+{
+    const char* line = NULL;
+    size_t len = 0;
+    char** tokens = NULL;
+
+    // start with allocating memory for 10 lines, then double each time capacity is reached
+    size_t row_allocation_size = 10;
+    (*data) = csv_calloc(row_allocation_size, sizeof(char*));
+
+    size_t current_row = 0;
+    size_t n_tokens;
+
+    while (csv_reader_next(reader, &line, &len))
+    {
+        n_tokens = csv_parse_line_n(line, len, delim, &tokens);
+        (*data)[current_row] = column_index < n_tokens ? tokens[column_index] : csv_strdup("(null)");
+        for (size_t i = 0; i < n_tokens; ++i)
+            if (i != column_index)
+                csv_dealloc(tokens[i]);
+
+        current_row++;
+        if (current_row >= row_allocation_size)
+        {
+            row_allocation_size *= 2;
+            (*data) = csv_realloc((*data), sizeof(char*) * row_allocation_size);
+        }
+
+        // free tokens to use them on next iteration
+        csv_dealloc(tokens);
+        tokens = NULL;
+    }
+
+    // store row count
+    *data_rows = current_row;
+}
+
+void csv_read(const char* filename, char**** data, size_t (*data_dims)[2], char delim, bool has_headers)
+{
+    if (csv_cache_read(filename, delim, has_headers, data, data_dims))
+        return;
+
+    FILE* file = csv_open_file(filename);
+    csv_source source = csv_source_from_stream(file);
+    csv_read_from(&source, data, data_dims, delim, has_headers);
+    fclose(file);
+}
+
+void csv_read_head(const char* filename, size_t n_rows, char**** data, size_t (*data_dims)[2], char delim, bool has_headers)
+{
+    FILE* file = csv_open_file(filename);
+    csv_source source = csv_source_from_stream(file);
+    csv_read_head_from(&source, n_rows, data, data_dims, delim, has_headers);
+    fclose(file);
+}
+
+void csv_read_tail(const char* filename, size_t n_rows, char**** data, size_t (*data_dims)[2], char delim, bool has_headers)
+{
+    int fd = open(filename, O_RDONLY);
+    struct stat file_stat;
+    if (fd == -1 || fstat(fd, &file_stat) == -1)
+    {
+        printf("File not found!\n");
+        exit(-1);
+    }
+
+    size_t size = file_stat.st_size;
+    (*data_dims)[0] = 0;
+    (*data_dims)[1] = 0;
+    if (size == 0)
+    {
+        (*data) = csv_calloc(1, sizeof(char**));
+        close(fd);
+        return;
+    }
+
+    // only the pages touched by the first line and the last n rows are ever read
+    const char* map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
     {
         printf("File not found!\n");
         exit(-1);
     }
+
+    // count the columns from the first line just like csv_read()
+    const char* first_newline = memchr(map, '\n', size);
+    size_t first_line_end = first_newline != NULL ? (size_t)(first_newline - map) + 1 : size;
+    char* line = csv_malloc(first_line_end + 1);
+    memcpy(line, map, first_line_end);
+    line[first_line_end] = 0;
+    (*data_dims)[1] = csv_count_columns(line, delim);
+    csv_dealloc(line);
+
+    // a byte order mark is not part of the first row when it is data
+    size_t data_start = has_headers ? first_line_end : csv_bom_length(map, size);
+
+    // the newline terminating the last line does not start another row (getline never returns it)
+    size_t end = size;
+    if (end > data_start && map[end - 1] == '\n')
+        end--;
+
+    // walk backwards collecting the start offset of each of the last n rows.
+    // a large n_rows asks for everything, so the offsets grow with the rows found rather than with the request
+    size_t row_starts_capacity = 10;
+    size_t* row_starts = csv_malloc(sizeof(size_t) * row_starts_capacity);
+    size_t found = 0;
+    size_t pos = end;
+    while (found < n_rows && pos > data_start)
+    {
+        size_t start = pos;
+        while (start > data_start && map[start - 1] != '\n')
+            start--;
+        if (found == row_starts_capacity)
+        {
+            row_starts_capacity *= 2;
+            row_starts = csv_realloc(row_starts, sizeof(size_t) * row_starts_capacity);
+        }
+        row_starts[found++] = start;
+
+        if (start == data_start)
+            break;
+        pos = start - 1;
+    }
+
+    // parse the rows in file order; each row ends at the next newline (or at end)
+    (*data) = csv_calloc(found > 0 ? found : 1, sizeof(char**));
+    for (size_t i = 0; i < found; ++i)
+    {
+        size_t start = row_starts[found - 1 - i];
+        const char* newline = memchr(map + start, '\n', end - start);
+        size_t line_end = newline != NULL ? (size_t)(newline - map) : end;
+
+        line = csv_malloc(line_end - start + 1);
+        memcpy(line, map + start, line_end - start);
+        line[line_end - start] = 0;
+        csv_parse_line(line, delim, &(*data)[i]);
+        csv_dealloc(line);
+    }
+    (*data_dims)[0] = found;
+
+    csv_dealloc(row_starts);
+    munmap((void*)map, size);
 }
 
 void csv_read_int(const char* filename, int*** data, size_t (*data_dims)[2], char delim, bool has_headers)
 {
+    if (csv_cache_read_int(filename, delim, has_headers, data, data_dims))
+        return;
+
     char*** s_data = NULL;
     csv_read(filename, &s_data, data_dims, delim, has_headers);
     csv_data_to_int(s_data, *data_dims, data);
@@ -81,6 +228,9 @@ void csv_read_int(const char* filename, int*** data, size_t (*data_dims)[2], cha
 }
 void csv_read_float(const char* filename, float*** data, size_t (*data_dims)[2], char delim, bool has_headers)
 {
+    if (csv_cache_read_float(filename, delim, has_headers, data, data_dims))
+        return;
+
     char*** s_data = NULL;
     csv_read(filename, &s_data, data_dims, delim, has_headers);
     csv_data_to_float(s_data, *data_dims, data);
@@ -89,65 +239,20 @@ void csv_read_float(const char* filename, float*** data, size_t (*data_dims)[2],
 
 void csv_read_column_by_index(const char* filename, size_t column_index, char*** data, size_t* data_rows, char delim, bool has_headers)
 {
-    FILE* file = fopen(filename, "r");
-    if (file != NULL)
-    {
-        char* line = NULL;
-        char **tokens = NULL;
-        size_t len = 0;
-        size_t read = 0;
+    if (csv_cache_read_column(filename, column_index, delim, has_headers, data, data_rows))
+        return;
 
-        // start with allocating memory for 10 lines, then double each time capacity is reached
-        size_t row_allocation_size = 10;
-        (*data) = calloc(row_allocation_size, sizeof(char**));
-
-        size_t current_row = 0;
-        size_t n_tokens;
-
-        while ((read = getline(&line, &len, file)) != -1)
-        {
-
-            // skip header line if present
-            if (has_headers)
-            {
-                has_headers = false;
-                continue;
-            }
-
-            n_tokens = csv_parse_line(line, delim, &tokens);
-            (*data)[current_row] = strdup(tokens[column_index]);
-            for (size_t i = 0; i < n_tokens; ++i)
-            {
-                free(tokens[i]);
-                tokens[i] = NULL;
-            }
-
-            current_row++;
-            if (current_row >= row_allocation_size)
-            {
-                row_allocation_size *= 2;
-                (*data) = realloc((*data), sizeof(char**) * row_allocation_size);
-            }
-
-            // free tokens to use them on next iteration
-            free(tokens);
-            tokens = NULL;
-        }
-        free(line);
-        fclose(file);
-
-        // store row count
-        *data_rows = current_row;
-    }
-    else
-    {
-        printf("File not found!\n");
-        exit(-1);
-    }
+    FILE* file = csv_open_file(filename);
+    csv_source source = csv_source_from_stream(file);
+    csv_read_column_by_index_from(&source, column_index, data, data_rows, delim, has_headers);
+    fclose(file);
 }
 
 void csv_read_column_by_index_as_float(const char* filename, size_t column_index, float** data, size_t* data_rows, char delim, bool has_headers)
 {
+    if (csv_cache_read_column_float(filename, column_index, delim, has_headers, data, data_rows))
+        return;
+
     char** s_data = NULL;
     csv_read_column_by_index(filename, column_index, &s_data, data_rows, delim, has_headers);
     csv_column_to_float(s_data, *data_rows, data);
@@ -156,12 +261,23 @@ void csv_read_column_by_index_as_float(const char* filename, size_t column_index
 
 void csv_read_column_by_index_as_int(const char* filename, size_t column_index, int** data, size_t* data_rows, char delim, bool has_headers)
 {
+    if (csv_cache_read_column_int(filename, column_index, delim, has_headers, data, data_rows))
+        return;
+
     char** s_data = NULL;
     csv_read_column_by_index(filename, column_index, &s_data, data_rows, delim, has_headers);
     csv_column_to_int(s_data, *data_rows, data);
     csv_free_column(&s_data, *data_rows);
 }
 
+void csv_read_column_by_index_as_timestamp(const char* filename, size_t column_index, int64_t** data, size_t* data_rows, char delim, bool has_headers)
+{
+    char** s_data = NULL;
+    csv_read_column_by_index(filename, column_index, &s_data, data_rows, delim, has_headers);
+    csv_column_to_timestamp(s_data, *data_rows, data);
+    csv_free_column(&s_data, *data_rows);
+}
+
 void csv_read_column_by_name(const char* filename, const char* column_name, char*** data, size_t* data_rows, char delim)
 {
     FILE* file = fopen(filename, "r");
@@ -173,7 +289,7 @@ void csv_read_column_by_name(const char* filename, const char* column_name, char
         size_t n_tokens;
 
         getline(&line, &len, file);
-        n_tokens = csv_parse_line(line, delim, &tokens);
+        n_tokens = csv_parse_line(line + csv_bom_length(line, strlen(line)), delim, &tokens);
 
         for (size_t i = 0; i < n_tokens; ++i)
             if (strncmp(tokens[i], column_name, strlen(column_name)) == 0)
@@ -181,8 +297,9 @@ void csv_read_column_by_name(const char* filename, const char* column_name, char
 
         free(line);
         for (size_t i = 0; i < n_tokens; ++i)
-            free(tokens[i]);
-        free(tokens);
+            csv_dealloc(tokens[i]);
+        csv_dealloc(tokens);
+        fclose(file);
     }
     else
     {
@@ -205,4 +322,133 @@ void csv_read_column_by_name_as_int(const char* filename, const char* column_nam
     csv_read_column_by_name(filename, column_name, &s_data, data_rows, delim);
     csv_column_to_int(s_data, *data_rows, data);
     csv_free_column(&s_data, *data_rows);
-}
\ No newline at end of file
+}
+
+void csv_read_column_by_name_as_timestamp(const char* filename, const char* column_name, int64_t** data, size_t* data_rows, char delim)
+{
+    char** s_data = NULL;
+    csv_read_column_by_name(filename, column_name, &s_data, data_rows, delim);
+    csv_column_to_timestamp(s_data, *data_rows, data);
+    csv_free_column(&s_data, *data_rows);
+}
+
+void csv_read_from(csv_source* source, char**** data, size_t (*data_dims)[2], char delim, bool has_headers)
+{
+    csv_reader reader;
+    csv_reader_init(&reader, source);
+    csv_read_rows(&reader, SIZE_MAX, data, data_dims, delim, has_headers);
+    csv_reader_free(&reader);
+}
+
+void csv_read_head_from(csv_source* source, size_t n_rows, char**** data, size_t (*data_dims)[2], char delim, bool has_headers)
+{
+    csv_reader reader;
+    csv_reader_init(&reader, source);
+    csv_read_rows(&reader, n_rows, data, data_dims, delim, has_headers);
+    csv_reader_free(&reader);
+}
+
+void csv_read_int_from(csv_source* source, int*** data, size_t (*data_dims)[2], char delim, bool has_headers)
+{
+    char*** s_data = NULL;
+    csv_read_from(source, &s_data, data_dims, delim, has_headers);
+    csv_data_to_int(s_data, *data_dims, data);
+    csv_free(&s_data, *data_dims);
+}
+
+void csv_read_float_from(csv_source* source, float*** data, size_t (*data_dims)[2], char delim, bool has_headers)
+{
+    char*** s_data = NULL;
+    csv_read_from(source, &s_data, data_dims, delim, has_headers);
+    csv_data_to_float(s_data, *data_dims, data);
+    csv_free(&s_data, *data_dims);
+}
+
+void csv_read_column_by_index_from(csv_source* source, size_t column_index, char*** data, size_t* data_rows, char delim, bool has_headers)
+{
+    csv_reader reader;
+    csv_reader_init(&reader, source);
+
+    // skip header line if present
+    const char* line;
+    size_t len;
+    if (has_headers)
+        csv_reader_next(&reader, &line, &len);
+
+    csv_read_column_rows(&reader, column_index, data, data_rows, delim);
+    csv_reader_free(&reader);
+}
+
+void csv_read_column_by_index_as_float_from(csv_source* source, size_t column_index, float** data, size_t* data_rows, char delim, bool has_headers)
+{
+    char** s_data = NULL;
+    csv_read_column_by_index_from(source, column_index, &s_data, data_rows, delim, has_headers);
+    csv_column_to_float(s_data, *data_rows, data);
+    csv_free_column(&s_data, *data_rows);
+}
+
+void csv_read_column_by_index_as_int_from(csv_source* source, size_t column_index, int** data, size_t* data_rows, char delim, bool has_headers)
+{
+    char** s_data = NULL;
+    csv_read_column_by_index_from(source, column_index, &s_data, data_rows, delim, has_headers);
+    csv_column_to_int(s_data, *data_rows, data);
+    csv_free_column(&s_data, *data_rows);
+}
+
+void csv_read_column_by_index_as_timestamp_from(csv_source* source, size_t column_index, int64_t** data, size_t* data_rows, char delim, bool has_headers)
+{
+    char** s_data = NULL;
+    csv_read_column_by_index_from(source, column_index, &s_data, data_rows, delim, has_headers);
+    csv_column_to_timestamp(s_data, *data_rows, data);
+    csv_free_column(&s_data, *data_rows);
+}
+
+void csv_read_column_by_name_from(csv_source* source, const char* column_name, char*** data, size_t* data_rows, char delim)
+{
+    csv_reader reader;
+    csv_reader_init(&reader, source);
+
+    // find the column in the header, then read it from the rest of the input in the same pass
+    const char* line;
+    size_t len;
+    size_t column_index = SIZE_MAX;
+    if (csv_reader_next(&reader, &line, &len))
+    {
+        char** tokens = NULL;
+        size_t n_tokens = csv_parse_line_n(line, csv_header_length(line, len), delim, &tokens);
+        for (size_t i = 0; i < n_tokens; ++i)
+        {
+            if (column_index == SIZE_MAX && strcmp(tokens[i], column_name) == 0)
+                column_index = i;
+            csv_dealloc(tokens[i]);
+        }
+        csv_dealloc(tokens);
+    }
+
+    csv_read_column_rows(&reader, column_index, data, data_rows, delim);
+    csv_reader_free(&reader);
+}
+
+void csv_read_column_by_name_as_float_from(csv_source* source, const char* column_name, float** data, size_t* data_rows, char delim)
+{
+    char** s_data = NULL;
+    csv_read_column_by_name_from(source, column_name, &s_data, data_rows, delim);
+    csv_column_to_float(s_data, *data_rows, data);
+    csv_free_column(&s_data, *data_rows);
+}
+
+void csv_read_column_by_name_as_int_from(csv_source* source, const char* column_name, int** data, size_t* data_rows, char delim)
+{
+    char** s_data = NULL;
+    csv_read_column_by_name_from(source, column_name, &s_data, data_rows, delim);
+    csv_column_to_int(s_data, *data_rows, data);
+    csv_free_column(&s_data, *data_rows);
+}
+
+void csv_read_column_by_name_as_timestamp_from(csv_source* source, const char* column_name, int64_t** data, size_t* data_rows, char delim)
+{
+    char** s_data = NULL;
+    csv_read_column_by_name_from(source, column_name, &s_data, data_rows, delim);
+    csv_column_to_timestamp(s_data, *data_rows, data);
+    csv_free_column(&s_data, *data_rows);
+}
@@ -0,0 +1,66 @@
+#include "csvinternal.h"
+#include "rfc4180/rfc4180.h"
+
+void csv_read_rfc4180(const char* filename, char**** data, size_t (*data_dims)[2], char delim, bool has_headers)
+{
+    FILE* file = fopen(filename, "r");
+    if (file == NULL)
+    {
+        printf("File not found!\n");
+        exit(-1);
+    }
+
+    csv_source source = csv_source_from_stream(file);
+    csv_read_rfc4180_from(&source, data, data_dims, delim, has_headers);
+    fclose(file);
+}
+
+void csv_read_rfc4180_from(csv_source* source, char**** data, size_t (*data_dims)[2], char delim, bool has_headers)
+{
+    csv_reader reader;
+    csv_reader_init(&reader, source);
+
+    const char* record;
+    size_t len;
+
+    // start with allocating memory for 10 records, then double each time capacity is reached
+    size_t row_allocation_size = 10;
+    (*data) = csv_calloc(row_allocation_size, sizeof(char**));
+    size_t current_row = 0;
+    bool counted_columns = false;
+    (*data_dims)[1] = 0;
+
+    while (csv_reader_next_record(&reader, &record, &len))
+    {
+        char** tokens;
+        size_t n_tokens = csv_parse_record(record, len, delim, &tokens);
+
+        // the first record gives the column count
+        if (!counted_columns)
+        {
+            (*data_dims)[1] = n_tokens;
+            counted_columns = true;
+        }
+
+        // skip header record if present
+        if (has_headers)
+        {
+            for (size_t i = 0; i < n_tokens; ++i)
+                csv_dealloc(tokens[i]);
+            csv_dealloc(tokens);
+            has_headers = false;
+            continue;
+        }
+
+        (*data)[current_row] = tokens;
+        current_row++;
+        if (current_row >= row_allocation_size)
+        {
+            row_allocation_size *= 2;
+            (*data) = csv_realloc((*data), sizeof(char**) * row_allocation_size);
+        }
+    }
+    csv_reader_free(&reader);
+
+    (*data_dims)[0] = current_row;
+}
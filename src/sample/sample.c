@@ -0,0 +1,265 @@
+#include <fcntl.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "csvinternal.h"
+#include "sample/sample.h"
+
+// where a row is in the file; rows are only read back once the sample is known
+typedef struct csv_sample_row
+{
+    size_t offset;
+    size_t len;
+} csv_sample_row;
+
+// Algorithm L (Li, 1994): after the reservoir fills, the index of the next row to keep is drawn directly,
+// so the rows in between cost one comparison each
+typedef struct csv_reservoir
+{
+    size_t count;
+    size_t next;
+    double w;
+    csv_sample_row* rows;
+    size_t capacity;
+} csv_reservoir;
+
+typedef struct csv_sampler
+{
+    size_t k;
+    uint64_t rng;
+
+    csv_reservoir* reservoirs;
+    char** keys;
+    size_t* key_lens;
+    size_t n_strata;
+    size_t strata_capacity;
+
+    csv_hash_table strata;
+    csv_arena arena;
+} csv_sampler;
+
+// splitmix64, mapped to a double in (0, 1)
+static double csv_sample_random(csv_sampler* sampler)
+{
+    uint64_t z = (sampler->rng += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z ^= z >> 31;
+    return ((z >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+// draws how many rows to pass over before the next one is kept
+static void csv_reservoir_skip(csv_sampler* sampler, csv_reservoir* reservoir)
+{
+    double skip = floor(log(csv_sample_random(sampler)) / log1p(-reservoir->w));
+    reservoir->next = skip < (double)(SIZE_MAX - reservoir->count - 1) ? reservoir->count + (size_t)skip + 1 : SIZE_MAX;
+}
+
+static void csv_reservoir_offer(csv_sampler* sampler, csv_reservoir* reservoir, size_t offset, size_t len)
+{
+    size_t k = sampler->k;
+    reservoir->count++;
+
+    if (reservoir->count <= k)
+    {
+        // the reservoir grows as it fills so rare strata stay small
+        if (reservoir->count > reservoir->capacity)
+        {
+            reservoir->capacity = reservoir->capacity == 0 ? 4 : reservoir->capacity * 2;
+            if (reservoir->capacity > k)
+                reservoir->capacity = k;
+            reservoir->rows = csv_realloc(reservoir->rows, sizeof(csv_sample_row) * reservoir->capacity);
+        }
+        reservoir->rows[reservoir->count - 1].offset = offset;
+        reservoir->rows[reservoir->count - 1].len = len;
+
+        if (reservoir->count == k)
+        {
+            reservoir->w = exp(log(csv_sample_random(sampler)) / k);
+            csv_reservoir_skip(sampler, reservoir);
+        }
+        return;
+    }
+
+    if (reservoir->count < reservoir->next)
+        return;
+
+    size_t replaced = (size_t)(csv_sample_random(sampler) * k);
+    reservoir->rows[replaced < k ? replaced : k - 1].offset = offset;
+    reservoir->rows[replaced < k ? replaced : k - 1].len = len;
+    reservoir->w *= exp(log(csv_sample_random(sampler)) / k);
+    csv_reservoir_skip(sampler, reservoir);
+}
+
+// returns the reservoir of the stratum whose key is the len bytes at key, creating it the first time the key is seen
+static csv_reservoir* csv_sampler_find(csv_sampler* sampler, const char* key, size_t len)
+{
+    uint64_t hash = csv_hash(key, len, 0);
+    size_t pos = csv_hash_table_start(&sampler->strata, hash);
+    size_t stratum;
+    while ((stratum = csv_hash_table_next(&sampler->strata, hash, &pos)) != SIZE_MAX)
+        if (sampler->key_lens[stratum] == len && memcmp(sampler->keys[stratum], key, len) == 0)
+            return &sampler->reservoirs[stratum];
+
+    if (sampler->n_strata == sampler->strata_capacity)
+    {
+        sampler->strata_capacity *= 2;
+        sampler->reservoirs = csv_realloc(sampler->reservoirs, sizeof(csv_reservoir) * sampler->strata_capacity);
+        sampler->keys = csv_realloc(sampler->keys, sizeof(char*) * sampler->strata_capacity);
+        sampler->key_lens = csv_realloc(sampler->key_lens, sizeof(size_t) * sampler->strata_capacity);
+    }
+
+    stratum = sampler->n_strata++;
+    memset(&sampler->reservoirs[stratum], 0, sizeof(csv_reservoir));
+    sampler->keys[stratum] = csv_arena_alloc(&sampler->arena, len + 1);
+    memcpy(sampler->keys[stratum], key, len);
+    sampler->key_lens[stratum] = len;
+    csv_hash_table_insert(&sampler->strata, hash, pos, stratum);
+
+    return &sampler->reservoirs[stratum];
+}
+
+static int csv_sample_row_cmp(const void* a, const void* b)
+{
+    size_t offset_a = ((const csv_sample_row*)a)->offset;
+    size_t offset_b = ((const csv_sample_row*)b)->offset;
+    return (offset_a > offset_b) - (offset_a < offset_b);
+}
+
+// scans the file once, offering every data row to its stratum's reservoir (a single one when column_name is NULL),
+// then reads back and parses the rows that were kept
+static void csv_sample_file(const char* filename, const char* column_name, size_t k, uint64_t seed, char**** data, size_t (*data_dims)[2], char delim, bool has_headers)
+{
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1)
+    {
+        printf("File not found!\n");
+        exit(-1);
+    }
+
+    csv_sampler sampler;
+    memset(&sampler, 0, sizeof(csv_sampler));
+    sampler.k = k;
+    sampler.rng = seed;
+    sampler.strata_capacity = 16;
+    sampler.reservoirs = csv_calloc(sampler.strata_capacity, sizeof(csv_reservoir));
+    sampler.keys = csv_malloc(sizeof(char*) * sampler.strata_capacity);
+    sampler.key_lens = csv_malloc(sizeof(size_t) * sampler.strata_capacity);
+    csv_hash_table_init(&sampler.strata, 64);
+
+    csv_source source = csv_source_from_fd(fd);
+    csv_reader reader;
+    csv_reader_init(&reader, &source);
+
+    // the first line gives the column count (and the stratum column); it is a data row only without headers
+    const char* line;
+    size_t len;
+    (*data_dims)[1] = 0;
+    size_t column_index = SIZE_MAX;
+    bool scan = k > 0;
+    if (csv_reader_next(&reader, &line, &len))
+    {
+        (*data_dims)[1] = csv_count_columns_n(line, len, delim);
+        if (column_name != NULL)
+        {
+            char** columns;
+            size_t n_columns = csv_parse_line_n(line, csv_header_length(line, len), delim, &columns);
+            for (size_t c = 0; c < n_columns; ++c)
+            {
+                if (column_index == SIZE_MAX && strcmp(columns[c], column_name) == 0)
+                    column_index = c;
+                csv_dealloc(columns[c]);
+            }
+            csv_dealloc(columns);
+            scan = scan && column_index != SIZE_MAX;
+        }
+        if (!has_headers)
+            csv_reader_unread(&reader);
+    }
+
+    csv_reservoir* reservoir = &sampler.reservoirs[0];
+    if (column_name == NULL)
+        sampler.n_strata = 1;
+    while (scan && csv_reader_next(&reader, &line, &len))
+    {
+        // the reader has consumed exactly up to the end of this line
+        size_t offset = reader.consumed - len;
+        if (column_name != NULL)
+        {
+            const char* cell;
+            size_t cell_len;
+            if (!csv_find_cell(line, len, delim, column_index, &cell, &cell_len))
+            {
+                cell = "";
+                cell_len = 0;
+            }
+            else if (cell_len > 0 && cell[cell_len - 1] == '\r' && cell + cell_len + 1 >= line + len)
+                cell_len--;
+            reservoir = csv_sampler_find(&sampler, cell, cell_len);
+        }
+
+        // the common case of a row that is passed over needs no call
+        if (reservoir->count >= k && reservoir->count + 1 < reservoir->next)
+            reservoir->count++;
+        else
+            csv_reservoir_offer(&sampler, reservoir, offset, len);
+    }
+    csv_reader_free(&reader);
+
+    // rows are read back in file order so the reads move forwards through the file
+    size_t n_rows = 0;
+    for (size_t s = 0; s < sampler.n_strata; ++s)
+        n_rows += sampler.reservoirs[s].count < k ? sampler.reservoirs[s].count : k;
+    csv_sample_row* rows = csv_malloc(sizeof(csv_sample_row) * (n_rows > 0 ? n_rows : 1));
+    size_t current_row = 0;
+    for (size_t s = 0; s < sampler.n_strata; ++s)
+    {
+        size_t kept = sampler.reservoirs[s].count < k ? sampler.reservoirs[s].count : k;
+        if (kept > 0)
+            memcpy(rows + current_row, sampler.reservoirs[s].rows, sizeof(csv_sample_row) * kept);
+        current_row += kept;
+        csv_dealloc(sampler.reservoirs[s].rows);
+    }
+    qsort(rows, n_rows, sizeof(csv_sample_row), &csv_sample_row_cmp);
+
+    (*data) = csv_calloc(n_rows > 0 ? n_rows : 1, sizeof(char**));
+    char* buffer = NULL;
+    size_t buffer_capacity = 0;
+    for (size_t r = 0; r < n_rows; ++r)
+    {
+        if (rows[r].len > buffer_capacity)
+        {
+            buffer_capacity = rows[r].len > buffer_capacity * 2 ? rows[r].len : buffer_capacity * 2;
+            buffer = csv_realloc(buffer, buffer_capacity);
+        }
+        size_t n_read = 0;
+        while (n_read < rows[r].len)
+        {
+            ssize_t n = pread(fd, buffer + n_read, rows[r].len - n_read, rows[r].offset + n_read);
+            if (n <= 0)
+                break;
+            n_read += n;
+        }
+        csv_parse_line_n(buffer, n_read, delim, &(*data)[r]);
+    }
+    (*data_dims)[0] = n_rows;
+
+    csv_dealloc(buffer);
+    csv_dealloc(rows);
+    csv_dealloc(sampler.reservoirs);
+    csv_dealloc(sampler.keys);
+    csv_dealloc(sampler.key_lens);
+    csv_hash_table_free(&sampler.strata);
+    csv_arena_free(&sampler.arena);
+    close(fd);
+}
+
+void csv_sample(const char* filename, size_t k, uint64_t seed, char**** data, size_t (*data_dims)[2], char delim, bool has_headers)
+{
+    csv_sample_file(filename, NULL, k, seed, data, data_dims, delim, has_headers);
+}
+
+void csv_sample_stratified(const char* filename, const char* column_name, size_t k, uint64_t seed, char**** data, size_t (*data_dims)[2], char delim)
+{
+    csv_sample_file(filename, column_name, k, seed, data, data_dims, delim, true);
+}
@@ -1,3 +1,4 @@
+#include "csvinternal.h"
 #include "select/select.h"
 #include "read/read.h"
 #include "free/free.h"
@@ -16,15 +17,15 @@ void csv_select_by_name(const char* filename, char** column_names, size_t n_colu
         // allocate memory for user's data when number of rows is known
         if (!allocated)
         {
-            (*data) = calloc(rows, sizeof(char**));
+            (*data) = csv_calloc(rows, sizeof(char**));
             for (size_t i = 0; i < rows; ++i)
-                (*data)[i] = calloc(n_columns, sizeof(char*));
+                (*data)[i] = csv_calloc(n_columns, sizeof(char*));
             allocated = true;
         }
 
         // copy data from column into user's data and free it back
         for (size_t r = 0; r < rows; ++r)
-            (*data)[r][c] = strdup(current_column[r]);
+            (*data)[r][c] = csv_strdup(current_column[r]);
         csv_free_column(&current_column, rows);
     }
 
@@ -62,15 +63,15 @@ void csv_select_by_index(const char* filename, size_t* column_indices, size_t n_
         // allocate memory for user's data when number of rows is known
         if (!allocated)
         {
-            (*data) = calloc(rows, sizeof(char**));
+            (*data) = csv_calloc(rows, sizeof(char**));
             for (size_t i = 0; i < rows; ++i)
-                (*data)[i] = calloc(n_columns, sizeof(char*));
+                (*data)[i] = csv_calloc(n_columns, sizeof(char*));
             allocated = true;
         }
 
         // copy data from column into user's data and free it back
         for (size_t r = 0; r < rows; ++r)
-            (*data)[r][c] = strdup(current_column[r]);
+            (*data)[r][c] = csv_strdup(current_column[r]);
         csv_free_column(&current_column, rows);
     }
 
@@ -92,4 +93,78 @@ void csv_select_by_index_as_int(const char* filename, size_t* column_indices, si
     csv_select_by_index(filename, column_indices, n_columns, &s_data, data_dims, delim, has_headers);
     csv_data_to_int(s_data, *data_dims, data);
     csv_free(&s_data, *data_dims);
-}
\ No newline at end of file
+}
+
+void csv_select_by_name_from(csv_source* source, char** column_names, size_t n_columns, char**** data, size_t (*data_dims)[2], char delim)
+{
+    csv_reader reader;
+    csv_reader_init(&reader, source);
+
+    // resolve the names against the header, then select from the rest of the input in the same pass
+    char** all_columns = NULL;
+    size_t total_column_count = csv_reader_header(&reader, delim, &all_columns);
+    size_t* column_indices = csv_malloc(sizeof(size_t) * (n_columns > 0 ? n_columns : 1));
+    for (size_t c = 0; c < n_columns; ++c)
+    {
+        column_indices[c] = SIZE_MAX;
+        for (size_t i = 0; i < total_column_count; ++i)
+            if (strcmp(all_columns[i], column_names[c]) == 0)
+            {
+                column_indices[c] = i;
+                break;
+            }
+    }
+    csv_free_column(&all_columns, total_column_count);
+
+    csv_select_rows(&reader, column_indices, n_columns, data, data_dims, delim);
+
+    csv_dealloc(column_indices);
+    csv_reader_free(&reader);
+}
+
+void csv_select_by_name_as_float_from(csv_source* source, char** column_names, size_t n_columns, float*** data, size_t (*data_dims)[2], char delim)
+{
+    char*** s_data = NULL;
+    csv_select_by_name_from(source, column_names, n_columns, &s_data, data_dims, delim);
+    csv_data_to_float(s_data, *data_dims, data);
+    csv_free(&s_data, *data_dims);
+}
+
+void csv_select_by_name_as_int_from(csv_source* source, char** column_names, size_t n_columns, int*** data, size_t (*data_dims)[2], char delim)
+{
+    char*** s_data = NULL;
+    csv_select_by_name_from(source, column_names, n_columns, &s_data, data_dims, delim);
+    csv_data_to_int(s_data, *data_dims, data);
+    csv_free(&s_data, *data_dims);
+}
+
+void csv_select_by_index_from(csv_source* source, size_t* column_indices, size_t n_columns, char**** data, size_t (*data_dims)[2], char delim, bool has_headers)
+{
+    csv_reader reader;
+    csv_reader_init(&reader, source);
+
+    // skip header line if present
+    const char* line;
+    size_t len;
+    if (has_headers)
+        csv_reader_next(&reader, &line, &len);
+
+    csv_select_rows(&reader, column_indices, n_columns, data, data_dims, delim);
+    csv_reader_free(&reader);
+}
+
+void csv_select_by_index_as_float_from(csv_source* source, size_t* column_indices, size_t n_columns, float*** data, size_t (*data_dims)[2], char delim, bool has_headers)
+{
+    char*** s_data = NULL;
+    csv_select_by_index_from(source, column_indices, n_columns, &s_data, data_dims, delim, has_headers);
+    csv_data_to_float(s_data, *data_dims, data);
+    csv_free(&s_data, *data_dims);
+}
+
+void csv_select_by_index_as_int_from(csv_source* source, size_t* column_indices, size_t n_columns, int*** data, size_t (*data_dims)[2], char delim, bool has_headers)
+{
+    char*** s_data = NULL;
+    csv_select_by_index_from(source, column_indices, n_columns, &s_data, data_dims, delim, has_headers);
+    csv_data_to_int(s_data, *data_dims, data);
+    csv_free(&s_data, *data_dims);
+}
@@ -0,0 +1,513 @@
+#include <math.h>
+
+#include "csvinternal.h"
+#include "sort/sort.h"
+
+#define CSV_SORT_DEFAULT_BUDGET ((size_t)256 << 20)
+// runs merged at once; spilled runs are merged in levels of this many so open temporary files stay bounded
+#define CSV_SORT_FANIN 64
+#define CSV_SORT_LEVELS 16
+
+// kinds in sort order
+enum
+{
+    CSV_SORT_EMPTY,
+    CSV_SORT_NUMBER,
+    CSV_SORT_TEXT
+};
+
+// one key cell; text points into the row's original bytes
+typedef struct csv_sort_key
+{
+    const char* text;
+    size_t len;
+    double number;
+    int kind;
+} csv_sort_key;
+
+typedef struct csv_sort_row
+{
+    uint64_t radix;
+    const char* line;
+    size_t len;
+    csv_sort_key* keys;
+} csv_sort_row;
+
+typedef struct csv_sort_spec
+{
+    const size_t* key_indices;
+    const csv_sort_order* orders;
+    size_t n_keys;
+    size_t max_index;
+    char delim;
+} csv_sort_spec;
+
+// a spilled run being merged
+typedef struct csv_sort_cursor
+{
+    FILE* file;
+    char* line;
+    size_t capacity;
+    size_t len;
+    csv_sort_key* keys;
+    bool done;
+} csv_sort_cursor;
+
+// spilled runs waiting to be merged, oldest level (earliest rows) last
+typedef struct csv_sort_level
+{
+    FILE* runs[CSV_SORT_FANIN];
+    size_t n_runs;
+} csv_sort_level;
+
+static void csv_sort_set_key(csv_sort_key* key, const char* text, size_t len)
+{
+    if (len >= 2 && text[0] == '\"' && text[len - 1] == '\"')
+    {
+        text++;
+        len -= 2;
+    }
+    key->text = text;
+    key->len = len;
+    key->kind = len == 0 ? CSV_SORT_EMPTY : CSV_SORT_TEXT;
+
+    // only cells that look like numbers are handed to strtod (which wants a \0 terminated copy)
+    char first = len > 0 ? text[0] : 0;
+    if (len == 0 || len >= 64 || !((first >= '0' && first <= '9') || first == '-' || first == '+' || first == '.' || first == ' '))
+        return;
+
+    char buffer[64];
+    memcpy(buffer, text, len);
+    buffer[len] = 0;
+    char* end;
+    double value = strtod(buffer, &end);
+    if (end == buffer + len && !isnan(value))
+    {
+        key->kind = CSV_SORT_NUMBER;
+        // -0 and 0 compare equal, so give them the same bits for the radix sort
+        key->number = value == 0 ? 0 : value;
+    }
+}
+
+// finds the key cells of a line with the same quote rules as csv_count_columns()
+static void csv_sort_extract_keys(const csv_sort_spec* spec, const char* line, size_t len, csv_sort_key* keys)
+{
+    for (size_t k = 0; k < spec->n_keys; ++k)
+    {
+        keys[k].kind = CSV_SORT_EMPTY;
+        keys[k].len = 0;
+    }
+
+    while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+        len--;
+
+    bool inside_quotes = false;
+    size_t field = 0;
+    size_t start = 0;
+    for (size_t i = 0; i <= len && field <= spec->max_index; ++i)
+    {
+        if (i < len)
+        {
+            if (line[i] == '\"')
+                inside_quotes = !inside_quotes;
+            if (line[i] != spec->delim || inside_quotes)
+                continue;
+        }
+
+        for (size_t k = 0; k < spec->n_keys; ++k)
+            if (spec->key_indices[k] == field)
+                csv_sort_set_key(&keys[k], line + start, i - start);
+        field++;
+        start = i + 1;
+    }
+}
+
+static int csv_sort_compare_key(const csv_sort_key* a, const csv_sort_key* b)
+{
+    if (a->kind != b->kind)
+        return a->kind < b->kind ? -1 : 1;
+    if (a->kind == CSV_SORT_NUMBER)
+        return (a->number > b->number) - (a->number < b->number);
+    if (a->kind == CSV_SORT_TEXT)
+    {
+        int cmp = memcmp(a->text, b->text, a->len < b->len ? a->len : b->len);
+        if (cmp != 0)
+            return cmp;
+        return (a->len > b->len) - (a->len < b->len);
+    }
+    return 0;
+}
+
+static int csv_sort_compare(const csv_sort_spec* spec, const csv_sort_key* a, const csv_sort_key* b, size_t first_key)
+{
+    for (size_t k = first_key; k < spec->n_keys; ++k)
+    {
+        int cmp = csv_sort_compare_key(&a[k], &b[k]);
+        if (cmp != 0)
+            return spec->orders[k] == CSV_SORT_DESCENDING ? -cmp : cmp;
+    }
+    return 0;
+}
+
+// maps an empty or numeric key to an unsigned integer with the same order (empty sorts below every number)
+static uint64_t csv_sort_radix(const csv_sort_key* key, csv_sort_order order)
+{
+    uint64_t bits = 0;
+    if (key->kind == CSV_SORT_NUMBER)
+    {
+        memcpy(&bits, &key->number, sizeof(bits));
+        bits = (bits >> 63) ? ~bits : bits | (1ULL << 63);
+    }
+    return order == CSV_SORT_DESCENDING ? ~bits : bits;
+}
+
+// stable LSD radix sort on radix, one byte per pass; passes where every row shares the byte are skipped
+static void csv_sort_radix_rows(csv_sort_row* rows, csv_sort_row* scratch, size_t n_rows)
+{
+    csv_sort_row* from = rows;
+    csv_sort_row* to = scratch;
+    for (unsigned shift = 0; shift < 64; shift += 8)
+    {
+        size_t counts[256] = { 0 };
+        for (size_t i = 0; i < n_rows; ++i)
+            counts[(from[i].radix >> shift) & 0xFF]++;
+        if (counts[(from[0].radix >> shift) & 0xFF] == n_rows)
+            continue;
+
+        size_t offset = 0;
+        for (size_t b = 0; b < 256; ++b)
+        {
+            size_t count = counts[b];
+            counts[b] = offset;
+            offset += count;
+        }
+        for (size_t i = 0; i < n_rows; ++i)
+            to[counts[(from[i].radix >> shift) & 0xFF]++] = from[i];
+
+        csv_sort_row* swap = from;
+        from = to;
+        to = swap;
+    }
+
+    if (from != rows)
+        memcpy(rows, from, sizeof(csv_sort_row) * n_rows);
+}
+
+// stable merge sort comparing keys from first_key on
+static void csv_sort_merge_rows(const csv_sort_spec* spec, csv_sort_row* rows, csv_sort_row* scratch, size_t n_rows, size_t first_key)
+{
+    if (n_rows < 16)
+    {
+        for (size_t i = 1; i < n_rows; ++i)
+        {
+            csv_sort_row row = rows[i];
+            size_t j = i;
+            while (j > 0 && csv_sort_compare(spec, rows[j - 1].keys, row.keys, first_key) > 0)
+            {
+                rows[j] = rows[j - 1];
+                j--;
+            }
+            rows[j] = row;
+        }
+        return;
+    }
+
+    size_t half = n_rows / 2;
+    csv_sort_merge_rows(spec, rows, scratch, half, first_key);
+    csv_sort_merge_rows(spec, rows + half, scratch, n_rows - half, first_key);
+    if (csv_sort_compare(spec, rows[half - 1].keys, rows[half].keys, first_key) <= 0)
+        return;
+
+    memcpy(scratch, rows, sizeof(csv_sort_row) * half);
+    size_t i = 0;
+    size_t j = half;
+    size_t out = 0;
+    while (i < half && j < n_rows)
+        rows[out++] = csv_sort_compare(spec, rows[j].keys, scratch[i].keys, first_key) < 0 ? rows[j++] : scratch[i++];
+    while (i < half)
+        rows[out++] = scratch[i++];
+}
+
+// sorts one in-memory run: radix sort when the leading key is numeric (or empty) throughout, merge sort otherwise
+static void csv_sort_run(const csv_sort_spec* spec, csv_sort_row* rows, csv_sort_row* scratch, size_t n_rows)
+{
+    if (spec->n_keys == 0 || n_rows < 2)
+        return;
+
+    bool numeric = true;
+    for (size_t i = 0; i < n_rows && numeric; ++i)
+        numeric = rows[i].keys[0].kind != CSV_SORT_TEXT;
+    if (!numeric)
+    {
+        csv_sort_merge_rows(spec, rows, scratch, n_rows, 0);
+        return;
+    }
+
+    for (size_t i = 0; i < n_rows; ++i)
+        rows[i].radix = csv_sort_radix(&rows[i].keys[0], spec->orders[0]);
+    csv_sort_radix_rows(rows, scratch, n_rows);
+
+    // rows with equal leading keys are ordered by the remaining keys
+    if (spec->n_keys > 1)
+        for (size_t start = 0, end; start < n_rows; start = end)
+        {
+            end = start + 1;
+            while (end < n_rows && rows[end].radix == rows[start].radix)
+                end++;
+            if (end - start > 1)
+                csv_sort_merge_rows(spec, rows + start, scratch, end - start, 1);
+        }
+}
+
+static void csv_sort_write_line(FILE* file, const char* line, size_t len)
+{
+    fwrite(line, 1, len, file);
+    if (len == 0 || line[len - 1] != '\n')
+        fputc('\n', file);
+}
+
+static FILE* csv_sort_temp_file(void)
+{
+    FILE* file = tmpfile();
+    if (file == NULL)
+    {
+        printf("Could not create a temporary file!\n");
+        exit(-1);
+    }
+    return file;
+}
+
+static void csv_sort_advance(const csv_sort_spec* spec, csv_sort_cursor* cursor)
+{
+    ssize_t read = getline(&cursor->line, &cursor->capacity, cursor->file);
+    if (read == -1)
+    {
+        cursor->done = true;
+        return;
+    }
+    cursor->len = read;
+    csv_sort_extract_keys(spec, cursor->line, cursor->len, cursor->keys);
+}
+
+// true if run a's current row comes before run b's; ties go to the earlier run so the merge is stable
+// index n_runs is the sentinel that beats everything while the tree is being built
+static bool csv_sort_wins(const csv_sort_spec* spec, const csv_sort_cursor* cursors, size_t n_runs, size_t a, size_t b)
+{
+    if (a == n_runs)
+        return true;
+    if (b == n_runs)
+        return false;
+    if (cursors[a].done || cursors[b].done)
+        return !cursors[a].done;
+
+    int cmp = csv_sort_compare(spec, cursors[a].keys, cursors[b].keys, 0);
+    return cmp < 0 || (cmp == 0 && a < b);
+}
+
+// replays the matches from leaf run up to the root; tree[0] holds the winner, tree[1..n_runs) the losers
+static void csv_sort_replay(const csv_sort_spec* spec, const csv_sort_cursor* cursors, size_t* tree, size_t n_runs, size_t run)
+{
+    size_t winner = run;
+    for (size_t node = (run + n_runs) / 2; node > 0; node /= 2)
+        if (csv_sort_wins(spec, cursors, n_runs, tree[node], winner))
+        {
+            size_t loser = winner;
+            winner = tree[node];
+            tree[node] = loser;
+        }
+    tree[0] = winner;
+}
+
+// k-way merge of sorted runs with a loser tree: each output row costs log2(k) comparisons
+// the runs are closed afterwards
+static void csv_sort_merge(const csv_sort_spec* spec, FILE** runs, size_t n_runs, FILE* output)
+{
+    csv_sort_cursor* cursors = csv_calloc(n_runs, sizeof(csv_sort_cursor));
+    size_t* tree = csv_malloc(sizeof(size_t) * n_runs);
+    for (size_t r = 0; r < n_runs; ++r)
+    {
+        cursors[r].file = runs[r];
+        cursors[r].keys = csv_malloc(sizeof(csv_sort_key) * (spec->n_keys > 0 ? spec->n_keys : 1));
+        csv_sort_advance(spec, &cursors[r]);
+        tree[r] = n_runs;
+    }
+    for (size_t r = n_runs; r-- > 0;)
+        csv_sort_replay(spec, cursors, tree, n_runs, r);
+
+    while (!cursors[tree[0]].done)
+    {
+        size_t winner = tree[0];
+        csv_sort_write_line(output, cursors[winner].line, cursors[winner].len);
+        csv_sort_advance(spec, &cursors[winner]);
+        csv_sort_replay(spec, cursors, tree, n_runs, winner);
+    }
+
+    for (size_t r = 0; r < n_runs; ++r)
+    {
+        // getline() buffer
+        free(cursors[r].line);
+        csv_dealloc(cursors[r].keys);
+        fclose(cursors[r].file);
+    }
+    csv_dealloc(tree);
+    csv_dealloc(cursors);
+}
+
+// adds a spilled run; a full level is merged into a single run one level up
+static void csv_sort_add_run(const csv_sort_spec* spec, csv_sort_level* levels, size_t level, FILE* run)
+{
+    levels[level].runs[levels[level].n_runs++] = run;
+    if (levels[level].n_runs < CSV_SORT_FANIN || level + 1 == CSV_SORT_LEVELS)
+        return;
+
+    FILE* merged = csv_sort_temp_file();
+    csv_sort_merge(spec, levels[level].runs, levels[level].n_runs, merged);
+    rewind(merged);
+    levels[level].n_runs = 0;
+    csv_sort_add_run(spec, levels, level + 1, merged);
+}
+
+static void csv_sort_stream(const csv_sort_spec* spec, FILE* input, FILE* output, size_t memory_budget)
+{
+    if (memory_budget == 0)
+        memory_budget = CSV_SORT_DEFAULT_BUDGET;
+
+    csv_arena arena = { NULL };
+    csv_sort_row* rows = NULL;
+    size_t rows_capacity = 0;
+    size_t n_rows = 0;
+    size_t used = 0;
+    csv_sort_level* levels = csv_calloc(CSV_SORT_LEVELS, sizeof(csv_sort_level));
+    bool spilled = false;
+
+    char* line = NULL;
+    size_t len = 0;
+    ssize_t read;
+    for (;;)
+    {
+        read = getline(&line, &len, input);
+
+        // every row is charged its bytes, its keys and two row slots (the second is sort scratch space)
+        size_t row_cost = read != -1 ? (size_t)read + sizeof(csv_sort_key) * spec->n_keys + sizeof(csv_sort_row) * 2 + 2 * sizeof(void*) : 0;
+        if (n_rows > 0 && (read == -1 ? spilled : used + row_cost > memory_budget))
+        {
+            csv_sort_row* scratch = csv_malloc(sizeof(csv_sort_row) * n_rows);
+            csv_sort_run(spec, rows, scratch, n_rows);
+            csv_dealloc(scratch);
+
+            FILE* run = csv_sort_temp_file();
+            for (size_t i = 0; i < n_rows; ++i)
+                csv_sort_write_line(run, rows[i].line, rows[i].len);
+            rewind(run);
+            csv_sort_add_run(spec, levels, 0, run);
+            spilled = true;
+
+            csv_arena_free(&arena);
+            n_rows = 0;
+            used = 0;
+        }
+        if (read == -1)
+            break;
+
+        if (n_rows == rows_capacity)
+        {
+            rows_capacity = rows_capacity == 0 ? 1024 : rows_capacity * 2;
+            rows = csv_realloc(rows, sizeof(csv_sort_row) * rows_capacity);
+        }
+        csv_sort_row* row = &rows[n_rows++];
+        char* copy = csv_arena_alloc(&arena, read);
+        memcpy(copy, line, read);
+        row->line = copy;
+        row->len = read;
+        row->keys = csv_arena_alloc(&arena, sizeof(csv_sort_key) * spec->n_keys);
+        csv_sort_extract_keys(spec, row->line, row->len, row->keys);
+        used += row_cost;
+    }
+    // getline() buffer
+    free(line);
+
+    if (!spilled)
+    {
+        // everything fit in the budget: no temporary files
+        csv_sort_row* scratch = csv_malloc(sizeof(csv_sort_row) * (n_rows > 0 ? n_rows : 1));
+        csv_sort_run(spec, rows, scratch, n_rows);
+        csv_dealloc(scratch);
+        for (size_t i = 0; i < n_rows; ++i)
+            csv_sort_write_line(output, rows[i].line, rows[i].len);
+    }
+    else
+    {
+        // earlier rows live in higher levels, so runs are merged from the top level down to keep ties in input order
+        FILE* runs[CSV_SORT_FANIN * CSV_SORT_LEVELS];
+        size_t n_runs = 0;
+        for (size_t level = CSV_SORT_LEVELS; level-- > 0;)
+            for (size_t r = 0; r < levels[level].n_runs; ++r)
+                runs[n_runs++] = levels[level].runs[r];
+        csv_sort_merge(spec, runs, n_runs, output);
+    }
+
+    csv_arena_free(&arena);
+    csv_dealloc(rows);
+    csv_dealloc(levels);
+}
+
+void csv_sort(const char* input_filename, const char* output_filename, char** key_columns, csv_sort_order* orders, size_t n_keys, size_t memory_budget, char delim)
+{
+    FILE* file = fopen(input_filename, "r");
+    if (file == NULL)
+    {
+        printf("File not found!\n");
+        exit(-1);
+    }
+
+    // resolve the names against the header; unknown columns sort as empty
+    size_t* key_indices = csv_malloc(sizeof(size_t) * (n_keys > 0 ? n_keys : 1));
+    csv_find_columns(file, delim, key_columns, n_keys, key_indices);
+    fclose(file);
+
+    csv_sort_by_index(input_filename, output_filename, key_indices, orders, n_keys, memory_budget, delim, true);
+    csv_dealloc(key_indices);
+}
+
+void csv_sort_by_index(const char* input_filename, const char* output_filename, size_t* key_indices, csv_sort_order* orders, size_t n_keys, size_t memory_budget, char delim, bool has_headers)
+{
+    FILE* input = fopen(input_filename, "r");
+    if (input == NULL)
+    {
+        printf("File not found!\n");
+        exit(-1);
+    }
+    FILE* output = fopen(output_filename, "w");
+    if (output == NULL)
+    {
+        printf("Could not write %s!\n", output_filename);
+        exit(-1);
+    }
+
+    csv_sort_spec spec;
+    spec.key_indices = key_indices;
+    spec.orders = orders;
+    spec.n_keys = n_keys;
+    spec.max_index = 0;
+    spec.delim = delim;
+    for (size_t k = 0; k < n_keys; ++k)
+        if (key_indices[k] != SIZE_MAX && key_indices[k] > spec.max_index)
+            spec.max_index = key_indices[k];
+
+    // the header is copied through unsorted, without a byte order mark
+    csv_skip_bom(input);
+    if (has_headers)
+    {
+        char* line = NULL;
+        size_t len = 0;
+        ssize_t read = getline(&line, &len, input);
+        if (read != -1)
+            csv_sort_write_line(output, line, read);
+        free(line);
+    }
+
+    csv_sort_stream(&spec, input, output, memory_budget);
+
+    fclose(input);
+    fclose(output);
+}
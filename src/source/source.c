@@ -0,0 +1,37 @@
+#include "source/source.h"
+
+csv_source csv_source_from_buffer(const char* buffer, size_t size)
+{
+    csv_source source;
+    source.kind = CSV_SOURCE_BUFFER;
+    source.buffer = buffer;
+    source.buffer_size = size;
+    source.file = NULL;
+    source.fd = -1;
+    source.decompressor = NULL;
+    return source;
+}
+
+csv_source csv_source_from_stream(FILE* file)
+{
+    csv_source source;
+    source.kind = CSV_SOURCE_STREAM;
+    source.buffer = NULL;
+    source.buffer_size = 0;
+    source.file = file;
+    source.fd = -1;
+    source.decompressor = NULL;
+    return source;
+}
+
+csv_source csv_source_from_fd(int fd)
+{
+    csv_source source;
+    source.kind = CSV_SOURCE_FD;
+    source.buffer = NULL;
+    source.buffer_size = 0;
+    source.file = NULL;
+    source.fd = fd;
+    source.decompressor = NULL;
+    return source;
+}
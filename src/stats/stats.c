@@ -0,0 +1,135 @@
+#include <math.h>
+
+#include "csvinternal.h"
+#include "stats/stats.h"
+
+static void csv_stats_init(csv_stats* stats)
+{
+    stats->count = 0;
+    stats->null_count = 0;
+    stats->sum = 0.0;
+    stats->min = NAN;
+    stats->max = NAN;
+    stats->mean = NAN;
+    stats->variance = NAN;
+}
+
+static void csv_stats_push(csv_stats* stats, const char* cell, double* m2)
+{
+    char* end;
+    double value = strtod(cell, &end);
+    if (end == cell)
+    {
+        stats->null_count++;
+        return;
+    }
+
+    // Welford's update keeps mean and variance numerically stable in a single pass
+    stats->count++;
+    stats->sum += value;
+    if (stats->count == 1)
+    {
+        stats->min = value;
+        stats->max = value;
+        stats->mean = value;
+        *m2 = 0.0;
+        return;
+    }
+
+    if (value < stats->min)
+        stats->min = value;
+    if (value > stats->max)
+        stats->max = value;
+
+    double delta = value - stats->mean;
+    stats->mean += delta / stats->count;
+    *m2 += delta * (value - stats->mean);
+}
+
+// streams every remaining line of file and updates one csv_stats per column index.
+// a column index of SIZE_MAX (unknown column) treats every cell as null
+static void csv_stats_stream(FILE* file, const size_t* column_indices, size_t n_columns, csv_stats* stats, char delim)
+{
+    char* line = NULL;
+    size_t len = 0;
+
+    size_t max_fields = 0;
+    for (size_t c = 0; c < n_columns; ++c)
+        if (column_indices[c] != SIZE_MAX && column_indices[c] + 1 > max_fields)
+            max_fields = column_indices[c] + 1;
+
+    char** fields = csv_malloc(sizeof(char*) * (max_fields > 0 ? max_fields : 1));
+    double* m2 = csv_calloc(n_columns, sizeof(double));
+
+    for (size_t c = 0; c < n_columns; ++c)
+        csv_stats_init(&stats[c]);
+
+    while (getline(&line, &len, file) != -1)
+    {
+        size_t n_fields = csv_split_line(line, delim, fields, max_fields);
+        for (size_t c = 0; c < n_columns; ++c)
+        {
+            if (column_indices[c] >= n_fields)
+                stats[c].null_count++;
+            else
+                csv_stats_push(&stats[c], fields[column_indices[c]], &m2[c]);
+        }
+    }
+
+    for (size_t c = 0; c < n_columns; ++c)
+        if (stats[c].count > 1)
+            stats[c].variance = m2[c] / (stats[c].count - 1);
+
+    csv_dealloc(m2);
+    csv_dealloc(fields);
+    free(line);
+}
+
+void csv_column_stats(const char* filename, char** column_names, size_t n_columns, csv_stats** stats, char delim)
+{
+    FILE* file = fopen(filename, "r");
+    if (file != NULL)
+    {
+        // resolve the names against the header once, then stream the rest of the file
+        size_t* column_indices = csv_malloc(sizeof(size_t) * (n_columns > 0 ? n_columns : 1));
+        csv_find_columns(file, delim, column_names, n_columns, column_indices);
+
+        (*stats) = csv_malloc(sizeof(csv_stats) * (n_columns > 0 ? n_columns : 1));
+        csv_stats_stream(file, column_indices, n_columns, *stats, delim);
+
+        csv_dealloc(column_indices);
+        fclose(file);
+    }
+    else
+    {
+        printf("File not found!\n");
+        exit(-1);
+    }
+}
+
+void csv_column_stats_by_index(const char* filename, size_t* column_indices, size_t n_columns, csv_stats** stats, char delim, bool has_headers)
+{
+    FILE* file = fopen(filename, "r");
+    if (file != NULL)
+    {
+        // skip the byte order mark and the header line if present
+        csv_skip_bom(file);
+        if (has_headers)
+        {
+            char* line = NULL;
+            size_t len = 0;
+            getline(&line, &len, file);
+            free(line);
+        }
+
+        (*stats) = csv_malloc(sizeof(csv_stats) * (n_columns > 0 ? n_columns : 1));
+        csv_stats_stream(file, column_indices, n_columns, *stats, delim);
+
+        fclose(file);
+    }
+    else
+    {
+        printf("File not found!\n");
+        exit(-1);
+    }
+}
@@ -0,0 +1,239 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "csvinternal.h"
+#include "utf8/utf8.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <tmmintrin.h>
+#define CSV_UTF8_SSSE3
+#endif
+
+#define CSV_UTF8_ASCII_MASK 0x8080808080808080ULL
+
+// offset of the first byte at or after start that is not ASCII, checking 8 bytes at a time (SWAR)
+static size_t csv_utf8_skip_ascii(const char* data, size_t start, size_t len)
+{
+    for (; start + 8 <= len; start += 8)
+    {
+        uint64_t word;
+        memcpy(&word, data + start, sizeof(word));
+        if (word & CSV_UTF8_ASCII_MASK)
+            break;
+    }
+    while (start < len && (unsigned char)data[start] < 0x80)
+        start++;
+    return start;
+}
+
+// finds the first invalid sequence one code point at a time: no overlong forms, surrogates or code points past U+10FFFF
+static size_t csv_utf8_locate(const char* data, size_t start, size_t len)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    size_t i = start;
+    while ((i = csv_utf8_skip_ascii(data, i, len)) < len)
+    {
+        unsigned char lead = bytes[i];
+        size_t n_bytes;
+        unsigned char second_min = 0x80;
+        unsigned char second_max = 0xBF;
+        if (lead >= 0xC2 && lead <= 0xDF)
+            n_bytes = 2;
+        else if (lead >= 0xE0 && lead <= 0xEF)
+        {
+            n_bytes = 3;
+            second_min = lead == 0xE0 ? 0xA0 : 0x80;
+            second_max = lead == 0xED ? 0x9F : 0xBF;
+        }
+        else if (lead >= 0xF0 && lead <= 0xF4)
+        {
+            n_bytes = 4;
+            second_min = lead == 0xF0 ? 0x90 : 0x80;
+            second_max = lead == 0xF4 ? 0x8F : 0xBF;
+        }
+        else
+            return i;
+
+        if (i + n_bytes > len || bytes[i + 1] < second_min || bytes[i + 1] > second_max)
+            return i;
+        for (size_t k = 2; k < n_bytes; ++k)
+            if ((bytes[i + k] & 0xC0) != 0x80)
+                return i;
+        i += n_bytes;
+    }
+    return len;
+}
+
+#ifdef CSV_UTF8_SSSE3
+
+// the lookup tables of Keiser and Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte" (2021), as used by simdjson:
+// each error class is a bit that is set in all three tables only for the byte pairs that have that error
+#define CSV_UTF8_TOO_SHORT (1 << 0)
+#define CSV_UTF8_TOO_LONG (1 << 1)
+#define CSV_UTF8_OVERLONG_3 (1 << 2)
+#define CSV_UTF8_TOO_LARGE (1 << 3)
+#define CSV_UTF8_SURROGATE (1 << 4)
+#define CSV_UTF8_OVERLONG_2 (1 << 5)
+#define CSV_UTF8_TOO_LARGE_1000 (1 << 6)
+#define CSV_UTF8_OVERLONG_4 (1 << 6)
+#define CSV_UTF8_TWO_CONTS (1 << 7)
+#define CSV_UTF8_CARRY (CSV_UTF8_TOO_SHORT | CSV_UTF8_TOO_LONG | CSV_UTF8_TWO_CONTS)
+
+__attribute__((target("ssse3")))
+static __m128i csv_utf8_block_errors(__m128i input, __m128i previous)
+{
+    const __m128i low_nibble = _mm_set1_epi8(0x0F);
+    const __m128i byte_1_high_table = _mm_setr_epi8(
+        CSV_UTF8_TOO_LONG, CSV_UTF8_TOO_LONG, CSV_UTF8_TOO_LONG, CSV_UTF8_TOO_LONG,
+        CSV_UTF8_TOO_LONG, CSV_UTF8_TOO_LONG, CSV_UTF8_TOO_LONG, CSV_UTF8_TOO_LONG,
+        CSV_UTF8_TWO_CONTS, CSV_UTF8_TWO_CONTS, CSV_UTF8_TWO_CONTS, CSV_UTF8_TWO_CONTS,
+        CSV_UTF8_TOO_SHORT | CSV_UTF8_OVERLONG_2,
+        CSV_UTF8_TOO_SHORT,
+        CSV_UTF8_TOO_SHORT | CSV_UTF8_OVERLONG_3 | CSV_UTF8_SURROGATE,
+        CSV_UTF8_TOO_SHORT | CSV_UTF8_TOO_LARGE | CSV_UTF8_TOO_LARGE_1000 | CSV_UTF8_OVERLONG_4);
+    const __m128i byte_1_low_table = _mm_setr_epi8(
+        CSV_UTF8_CARRY | CSV_UTF8_OVERLONG_3 | CSV_UTF8_OVERLONG_2 | CSV_UTF8_OVERLONG_4,
+        CSV_UTF8_CARRY | CSV_UTF8_OVERLONG_2,
+        CSV_UTF8_CARRY,
+        CSV_UTF8_CARRY,
+        CSV_UTF8_CARRY | CSV_UTF8_TOO_LARGE,
+        CSV_UTF8_CARRY | CSV_UTF8_TOO_LARGE | CSV_UTF8_TOO_LARGE_1000,
+        CSV_UTF8_CARRY | CSV_UTF8_TOO_LARGE | CSV_UTF8_TOO_LARGE_1000,
+        CSV_UTF8_CARRY | CSV_UTF8_TOO_LARGE | CSV_UTF8_TOO_LARGE_1000,
+        CSV_UTF8_CARRY | CSV_UTF8_TOO_LARGE | CSV_UTF8_TOO_LARGE_1000,
+        CSV_UTF8_CARRY | CSV_UTF8_TOO_LARGE | CSV_UTF8_TOO_LARGE_1000,
+        CSV_UTF8_CARRY | CSV_UTF8_TOO_LARGE | CSV_UTF8_TOO_LARGE_1000,
+        CSV_UTF8_CARRY | CSV_UTF8_TOO_LARGE | CSV_UTF8_TOO_LARGE_1000,
+        CSV_UTF8_CARRY | CSV_UTF8_TOO_LARGE | CSV_UTF8_TOO_LARGE_1000,
+        CSV_UTF8_CARRY | CSV_UTF8_TOO_LARGE | CSV_UTF8_TOO_LARGE_1000 | CSV_UTF8_SURROGATE,
+        CSV_UTF8_CARRY | CSV_UTF8_TOO_LARGE | CSV_UTF8_TOO_LARGE_1000,
+        CSV_UTF8_CARRY | CSV_UTF8_TOO_LARGE | CSV_UTF8_TOO_LARGE_1000);
+    const __m128i byte_2_high_table = _mm_setr_epi8(
+        CSV_UTF8_TOO_SHORT, CSV_UTF8_TOO_SHORT, CSV_UTF8_TOO_SHORT, CSV_UTF8_TOO_SHORT,
+        CSV_UTF8_TOO_SHORT, CSV_UTF8_TOO_SHORT, CSV_UTF8_TOO_SHORT, CSV_UTF8_TOO_SHORT,
+        CSV_UTF8_TOO_LONG | CSV_UTF8_OVERLONG_2 | CSV_UTF8_TWO_CONTS | CSV_UTF8_OVERLONG_3 | CSV_UTF8_TOO_LARGE_1000 | CSV_UTF8_OVERLONG_4,
+        CSV_UTF8_TOO_LONG | CSV_UTF8_OVERLONG_2 | CSV_UTF8_TWO_CONTS | CSV_UTF8_OVERLONG_3 | CSV_UTF8_TOO_LARGE,
+        CSV_UTF8_TOO_LONG | CSV_UTF8_OVERLONG_2 | CSV_UTF8_TWO_CONTS | CSV_UTF8_SURROGATE | CSV_UTF8_TOO_LARGE,
+        CSV_UTF8_TOO_LONG | CSV_UTF8_OVERLONG_2 | CSV_UTF8_TWO_CONTS | CSV_UTF8_SURROGATE | CSV_UTF8_TOO_LARGE,
+        CSV_UTF8_TOO_SHORT, CSV_UTF8_TOO_SHORT, CSV_UTF8_TOO_SHORT, CSV_UTF8_TOO_SHORT);
+
+    // each byte is looked up together with the 1, 2 and 3 bytes before it, which may be in the previous block
+    __m128i previous_1 = _mm_alignr_epi8(input, previous, 15);
+    __m128i byte_1_high = _mm_shuffle_epi8(byte_1_high_table, _mm_and_si128(_mm_srli_epi16(previous_1, 4), low_nibble));
+    __m128i byte_1_low = _mm_shuffle_epi8(byte_1_low_table, _mm_and_si128(previous_1, low_nibble));
+    __m128i byte_2_high = _mm_shuffle_epi8(byte_2_high_table, _mm_and_si128(_mm_srli_epi16(input, 4), low_nibble));
+    __m128i special_cases = _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+
+    // the third and fourth bytes of 3 and 4 byte sequences must be continuations, which the tables flag as TWO_CONTS
+    __m128i previous_2 = _mm_alignr_epi8(input, previous, 14);
+    __m128i previous_3 = _mm_alignr_epi8(input, previous, 13);
+    __m128i is_third_byte = _mm_subs_epu8(previous_2, _mm_set1_epi8((char)(0xE0 - 0x80)));
+    __m128i is_fourth_byte = _mm_subs_epu8(previous_3, _mm_set1_epi8((char)(0xF0 - 0x80)));
+    __m128i must_be_continuation = _mm_and_si128(_mm_or_si128(is_third_byte, is_fourth_byte), _mm_set1_epi8((char)0x80));
+    return _mm_xor_si128(must_be_continuation, special_cases);
+}
+
+// non-zero where a block ends inside a sequence, which the next block (or the end of the line) must complete
+__attribute__((target("ssse3")))
+static __m128i csv_utf8_incomplete(__m128i input)
+{
+    const __m128i max_value = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                            (char)(0xF0 - 1), (char)(0xE0 - 1), (char)(0xC0 - 1));
+    return _mm_subs_epu8(input, max_value);
+}
+
+// true if len bytes of data are valid UTF-8, 16 bytes at a time
+__attribute__((target("ssse3")))
+static bool csv_utf8_valid_ssse3(const char* data, size_t len)
+{
+    __m128i errors = _mm_setzero_si128();
+    __m128i previous = _mm_setzero_si128();
+    __m128i previous_incomplete = _mm_setzero_si128();
+    for (size_t i = 0; i < len; i += 16)
+    {
+        __m128i input;
+        if (i + 16 <= len)
+            input = _mm_loadu_si128((const __m128i*)(data + i));
+        else
+        {
+            // the tail is padded with zeros, which are ASCII
+            char tail[16] = { 0 };
+            memcpy(tail, data + i, len - i);
+            input = _mm_loadu_si128((const __m128i*)tail);
+        }
+
+        // an ASCII block only has to complete the sequence the previous block ended in
+        if (_mm_movemask_epi8(input) == 0)
+            errors = _mm_or_si128(errors, previous_incomplete);
+        else
+        {
+            errors = _mm_or_si128(errors, csv_utf8_block_errors(input, previous));
+            previous_incomplete = csv_utf8_incomplete(input);
+        }
+        previous = input;
+    }
+    errors = _mm_or_si128(errors, previous_incomplete);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(errors, _mm_setzero_si128())) == 0xFFFF;
+}
+
+#endif
+
+size_t csv_utf8_validate(const char* data, size_t len)
+{
+    // most lines are pure ASCII and never get past this
+    size_t start = csv_utf8_skip_ascii(data, 0, len);
+    if (start == len)
+        return len;
+
+    // the vectorized check only says whether there is an error; the exact offset is found one code point at a time
+#ifdef CSV_UTF8_SSSE3
+    if (__builtin_cpu_supports("ssse3") && csv_utf8_valid_ssse3(data + start, len - start))
+        return len;
+#endif
+    return csv_utf8_locate(data, start, len);
+}
+
+void csv_read_validated(const char* filename, char**** data, size_t (*data_dims)[2], char delim, bool has_headers, csv_utf8_error* error)
+{
+    FILE* file = fopen(filename, "r");
+    if (file == NULL)
+    {
+        printf("File not found!\n");
+        exit(-1);
+    }
+
+    csv_source source = csv_source_from_stream(file);
+    csv_read_validated_from(&source, data, data_dims, delim, has_headers, error);
+    fclose(file);
+}
+
+void csv_read_validated_from(csv_source* source, char**** data, size_t (*data_dims)[2], char delim, bool has_headers, csv_utf8_error* error)
+{
+    csv_reader reader;
+    csv_reader_init(&reader, source);
+    csv_reader_validate_utf8(&reader, delim, error);
+    csv_read_rows(&reader, SIZE_MAX, data, data_dims, delim, has_headers);
+    csv_reader_free(&reader);
+}
+
+bool csv_validate_utf8(const char* filename, char delim, csv_utf8_error* error)
+{
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1)
+    {
+        printf("File not found!\n");
+        exit(-1);
+    }
+
+    csv_source source = csv_source_from_fd(fd);
+    csv_reader reader;
+    csv_reader_init(&reader, &source);
+    csv_reader_validate_utf8(&reader, delim, error);
+    const char* line;
+    size_t len;
+    while (csv_reader_next(&reader, &line, &len))
+        ;
+    csv_reader_free(&reader);
+    close(fd);
+    return !error->found;
+}
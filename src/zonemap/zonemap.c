@@ -0,0 +1,479 @@
+#include <fcntl.h>
+#include <math.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "csvinternal.h"
+#include "zonemap/zonemap.h"
+
+#define CSV_ZONE_MAGIC "CSVZONE2"
+#define CSV_ZONE_SUFFIX ".zonemap"
+#define CSV_ZONE_DEFAULT_ROWS 65536
+#define CSV_ZONE_PREFIX 32
+
+// sidecar layout (native endianness): csv_zone_header, csv_zone_group groups[n_groups], csv_zone zones[n_groups][n_columns]
+typedef struct csv_zone_header
+{
+    char magic[8];
+    uint64_t source_size;
+    int64_t source_mtime_sec;
+    int64_t source_mtime_nsec;
+    uint64_t delim;
+    uint64_t has_headers;
+    uint64_t n_groups;
+    uint64_t n_columns;
+} csv_zone_header;
+
+// byte range [start, end) of a group of rows
+typedef struct csv_zone_group
+{
+    uint64_t start;
+    uint64_t end;
+} csv_zone_group;
+
+// statistics of one column within one group
+// text_min/text_max hold the first CSV_ZONE_PREFIX bytes of the smallest/largest non-empty cell in byte order
+typedef struct csv_zone
+{
+    double min;
+    double max;
+    uint64_t null_count;
+    uint64_t numeric_count;
+    uint64_t text_count;
+    uint32_t text_min_len;
+    uint32_t text_max_len;
+    uint32_t text_max_truncated;
+    uint32_t reserved;
+    char text_min[CSV_ZONE_PREFIX];
+    char text_max[CSV_ZONE_PREFIX];
+} csv_zone;
+
+// a column's statistics while its group is being read, with the full text min/max
+typedef struct csv_zone_builder
+{
+    csv_zone zone;
+    char* text_min;
+    size_t text_min_len;
+    char* text_max;
+    size_t text_max_len;
+} csv_zone_builder;
+
+// a loaded sidecar
+typedef struct csv_zone_map
+{
+    char* buffer;
+    const csv_zone_header* header;
+    const csv_zone_group* groups;
+    const csv_zone* zones;
+} csv_zone_map;
+
+// a range predicate on one column
+typedef struct csv_zone_range
+{
+    const char* low;
+    size_t low_len;
+    const char* high;
+    size_t high_len;
+    bool numeric;
+    double low_value;
+    double high_value;
+} csv_zone_range;
+
+static char* csv_zone_path(const char* filename)
+{
+    char* path = csv_malloc(strlen(filename) + strlen(CSV_ZONE_SUFFIX) + 1);
+    strcpy(path, filename);
+    strcat(path, CSV_ZONE_SUFFIX);
+    return path;
+}
+
+// true if the whole cell is a number (cells that cannot start one are rejected before strtod)
+static bool csv_zone_number(const char* cell, size_t len, double* value)
+{
+    char first = len > 0 ? cell[0] : 0;
+    if (len == 0 || len >= 64 || !((first >= '0' && first <= '9') || first == '-' || first == '+' || first == '.'))
+        return false;
+
+    char buffer[64];
+    memcpy(buffer, cell, len);
+    buffer[len] = 0;
+    char* end;
+    *value = strtod(buffer, &end);
+    return end == buffer + len && !isnan(*value);
+}
+
+static int csv_zone_compare(const char* a, size_t a_len, const char* b, size_t b_len)
+{
+    int cmp = memcmp(a, b, a_len < b_len ? a_len : b_len);
+    if (cmp != 0)
+        return cmp;
+    return (a_len > b_len) - (a_len < b_len);
+}
+
+static void csv_zone_copy(char** copy, size_t* copy_len, const char* cell, size_t len)
+{
+    *copy = csv_realloc(*copy, len > 0 ? len : 1);
+    memcpy(*copy, cell, len);
+    *copy_len = len;
+}
+
+static void csv_zone_reset(csv_zone_builder* builder)
+{
+    memset(&builder->zone, 0, sizeof(csv_zone));
+    builder->zone.min = NAN;
+    builder->zone.max = NAN;
+}
+
+static void csv_zone_add(csv_zone_builder* builder, const char* cell, size_t len)
+{
+    csv_zone* zone = &builder->zone;
+    if (len == 0)
+    {
+        zone->null_count++;
+        return;
+    }
+
+    double value;
+    if (csv_zone_number(cell, len, &value))
+    {
+        if (zone->numeric_count == 0 || value < zone->min)
+            zone->min = value;
+        if (zone->numeric_count == 0 || value > zone->max)
+            zone->max = value;
+        zone->numeric_count++;
+    }
+
+    if (zone->text_count == 0 || csv_zone_compare(cell, len, builder->text_min, builder->text_min_len) < 0)
+        csv_zone_copy(&builder->text_min, &builder->text_min_len, cell, len);
+    if (zone->text_count == 0 || csv_zone_compare(cell, len, builder->text_max, builder->text_max_len) > 0)
+        csv_zone_copy(&builder->text_max, &builder->text_max_len, cell, len);
+    zone->text_count++;
+}
+
+// stores the prefixes of the text min/max; a truncated min is still a lower bound, a truncated max is flagged
+static void csv_zone_finish(csv_zone_builder* builder, csv_zone* zone)
+{
+    *zone = builder->zone;
+    if (zone->text_count > 0)
+    {
+        zone->text_min_len = builder->text_min_len < CSV_ZONE_PREFIX ? builder->text_min_len : CSV_ZONE_PREFIX;
+        zone->text_max_len = builder->text_max_len < CSV_ZONE_PREFIX ? builder->text_max_len : CSV_ZONE_PREFIX;
+        zone->text_max_truncated = builder->text_max_len > CSV_ZONE_PREFIX;
+        memcpy(zone->text_min, builder->text_min, zone->text_min_len);
+        memcpy(zone->text_max, builder->text_max, zone->text_max_len);
+    }
+    csv_zone_reset(builder);
+}
+
+// false only if no cell described by zone can lie within range
+static bool csv_zone_may_match(const csv_zone* zone, const csv_zone_range* range)
+{
+    if (range->numeric)
+        return zone->numeric_count > 0
+               && !(range->low != NULL && zone->max < range->low_value)
+               && !(range->high != NULL && zone->min > range->high_value);
+
+    if (zone->text_count == 0)
+        return false;
+
+    // every cell is at least text_min, which is at least its stored prefix
+    if (range->high != NULL && csv_zone_compare(zone->text_min, zone->text_min_len, range->high, range->high_len) > 0)
+        return false;
+
+    // every cell is at most text_max; a truncated max is only known to start with its prefix
+    if (range->low != NULL)
+    {
+        if (!zone->text_max_truncated)
+            return csv_zone_compare(zone->text_max, zone->text_max_len, range->low, range->low_len) >= 0;
+        size_t len = zone->text_max_len < range->low_len ? zone->text_max_len : range->low_len;
+        return memcmp(zone->text_max, range->low, len) >= 0;
+    }
+    return true;
+}
+
+static bool csv_zone_cell_matches(const char* cell, size_t len, const csv_zone_range* range)
+{
+    if (len == 0)
+        return false;
+
+    if (range->numeric)
+    {
+        double value;
+        return csv_zone_number(cell, len, &value)
+               && !(range->low != NULL && value < range->low_value)
+               && !(range->high != NULL && value > range->high_value);
+    }
+
+    return !(range->low != NULL && csv_zone_compare(cell, len, range->low, range->low_len) < 0)
+           && !(range->high != NULL && csv_zone_compare(cell, len, range->high, range->high_len) > 0);
+}
+
+static bool csv_zone_load(const char* filename, const struct stat* source_stat, char delim, bool has_headers, csv_zone_map* map)
+{
+    char* path = csv_zone_path(filename);
+    FILE* file = fopen(path, "rb");
+    csv_dealloc(path);
+    if (file == NULL)
+        return false;
+
+    struct stat sidecar_stat;
+    fstat(fileno(file), &sidecar_stat);
+    size_t size = sidecar_stat.st_size;
+    map->buffer = csv_malloc(size > 0 ? size : 1);
+    bool valid = fread(map->buffer, 1, size, file) == size && size >= sizeof(csv_zone_header);
+    fclose(file);
+
+    // the zone map must describe this version of the file, read the same way
+    if (valid)
+    {
+        map->header = (const csv_zone_header*)map->buffer;
+        const csv_zone_header* header = map->header;
+        valid = memcmp(header->magic, CSV_ZONE_MAGIC, 8) == 0
+                && header->source_size == (uint64_t)source_stat->st_size
+                && header->source_mtime_sec == (int64_t)source_stat->st_mtim.tv_sec
+                && header->source_mtime_nsec == (int64_t)source_stat->st_mtim.tv_nsec
+                && header->delim == (uint64_t)(unsigned char)delim
+                && header->has_headers == (uint64_t)has_headers
+                && size == sizeof(csv_zone_header) + header->n_groups * (sizeof(csv_zone_group) + header->n_columns * sizeof(csv_zone));
+    }
+    if (!valid)
+    {
+        csv_dealloc(map->buffer);
+        return false;
+    }
+
+    map->groups = (const csv_zone_group*)(map->buffer + sizeof(csv_zone_header));
+    map->zones = (const csv_zone*)(map->groups + map->header->n_groups);
+    return true;
+}
+
+void csv_build_zone_map(const char* filename, size_t rows_per_group, char delim, bool has_headers)
+{
+    FILE* file = fopen(filename, "r");
+    if (file == NULL)
+    {
+        printf("File not found!\n");
+        exit(-1);
+    }
+    struct stat source_stat;
+    fstat(fileno(file), &source_stat);
+    if (rows_per_group == 0)
+        rows_per_group = CSV_ZONE_DEFAULT_ROWS;
+
+    char* line = NULL;
+    size_t len = 0;
+    ssize_t read;
+    uint64_t offset = 0;
+    size_t n_columns = 0;
+
+    // the first line gives the column count; without headers it is also the first data row, which starts after any byte order mark
+    if ((read = getline(&line, &len, file)) != -1)
+    {
+        n_columns = csv_count_columns(line, delim);
+        if (has_headers)
+            offset = read;
+        else
+        {
+            rewind(file);
+            offset = csv_skip_bom(file);
+        }
+    }
+
+    csv_zone_builder* builders = csv_calloc(n_columns > 0 ? n_columns : 1, sizeof(csv_zone_builder));
+    for (size_t c = 0; c < n_columns; ++c)
+        csv_zone_reset(&builders[c]);
+    char** fields = csv_malloc(sizeof(char*) * (n_columns > 0 ? n_columns : 1));
+
+    size_t groups_capacity = 16;
+    size_t n_groups = 0;
+    csv_zone_group* groups = csv_malloc(sizeof(csv_zone_group) * groups_capacity);
+    csv_zone* zones = csv_malloc(sizeof(csv_zone) * groups_capacity * (n_columns > 0 ? n_columns : 1));
+
+    uint64_t group_start = offset;
+    size_t rows_in_group = 0;
+    for (;;)
+    {
+        read = getline(&line, &len, file);
+        if (read != -1)
+        {
+            size_t n_fields = csv_split_line(line, delim, fields, n_columns);
+            for (size_t c = 0; c < n_columns; ++c)
+            {
+                const char* cell = c < n_fields ? fields[c] : "";
+                csv_zone_add(&builders[c], cell, strlen(cell));
+            }
+            offset += read;
+            rows_in_group++;
+        }
+
+        // close the group when it is full or the file ends
+        if (rows_in_group == rows_per_group || (read == -1 && rows_in_group > 0))
+        {
+            if (n_groups == groups_capacity)
+            {
+                groups_capacity *= 2;
+                groups = csv_realloc(groups, sizeof(csv_zone_group) * groups_capacity);
+                zones = csv_realloc(zones, sizeof(csv_zone) * groups_capacity * (n_columns > 0 ? n_columns : 1));
+            }
+            groups[n_groups].start = group_start;
+            groups[n_groups].end = offset;
+            for (size_t c = 0; c < n_columns; ++c)
+                csv_zone_finish(&builders[c], &zones[n_groups * n_columns + c]);
+            n_groups++;
+            group_start = offset;
+            rows_in_group = 0;
+        }
+        if (read == -1)
+            break;
+    }
+    // getline() buffer
+    free(line);
+    fclose(file);
+
+    csv_zone_header header;
+    memset(&header, 0, sizeof(csv_zone_header));
+    memcpy(header.magic, CSV_ZONE_MAGIC, 8);
+    header.source_size = source_stat.st_size;
+    header.source_mtime_sec = source_stat.st_mtim.tv_sec;
+    header.source_mtime_nsec = source_stat.st_mtim.tv_nsec;
+    header.delim = (unsigned char)delim;
+    header.has_headers = has_headers;
+    header.n_groups = n_groups;
+    header.n_columns = n_columns;
+
+    // written to a temporary file and renamed into place so readers never see a partial zone map
+    char* path = csv_zone_path(filename);
+    char* tmp_path;
+    int fd = csv_create_temp_file(path, &tmp_path);
+    FILE* sidecar = fd != -1 ? fdopen(fd, "wb") : NULL;
+    if (sidecar == NULL)
+    {
+        if (fd != -1)
+            unlink(tmp_path);
+        printf("Could not write %s!\n", path);
+        exit(-1);
+    }
+    fwrite(&header, sizeof(csv_zone_header), 1, sidecar);
+    fwrite(groups, sizeof(csv_zone_group), n_groups, sidecar);
+    fwrite(zones, sizeof(csv_zone), n_groups * n_columns, sidecar);
+    fclose(sidecar);
+    rename(tmp_path, path);
+
+    for (size_t c = 0; c < n_columns; ++c)
+    {
+        csv_dealloc(builders[c].text_min);
+        csv_dealloc(builders[c].text_max);
+    }
+    csv_dealloc(builders);
+    csv_dealloc(fields);
+    csv_dealloc(groups);
+    csv_dealloc(zones);
+    csv_dealloc(tmp_path);
+    csv_dealloc(path);
+}
+
+// parses every line in [start, end) whose cell matches range into data
+static void csv_zone_scan(const char* map, size_t start, size_t end, size_t column_index, const csv_zone_range* range, char delim,
+                          char**** data, size_t* n_rows, size_t* rows_capacity)
+{
+    while (start < end)
+    {
+        const char* newline = memchr(map + start, '\n', end - start);
+        size_t line_end = newline != NULL ? (size_t)(newline - map) + 1 : end;
+        const char* line = map + start;
+        size_t len = line_end - start;
+        start = line_end;
+
+        const char* cell;
+        size_t cell_len;
+        if (!csv_find_cell(line, len, delim, column_index, &cell, &cell_len) || !csv_zone_cell_matches(cell, cell_len, range))
+            continue;
+
+        if (*n_rows == *rows_capacity)
+        {
+            *rows_capacity *= 2;
+            (*data) = csv_realloc((*data), sizeof(char**) * (*rows_capacity));
+        }
+        csv_parse_line_n(line, len, delim, &(*data)[(*n_rows)++]);
+    }
+}
+
+void csv_read_range_by_name(const char* filename, const char* column_name, const char* low, const char* high, char**** data, size_t (*data_dims)[2], char delim)
+{
+    FILE* file = fopen(filename, "r");
+    if (file == NULL)
+    {
+        printf("File not found!\n");
+        exit(-1);
+    }
+
+    // an unknown column matches nothing
+    size_t column_index;
+    char* names[1] = { (char*)column_name };
+    csv_find_columns(file, delim, names, 1, &column_index);
+    fclose(file);
+
+    csv_read_range_by_index(filename, column_index, low, high, data, data_dims, delim, true);
+}
+
+void csv_read_range_by_index(const char* filename, size_t column_index, const char* low, const char* high, char**** data, size_t (*data_dims)[2], char delim, bool has_headers)
+{
+    int fd = open(filename, O_RDONLY);
+    struct stat source_stat;
+    if (fd == -1 || fstat(fd, &source_stat) == -1)
+    {
+        printf("File not found!\n");
+        exit(-1);
+    }
+
+    size_t rows_capacity = 10;
+    size_t n_rows = 0;
+    (*data) = csv_calloc(rows_capacity, sizeof(char**));
+    (*data_dims)[0] = 0;
+    (*data_dims)[1] = 0;
+    size_t size = source_stat.st_size;
+    if (size == 0)
+    {
+        close(fd);
+        return;
+    }
+
+    // only the pages of groups that may match are ever touched
+    const char* map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        printf("File not found!\n");
+        exit(-1);
+    }
+
+    const char* first_newline = memchr(map, '\n', size);
+    size_t first_line_end = first_newline != NULL ? (size_t)(first_newline - map) + 1 : size;
+    (*data_dims)[1] = csv_count_columns_n(map, first_line_end, delim);
+
+    // bounds are compared as numbers only if every given bound is one
+    csv_zone_range range;
+    range.low = low;
+    range.low_len = low != NULL ? strlen(low) : 0;
+    range.high = high;
+    range.high_len = high != NULL ? strlen(high) : 0;
+    range.numeric = (low != NULL || high != NULL)
+                    && (low == NULL || csv_zone_number(low, range.low_len, &range.low_value))
+                    && (high == NULL || csv_zone_number(high, range.high_len, &range.high_value));
+
+    csv_zone_map zone_map;
+    if (csv_zone_load(filename, &source_stat, delim, has_headers, &zone_map))
+    {
+        const csv_zone_header* header = zone_map.header;
+        for (size_t g = 0; g < header->n_groups && column_index < header->n_columns; ++g)
+            if (csv_zone_may_match(&zone_map.zones[g * header->n_columns + column_index], &range))
+                csv_zone_scan(map, zone_map.groups[g].start, zone_map.groups[g].end, column_index, &range, delim, data, &n_rows, &rows_capacity);
+        csv_dealloc(zone_map.buffer);
+    }
+    else
+        csv_zone_scan(map, has_headers ? first_line_end : csv_bom_length(map, size), size, column_index, &range, delim, data, &n_rows, &rows_capacity);
+
+    (*data_dims)[0] = n_rows;
+    munmap((void*)map, size);
+}
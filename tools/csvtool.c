@@ -0,0 +1,802 @@
+// csvtool: the library's operations for shell pipelines, e.g.
+//     csvtool select -c name,price trades.csv | csvtool filter -c price --min 100 -
+// the input is mapped (or read from stdin), cut into chunks at line boundaries and processed by a pool of threads;
+// each chunk's output is buffered and written in file order, a batch of chunks at a time so memory stays bounded
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "csvparser.h"
+#include "csvinternal.h"
+
+#define CSVTOOL_CHUNK (4 * 1024 * 1024)
+#define CSVTOOL_CHUNKS_PER_THREAD 4
+
+typedef enum csvtool_command
+{
+    CSVTOOL_SELECT,
+    CSVTOOL_IGNORE,
+    CSVTOOL_HEAD,
+    CSVTOOL_COUNT,
+    CSVTOOL_STATS,
+    CSVTOOL_FILTER,
+    CSVTOOL_CONVERT
+} csvtool_command;
+
+typedef struct csvtool_options
+{
+    csvtool_command command;
+    const char* filename;
+    char delim;
+    bool has_headers;
+    size_t n_threads;
+    bool stats;
+    const char* column_names;
+    const char* column_indices;
+    size_t n_rows;
+    const char* low;
+    const char* high;
+    char out_delim;
+    bool jsonl;
+} csvtool_options;
+
+typedef struct csvtool_buffer
+{
+    char* data;
+    size_t len;
+    size_t capacity;
+} csvtool_buffer;
+
+// running statistics of one column (Welford), merged across chunks with Chan's formula
+typedef struct csvtool_moments
+{
+    size_t count;
+    size_t null_count;
+    double sum;
+    double min;
+    double max;
+    double mean;
+    double m2;
+} csvtool_moments;
+
+// everything one chunk of a batch owns
+typedef struct csvtool_slot
+{
+    csvtool_buffer output;
+    size_t n_lines;
+    size_t* cell_starts;
+    size_t* cell_lens;
+    size_t cell_capacity;
+    csvtool_moments* moments;
+} csvtool_slot;
+
+typedef struct csvtool_job
+{
+    const csvtool_options* options;
+    const char* data;
+    size_t size;
+    const size_t* chunk_starts;
+    size_t first_chunk;
+    csvtool_slot* slots;
+
+    // the columns a command works on: kept by select/ignore, summarised by stats, tested by filter
+    size_t* columns;
+    size_t n_columns;
+
+    // filter bounds, compared as numbers when every given bound is one
+    bool numeric;
+    double low_value;
+    double high_value;
+
+    // jsonl keys, already escaped
+    char** keys;
+    size_t n_keys;
+} csvtool_job;
+
+static void csvtool_usage(void)
+{
+    fprintf(stderr,
+            "usage: csvtool <command> [options] [file | -]\n"
+            "commands:\n"
+            "  select  -c name,... | -i index,...   keep these columns, in this order\n"
+            "  ignore  -c name,... | -i index,...   drop these columns\n"
+            "  head    [-n rows]                    first rows (default 10)\n"
+            "  count                                number of rows\n"
+            "  stats   [-c name,... | -i index,...] count, nulls, sum, min, max, mean and variance of numeric columns\n"
+            "  filter  -c name | -i index [--eq value] [--min value] [--max value]\n"
+            "                                       rows whose cell lies within the bounds (numbers if every bound is one, else byte order)\n"
+            "  convert --to delim | --jsonl         change the delimiter, or write one JSON object per row\n"
+            "options:\n"
+            "  -d delim      input delimiter (default ','; 'tab' for a tab)\n"
+            "  --no-header   the first line is data\n"
+            "  -t threads    worker threads (default: one per CPU)\n"
+            "  --stats       print throughput to stderr\n");
+    exit(1);
+}
+
+static void csvtool_fail(const char* message, const char* detail)
+{
+    fprintf(stderr, "csvtool: %s%s\n", message, detail);
+    exit(1);
+}
+
+static double csvtool_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static void csvtool_append(csvtool_buffer* buffer, const char* data, size_t len)
+{
+    if (buffer->len + len > buffer->capacity)
+    {
+        buffer->capacity = buffer->capacity * 2 > buffer->len + len ? buffer->capacity * 2 : buffer->len + len + 4096;
+        buffer->data = csv_realloc(buffer->data, buffer->capacity);
+    }
+    memcpy(buffer->data + buffer->len, data, len);
+    buffer->len += len;
+}
+
+static void csvtool_append_char(csvtool_buffer* buffer, char c)
+{
+    if (buffer->len < buffer->capacity)
+        buffer->data[buffer->len++] = c;
+    else
+        csvtool_append(buffer, &c, 1);
+}
+
+static char csvtool_parse_delim(const char* arg)
+{
+    if (strcmp(arg, "tab") == 0 || strcmp(arg, "\\t") == 0)
+        return '\t';
+    if (strlen(arg) != 1)
+        csvtool_fail("a delimiter must be a single character: ", arg);
+    return arg[0];
+}
+
+// splits a line (without its newline) into cells with the same quote rules as csv_parse_line(); every cell is found in one pass
+static size_t csvtool_split(csvtool_slot* slot, const char* line, size_t len, char delim)
+{
+    size_t n_cells = 0;
+    size_t start = 0;
+    bool inside_quotes = false;
+    for (size_t i = 0; i <= len; ++i)
+    {
+        if (i < len)
+        {
+            if (line[i] == '\"')
+                inside_quotes = !inside_quotes;
+            if (line[i] != delim || inside_quotes)
+                continue;
+        }
+        if (n_cells == slot->cell_capacity)
+        {
+            slot->cell_capacity = slot->cell_capacity == 0 ? 64 : slot->cell_capacity * 2;
+            slot->cell_starts = csv_realloc(slot->cell_starts, sizeof(size_t) * slot->cell_capacity);
+            slot->cell_lens = csv_realloc(slot->cell_lens, sizeof(size_t) * slot->cell_capacity);
+        }
+        slot->cell_starts[n_cells] = start;
+        slot->cell_lens[n_cells] = i - start;
+        n_cells++;
+        start = i + 1;
+    }
+    return n_cells;
+}
+
+// true if the whole cell is a number
+static bool csvtool_number(const char* cell, size_t len, double* value)
+{
+    if (len == 0 || len >= 64)
+        return false;
+    char buffer[64];
+    memcpy(buffer, cell, len);
+    buffer[len] = 0;
+    char* end;
+    *value = strtod(buffer, &end);
+    return end == buffer + len && !isnan(*value);
+}
+
+static int csvtool_compare(const char* a, size_t a_len, const char* b, size_t b_len)
+{
+    int cmp = memcmp(a, b, a_len < b_len ? a_len : b_len);
+    if (cmp != 0)
+        return cmp;
+    return (a_len > b_len) - (a_len < b_len);
+}
+
+// a cell as a JSON string: surrounding quotes are removed and "" becomes "
+static void csvtool_append_json(csvtool_buffer* buffer, const char* cell, size_t len)
+{
+    bool quoted = len >= 2 && cell[0] == '\"' && cell[len - 1] == '\"';
+    if (quoted)
+    {
+        cell++;
+        len -= 2;
+    }
+
+    csvtool_append_char(buffer, '\"');
+    for (size_t i = 0; i < len; ++i)
+    {
+        // runs of characters that need no escaping are copied at once
+        size_t run = i;
+        while (run < len && (unsigned char)cell[run] >= 0x20 && cell[run] != '\"' && cell[run] != '\\')
+            run++;
+        if (run > i)
+        {
+            csvtool_append(buffer, cell + i, run - i);
+            i = run - 1;
+            continue;
+        }
+
+        unsigned char c = cell[i];
+        if (quoted && c == '\"' && i + 1 < len && cell[i + 1] == '\"')
+            i++;
+        if (c == '\"' || c == '\\')
+        {
+            csvtool_append_char(buffer, '\\');
+            csvtool_append_char(buffer, c);
+        }
+        else if (c < 0x20)
+        {
+            char escape[8];
+            snprintf(escape, sizeof(escape), "\\u%04x", c);
+            csvtool_append(buffer, escape, 6);
+        }
+        else
+            csvtool_append_char(buffer, c);
+    }
+    csvtool_append_char(buffer, '\"');
+}
+
+static void csvtool_moments_add(csvtool_moments* moments, const char* cell, size_t len)
+{
+    // like csv_column_stats(), a cell counts if it starts with a number
+    char buffer[64];
+    char* copy = len < sizeof(buffer) ? buffer : csv_malloc(len + 1);
+    memcpy(copy, cell, len);
+    copy[len] = 0;
+    char* end;
+    double value = strtod(copy, &end);
+    bool numeric = len > 0 && end != copy && !isnan(value);
+    if (copy != buffer)
+        csv_dealloc(copy);
+
+    if (!numeric)
+    {
+        moments->null_count++;
+        return;
+    }
+    moments->count++;
+    moments->sum += value;
+    if (moments->count == 1 || value < moments->min)
+        moments->min = value;
+    if (moments->count == 1 || value > moments->max)
+        moments->max = value;
+    double delta = value - moments->mean;
+    moments->mean += delta / moments->count;
+    moments->m2 += delta * (value - moments->mean);
+}
+
+static void csvtool_moments_merge(csvtool_moments* into, const csvtool_moments* from)
+{
+    into->null_count += from->null_count;
+    if (from->count == 0)
+        return;
+    if (into->count == 0)
+    {
+        size_t null_count = into->null_count;
+        *into = *from;
+        into->null_count = null_count;
+        return;
+    }
+    size_t count = into->count + from->count;
+    double delta = from->mean - into->mean;
+    into->m2 += from->m2 + delta * delta * ((double)into->count * from->count / count);
+    into->mean += delta * from->count / count;
+    into->sum += from->sum;
+    into->min = from->min < into->min ? from->min : into->min;
+    into->max = from->max > into->max ? from->max : into->max;
+    into->count = count;
+}
+
+// writes the projection (select/ignore) or conversion of one line
+static void csvtool_write_line(const csvtool_job* job, csvtool_slot* slot, const char* line, size_t len)
+{
+    const csvtool_options* options = job->options;
+    csvtool_buffer* out = &slot->output;
+    size_t n_cells = csvtool_split(slot, line, len, options->delim);
+
+    if (options->command == CSVTOOL_CONVERT && options->jsonl)
+    {
+        csvtool_append_char(out, '{');
+        for (size_t c = 0; c < n_cells || c < job->n_keys; ++c)
+        {
+            if (c > 0)
+                csvtool_append_char(out, ',');
+            if (c < job->n_keys)
+                csvtool_append(out, job->keys[c], strlen(job->keys[c]));
+            else
+            {
+                char key[32];
+                csvtool_append(out, key, snprintf(key, sizeof(key), "\"c%zu\"", c));
+            }
+            csvtool_append_char(out, ':');
+            if (c < n_cells && slot->cell_lens[c] > 0)
+                csvtool_append_json(out, line + slot->cell_starts[c], slot->cell_lens[c]);
+            else
+                csvtool_append(out, "null", 4);
+        }
+        csvtool_append(out, "}\n", 2);
+        return;
+    }
+
+    if (options->command == CSVTOOL_CONVERT)
+    {
+        for (size_t c = 0; c < n_cells; ++c)
+        {
+            if (c > 0)
+                csvtool_append_char(out, options->out_delim);
+            const char* cell = line + slot->cell_starts[c];
+            size_t cell_len = slot->cell_lens[c];
+
+            // an unquoted cell that holds the new delimiter has to be quoted now
+            if ((cell_len == 0 || cell[0] != '\"') && memchr(cell, options->out_delim, cell_len) != NULL)
+            {
+                csvtool_append_char(out, '\"');
+                for (size_t i = 0; i < cell_len; ++i)
+                {
+                    if (cell[i] == '\"')
+                        csvtool_append_char(out, '\"');
+                    csvtool_append_char(out, cell[i]);
+                }
+                csvtool_append_char(out, '\"');
+            }
+            else
+                csvtool_append(out, cell, cell_len);
+        }
+        csvtool_append_char(out, '\n');
+        return;
+    }
+
+    // select and ignore: cells that a short row lacks are written empty
+    for (size_t k = 0; k < job->n_columns; ++k)
+    {
+        if (k > 0)
+            csvtool_append_char(out, options->delim);
+        size_t c = job->columns[k];
+        if (c < n_cells)
+            csvtool_append(out, line + slot->cell_starts[c], slot->cell_lens[c]);
+    }
+    csvtool_append_char(out, '\n');
+}
+
+static void csvtool_process_line(const csvtool_job* job, csvtool_slot* slot, const char* line, size_t len)
+{
+    const csvtool_options* options = job->options;
+    slot->n_lines++;
+
+    switch (options->command)
+    {
+        case CSVTOOL_FILTER:
+        {
+            const char* cell;
+            size_t cell_len;
+            if (!csv_find_cell(line, len, options->delim, job->columns[0], &cell, &cell_len) || cell_len == 0)
+                return;
+            if (job->numeric)
+            {
+                double value;
+                if (!csvtool_number(cell, cell_len, &value) || (options->low != NULL && value < job->low_value) || (options->high != NULL && value > job->high_value))
+                    return;
+            }
+            else if ((options->low != NULL && csvtool_compare(cell, cell_len, options->low, strlen(options->low)) < 0)
+                     || (options->high != NULL && csvtool_compare(cell, cell_len, options->high, strlen(options->high)) > 0))
+                return;
+            csvtool_append(&slot->output, line, len);
+            csvtool_append_char(&slot->output, '\n');
+            return;
+        }
+        case CSVTOOL_STATS:
+        {
+            size_t n_cells = csvtool_split(slot, line, len, options->delim);
+            for (size_t k = 0; k < job->n_columns; ++k)
+            {
+                size_t c = job->columns[k];
+                csvtool_moments_add(&slot->moments[k], c < n_cells ? line + slot->cell_starts[c] : "", c < n_cells ? slot->cell_lens[c] : 0);
+            }
+            return;
+        }
+        case CSVTOOL_COUNT:
+            return;
+        default:
+            csvtool_write_line(job, slot, line, len);
+    }
+}
+
+static void csvtool_run_chunk(void* context, size_t index)
+{
+    csvtool_job* job = context;
+    csvtool_slot* slot = &job->slots[index];
+    size_t start = job->chunk_starts[job->first_chunk + index];
+    size_t end = job->chunk_starts[job->first_chunk + index + 1];
+
+    // count only needs the newlines
+    if (job->options->command == CSVTOOL_COUNT)
+    {
+        const char* c = job->data + start;
+        const char* chunk_end = job->data + end;
+        while (c < chunk_end)
+        {
+            const char* newline = memchr(c, '\n', chunk_end - c);
+            slot->n_lines++;
+            c = newline != NULL ? newline + 1 : chunk_end;
+        }
+        return;
+    }
+
+    while (start < end)
+    {
+        const char* newline = memchr(job->data + start, '\n', end - start);
+        size_t line_end = newline != NULL ? (size_t)(newline - job->data) : end;
+        csvtool_process_line(job, slot, job->data + start, line_end - start);
+        start = line_end + 1;
+    }
+}
+
+// column numbers from a comma separated list of names (looked up in the header) or indices
+static size_t csvtool_resolve_columns(const csvtool_options* options, char** header, size_t n_header, size_t** columns)
+{
+    const char* list = options->column_names != NULL ? options->column_names : options->column_indices;
+    size_t n_columns = 0;
+    *columns = csv_malloc(sizeof(size_t) * (strlen(list) + 1));
+    char* copy = csv_strdup(list);
+    for (char* save = NULL, *item = strtok_r(copy, ",", &save); item != NULL; item = strtok_r(NULL, ",", &save))
+    {
+        if (options->column_indices != NULL)
+        {
+            char* end;
+            unsigned long long index = strtoull(item, &end, 10);
+            if (*end != 0 || end == item)
+                csvtool_fail("not a column index: ", item);
+            (*columns)[n_columns++] = index;
+            continue;
+        }
+
+        size_t c = 0;
+        while (c < n_header && strcmp(header[c], item) != 0)
+            c++;
+        if (c == n_header)
+            csvtool_fail("no column named ", item);
+        (*columns)[n_columns++] = c;
+    }
+    csv_dealloc(copy);
+    return n_columns;
+}
+
+// maps the file, or reads all of stdin
+static const char* csvtool_load(const char* filename, size_t* size, bool* mapped)
+{
+    *mapped = false;
+    if (filename == NULL || strcmp(filename, "-") == 0)
+    {
+        size_t capacity = 1 << 20;
+        char* data = csv_malloc(capacity);
+        *size = 0;
+        for (;;)
+        {
+            if (*size == capacity)
+            {
+                capacity *= 2;
+                data = csv_realloc(data, capacity);
+            }
+            ssize_t n_read = read(STDIN_FILENO, data + *size, capacity - *size);
+            if (n_read == 0 || (n_read < 0 && errno != EINTR))
+                break;
+            if (n_read > 0)
+                *size += n_read;
+        }
+        return data;
+    }
+
+    int fd = open(filename, O_RDONLY);
+    struct stat file_stat;
+    if (fd == -1 || fstat(fd, &file_stat) == -1)
+        csvtool_fail("cannot open ", filename);
+    *size = file_stat.st_size;
+    if (*size == 0)
+    {
+        close(fd);
+        return "";
+    }
+    const char* data = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        csvtool_fail("cannot map ", filename);
+    madvise((void*)data, *size, MADV_SEQUENTIAL);
+    *mapped = true;
+    return data;
+}
+
+static void csvtool_parse_args(int argc, char** argv, csvtool_options* options)
+{
+    if (argc < 2)
+        csvtool_usage();
+
+    const char* commands[] = { "select", "ignore", "head", "count", "stats", "filter", "convert" };
+    size_t command = 0;
+    while (command < 7 && strcmp(argv[1], commands[command]) != 0)
+        command++;
+    if (command == 7)
+        csvtool_usage();
+
+    memset(options, 0, sizeof(csvtool_options));
+    options->command = (csvtool_command)command;
+    options->delim = ',';
+    options->has_headers = true;
+    options->n_rows = 10;
+
+    for (int i = 2; i < argc; ++i)
+    {
+        const char* arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (strcmp(arg, "--no-header") == 0)
+            options->has_headers = false;
+        else if (strcmp(arg, "--stats") == 0)
+            options->stats = true;
+        else if (strcmp(arg, "--jsonl") == 0)
+            options->jsonl = true;
+        else if (strcmp(arg, "-d") == 0 && has_value)
+            options->delim = csvtool_parse_delim(argv[++i]);
+        else if (strcmp(arg, "--to") == 0 && has_value)
+            options->out_delim = csvtool_parse_delim(argv[++i]);
+        else if (strcmp(arg, "-t") == 0 && has_value)
+            options->n_threads = strtoul(argv[++i], NULL, 10);
+        else if (strcmp(arg, "-n") == 0 && has_value)
+            options->n_rows = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(arg, "-c") == 0 && has_value)
+            options->column_names = argv[++i];
+        else if (strcmp(arg, "-i") == 0 && has_value)
+            options->column_indices = argv[++i];
+        else if (strcmp(arg, "--eq") == 0 && has_value)
+            options->low = options->high = argv[++i];
+        else if (strcmp(arg, "--min") == 0 && has_value)
+            options->low = argv[++i];
+        else if (strcmp(arg, "--max") == 0 && has_value)
+            options->high = argv[++i];
+        else if (arg[0] == '-' && arg[1] != 0)
+            csvtool_usage();
+        else
+            options->filename = arg;
+    }
+
+    bool has_columns = options->column_names != NULL || options->column_indices != NULL;
+    if ((options->command == CSVTOOL_SELECT || options->command == CSVTOOL_IGNORE || options->command == CSVTOOL_FILTER) && !has_columns)
+        csvtool_usage();
+    if (options->command == CSVTOOL_CONVERT && options->out_delim == 0 && !options->jsonl)
+        csvtool_usage();
+    if (options->column_names != NULL && !options->has_headers)
+        csvtool_fail("columns can only be named when the file has a header; use -i", "");
+}
+
+int main(int argc, char** argv)
+{
+    csvtool_options options;
+    csvtool_parse_args(argc, argv, &options);
+    double started = csvtool_now();
+
+    size_t size;
+    bool mapped;
+    const char* data = csvtool_load(options.filename, &size, &mapped);
+    static char stdout_buffer[1 << 20];
+    setvbuf(stdout, stdout_buffer, _IOFBF, sizeof(stdout_buffer));
+
+    // the first line gives the column names (or count) and is handled before the chunks; a byte order mark is not part of it
+    size_t bom = csv_bom_length(data, size);
+    const char* first_line = data + bom;
+    const char* first_newline = memchr(first_line, '\n', size - bom);
+    size_t first_len = first_newline != NULL ? (size_t)(first_newline - first_line) : size - bom;
+    size_t body_start = options.has_headers ? (first_newline != NULL ? bom + first_len + 1 : size) : bom;
+    char** header = NULL;
+    size_t n_header = size > 0 ? csv_parse_line_n(first_line, csv_header_length(first_line, first_len), options.delim, &header) : 0;
+
+    csvtool_job job;
+    memset(&job, 0, sizeof(csvtool_job));
+    job.options = &options;
+    job.data = data;
+    job.size = size;
+
+    if (options.column_names != NULL || options.column_indices != NULL)
+        job.n_columns = csvtool_resolve_columns(&options, header, n_header, &job.columns);
+    else if (options.command == CSVTOOL_STATS)
+    {
+        job.n_columns = n_header;
+        job.columns = csv_malloc(sizeof(size_t) * (n_header > 0 ? n_header : 1));
+        for (size_t c = 0; c < n_header; ++c)
+            job.columns[c] = c;
+    }
+
+    // ignore keeps every column of the first line that is not listed
+    if (options.command == CSVTOOL_IGNORE)
+    {
+        size_t* kept = csv_malloc(sizeof(size_t) * (n_header > 0 ? n_header : 1));
+        size_t n_kept = 0;
+        for (size_t c = 0; c < n_header; ++c)
+        {
+            bool ignored = false;
+            for (size_t k = 0; k < job.n_columns && !ignored; ++k)
+                ignored = job.columns[k] == c;
+            if (!ignored)
+                kept[n_kept++] = c;
+        }
+        csv_dealloc(job.columns);
+        job.columns = kept;
+        job.n_columns = n_kept;
+    }
+
+    if (options.command == CSVTOOL_FILTER)
+    {
+        double value;
+        job.numeric = (options.low == NULL || csvtool_number(options.low, strlen(options.low), &value))
+                      && (options.high == NULL || csvtool_number(options.high, strlen(options.high), &value))
+                      && (options.low != NULL || options.high != NULL);
+        if (job.numeric)
+        {
+            if (options.low != NULL)
+                csvtool_number(options.low, strlen(options.low), &job.low_value);
+            if (options.high != NULL)
+                csvtool_number(options.high, strlen(options.high), &job.high_value);
+        }
+    }
+
+    if (options.command == CSVTOOL_CONVERT && options.jsonl && options.has_headers)
+    {
+        job.n_keys = n_header;
+        job.keys = csv_malloc(sizeof(char*) * (n_header > 0 ? n_header : 1));
+        for (size_t c = 0; c < n_header; ++c)
+        {
+            csvtool_buffer key = { NULL, 0, 0 };
+            csvtool_append_json(&key, header[c], strlen(header[c]));
+            csvtool_append_char(&key, 0);
+            job.keys[c] = key.data;
+        }
+    }
+
+    size_t n_rows = 0;
+    if (options.command == CSVTOOL_HEAD)
+    {
+        // a handful of lines is not worth a thread
+        size_t end = body_start;
+        for (size_t r = 0; r < options.n_rows && end < size; ++r, ++n_rows)
+        {
+            const char* newline = memchr(data + end, '\n', size - end);
+            end = newline != NULL ? (size_t)(newline - data) + 1 : size;
+        }
+        fwrite(first_line, 1, end - bom, stdout);
+        if (end > bom && data[end - 1] != '\n')
+            fputc('\n', stdout);
+    }
+    else
+    {
+        size_t n_threads = csv_thread_count(options.n_threads);
+        csvtool_slot header_slot;
+        memset(&header_slot, 0, sizeof(csvtool_slot));
+        if (options.has_headers && size > 0)
+        {
+            if (options.command == CSVTOOL_SELECT || options.command == CSVTOOL_IGNORE || (options.command == CSVTOOL_CONVERT && !options.jsonl))
+                csvtool_write_line(&job, &header_slot, first_line, first_len);
+            else if (options.command == CSVTOOL_FILTER)
+            {
+                csvtool_append(&header_slot.output, first_line, first_len);
+                csvtool_append_char(&header_slot.output, '\n');
+            }
+            if (header_slot.output.len > 0)
+                fwrite(header_slot.output.data, 1, header_slot.output.len, stdout);
+        }
+
+        // chunk boundaries are moved forward to the start of a line
+        size_t n_chunks = (size - body_start + CSVTOOL_CHUNK - 1) / CSVTOOL_CHUNK;
+        size_t* chunk_starts = csv_malloc(sizeof(size_t) * (n_chunks + 1));
+        for (size_t i = 0; i < n_chunks; ++i)
+        {
+            size_t start = body_start + i * CSVTOOL_CHUNK;
+            if (i > 0)
+            {
+                const char* newline = start - 1 < size ? memchr(data + start - 1, '\n', size - start + 1) : NULL;
+                start = newline != NULL ? (size_t)(newline - data) + 1 : size;
+            }
+            chunk_starts[i] = start;
+        }
+        chunk_starts[n_chunks] = size;
+        job.chunk_starts = chunk_starts;
+
+        size_t batch = n_threads * CSVTOOL_CHUNKS_PER_THREAD;
+        job.slots = csv_calloc(batch, sizeof(csvtool_slot));
+        csvtool_moments* totals = csv_calloc(job.n_columns > 0 ? job.n_columns : 1, sizeof(csvtool_moments));
+        for (size_t s = 0; s < batch && options.command == CSVTOOL_STATS; ++s)
+            job.slots[s].moments = csv_calloc(job.n_columns > 0 ? job.n_columns : 1, sizeof(csvtool_moments));
+
+        for (size_t first = 0; first < n_chunks; first += batch)
+        {
+            size_t n_batch = n_chunks - first < batch ? n_chunks - first : batch;
+            job.first_chunk = first;
+            csv_parallel_for(n_batch, n_threads, &csvtool_run_chunk, &job);
+
+            // outputs are written in file order
+            for (size_t s = 0; s < n_batch; ++s)
+            {
+                csvtool_slot* slot = &job.slots[s];
+                if (slot->output.len > 0)
+                    fwrite(slot->output.data, 1, slot->output.len, stdout);
+                slot->output.len = 0;
+                n_rows += slot->n_lines;
+                slot->n_lines = 0;
+                for (size_t k = 0; k < job.n_columns && slot->moments != NULL; ++k)
+                {
+                    csvtool_moments_merge(&totals[k], &slot->moments[k]);
+                    memset(&slot->moments[k], 0, sizeof(csvtool_moments));
+                }
+            }
+        }
+
+        if (options.command == CSVTOOL_COUNT)
+            printf("%zu\n", n_rows);
+        else if (options.command == CSVTOOL_STATS)
+        {
+            printf("column,count,null_count,sum,min,max,mean,variance\n");
+            for (size_t k = 0; k < job.n_columns; ++k)
+            {
+                csvtool_moments* m = &totals[k];
+                size_t c = job.columns[k];
+                if (c < n_header && options.has_headers)
+                    printf("%s", header[c]);
+                else
+                    printf("%zu", c);
+                if (m->count == 0)
+                    printf(",0,%zu,0,nan,nan,nan,nan\n", m->null_count);
+                else
+                    printf(",%zu,%zu,%.17g,%.17g,%.17g,%.17g,%.17g\n", m->count, m->null_count, m->sum, m->min, m->max, m->mean,
+                           m->count > 1 ? m->m2 / (m->count - 1) : NAN);
+            }
+        }
+
+        for (size_t s = 0; s < batch; ++s)
+        {
+            csv_dealloc(job.slots[s].output.data);
+            csv_dealloc(job.slots[s].cell_starts);
+            csv_dealloc(job.slots[s].cell_lens);
+            csv_dealloc(job.slots[s].moments);
+        }
+        csv_dealloc(header_slot.output.data);
+        csv_dealloc(header_slot.cell_starts);
+        csv_dealloc(header_slot.cell_lens);
+        csv_dealloc(job.slots);
+        csv_dealloc(totals);
+        csv_dealloc(chunk_starts);
+    }
+    fflush(stdout);
+
+    if (options.stats)
+    {
+        double seconds = csvtool_now() - started;
+        fprintf(stderr, "csvtool: %zu bytes, %zu rows in %.3f s (%.1f MB/s, %zu threads)\n", size, n_rows, seconds,
+                seconds > 0 ? size / seconds / 1e6 : 0.0, options.command == CSVTOOL_HEAD ? (size_t)1 : csv_thread_count(options.n_threads));
+    }
+
+    for (size_t c = 0; c < n_header; ++c)
+        csv_dealloc(header[c]);
+    csv_dealloc(header);
+    for (size_t c = 0; c < job.n_keys; ++c)
+        csv_dealloc(job.keys[c]);
+    csv_dealloc(job.keys);
+    csv_dealloc(job.columns);
+    if (mapped)
+        munmap((void*)data, size);
+    else if (size > 0 || options.filename == NULL || strcmp(options.filename, "-") == 0)
+        csv_dealloc((void*)data);
+    return 0;
+}